@@ -1,5 +1,6 @@
 #include "vkvg.h"
 #include <gtest/gtest.h>
+#include <chrono>
 
 // The fixture for testing class Foo.
 class ContextTest : public testing::Test {
@@ -216,3 +217,625 @@ TEST_F(ContextTest, CtxBasicPathCommands) {
 
     vkvg_destroy(ctx);
 }
+TEST_F(ContextTest, CtxFlushAsync) {
+    VkvgContext ctx = vkvg_create(NULL);
+    EXPECT_EQ(0, vkvg_flush_async(ctx));
+    EXPECT_EQ(false, vkvg_is_complete(ctx, 0));
+
+    ctx = vkvg_create(surf);
+    EXPECT_EQ(true, vkvg_is_complete(ctx, 0));
+
+    vkvg_rectangle(ctx, 10, 10, 100, 100);
+    vkvg_fill(ctx);
+    uint64_t ticket = vkvg_flush_async(ctx);
+    EXPECT_NE(0, ticket);
+    EXPECT_EQ(VKVG_STATUS_INVALID_INDEX, vkvg_wait(ctx, ticket + 1, 0));
+
+    vkvg_rectangle(ctx, 50, 50, 100, 100);
+    vkvg_fill(ctx);
+    uint64_t ticket2 = vkvg_flush_async(ctx);
+    EXPECT_LT(ticket, ticket2);
+
+    EXPECT_EQ(VKVG_STATUS_SUCCESS, vkvg_wait(ctx, ticket2, UINT64_MAX));
+    EXPECT_EQ(true, vkvg_is_complete(ctx, ticket));
+    EXPECT_EQ(true, vkvg_is_complete(ctx, ticket2));
+    // nothing more to submit, last ticket is returned.
+    EXPECT_EQ(ticket2, vkvg_flush_async(ctx));
+    EXPECT_EQ(VKVG_STATUS_SUCCESS, vkvg_status(ctx));
+
+    vkvg_destroy(ctx);
+}
+TEST_F(ContextTest, CtxSubmitBatching) {
+    vkvg_device_set_submit_batching(dev, 8);
+
+    VkvgContext ctxs[4];
+    uint64_t    tickets[4];
+    for (int i = 0; i < 4; i++) {
+        ctxs[i] = vkvg_create(surf);
+        vkvg_rectangle(ctxs[i], 10.f * i, 10, 100, 100);
+        vkvg_fill(ctxs[i]);
+        tickets[i] = vkvg_flush_async(ctxs[i]);
+        EXPECT_NE(0, tickets[i]);
+    }
+    // waiting for a queued submission submits the batch.
+    EXPECT_EQ(VKVG_STATUS_SUCCESS, vkvg_wait(ctxs[1], tickets[1], UINT64_MAX));
+
+    vkvg_rectangle(ctxs[0], 50, 50, 100, 100);
+    vkvg_fill(ctxs[0]);
+    tickets[0] = vkvg_flush_async(ctxs[0]);
+    vkvg_device_submit_pending(dev);
+    EXPECT_EQ(VKVG_STATUS_SUCCESS, vkvg_wait(ctxs[0], tickets[0], UINT64_MAX));
+
+    for (int i = 0; i < 4; i++) {
+        EXPECT_EQ(VKVG_STATUS_SUCCESS, vkvg_status(ctxs[i]));
+        vkvg_destroy(ctxs[i]);
+    }
+    vkvg_device_set_submit_batching(dev, 0);
+}
+TEST_F(ContextTest, CtxCreateWithHint) {
+    vkvg_device_set_context_cache_size(dev, 2);
+    vkvg_device_prewarm_contexts(dev, 4, 100000);
+
+    VkvgContext ctx = vkvg_create_with_hint(NULL, 100000);
+    EXPECT_EQ(VKVG_STATUS_INVALID_SURFACE, vkvg_status(ctx));
+
+    ctx              = vkvg_create_with_hint(surf, 100000);
+    VkvgContext ctx2 = vkvg_create(surf);
+    VkvgContext ctx3 = vkvg_create_with_hint(surf, 10);
+    EXPECT_EQ(VKVG_STATUS_SUCCESS, vkvg_status(ctx));
+    EXPECT_EQ(VKVG_STATUS_SUCCESS, vkvg_status(ctx2));
+    EXPECT_EQ(VKVG_STATUS_SUCCESS, vkvg_status(ctx3));
+    EXPECT_EQ(1, vkvg_get_reference_count(ctx));
+
+    vkvg_rectangle(ctx, 10, 10, 100, 100);
+    vkvg_fill(ctx);
+
+    vkvg_destroy(ctx3);
+    vkvg_destroy(ctx2);
+    vkvg_destroy(ctx);
+    vkvg_device_set_context_cache_size(dev, 0);
+}
+TEST_F(ContextTest, CtxArrayGrowth) {
+    vkvg_device_set_context_cache_size(dev, 1);
+    vkvg_device_set_array_growth_factor(dev, 1.5f);
+
+    VkvgContext ctx = vkvg_create(surf);
+    vkvg_move_to(ctx, 0, 0);
+    for (int i = 0; i < 100000; i++)
+        vkvg_line_to(ctx, (float)(i % 512), (float)(i % 7));
+    vkvg_stroke(ctx);
+    EXPECT_EQ(VKVG_STATUS_SUCCESS, vkvg_status(ctx));
+    vkvg_destroy(ctx);
+
+    // cached context arrays are shrunk, it grows again for the next huge path.
+    ctx = vkvg_create(surf);
+    EXPECT_EQ(VKVG_STATUS_SUCCESS, vkvg_status(ctx));
+    vkvg_move_to(ctx, 0, 0);
+    for (int i = 0; i < 100000; i++)
+        vkvg_line_to(ctx, (float)(i % 512), (float)(i % 7));
+    vkvg_fill(ctx);
+    EXPECT_EQ(VKVG_STATUS_SUCCESS, vkvg_status(ctx));
+    vkvg_destroy(ctx);
+
+    vkvg_device_set_array_growth_factor(dev, 2.0f);
+    vkvg_device_set_context_cache_size(dev, 0);
+}
+TEST_F(ContextTest, CtxBufferArena) {
+    vkvg_device_set_context_cache_size(dev, 0);
+    vkvg_buffer_arena_stats_t stats = vkvg_device_get_buffer_arena_stats(dev);
+    uint32_t                  allocs = stats.allocationCount;
+
+    VkvgContext ctx = vkvg_create(surf);
+    stats           = vkvg_device_get_buffer_arena_stats(dev);
+    EXPECT_GT(stats.allocationCount, allocs);
+    EXPECT_GT(stats.blockCount, 0);
+    EXPECT_LE(stats.usedBytes, stats.reservedBytes);
+
+    // vertex buffers growing beyond the default block size get a dedicated block.
+    vkvg_move_to(ctx, 0, 0);
+    for (int i = 0; i < 400000; i++)
+        vkvg_line_to(ctx, (float)(i % 512), (float)(i % 7));
+    vkvg_stroke(ctx);
+    EXPECT_EQ(VKVG_STATUS_SUCCESS, vkvg_status(ctx));
+    vkvg_destroy(ctx);
+
+    stats = vkvg_device_get_buffer_arena_stats(dev);
+    EXPECT_EQ(allocs, stats.allocationCount);
+    EXPECT_LE(stats.blockCount, 1);
+}
+TEST_F(ContextTest, CtxTransformBatching) {
+    const uint32_t size   = 512 * 512 * 4;
+    unsigned char *refBmp = (unsigned char *)malloc(size);
+    unsigned char *bmp    = (unsigned char *)malloc(size);
+
+    // integer transforms give the same pixels whether vertices are transformed by the shader or on the cpu.
+    VkvgSurface surfs[2] = {surf, vkvg_surface_create(dev, 512, 512)};
+    for (int s = 0; s < 2; s++) {
+        VkvgContext ctx = vkvg_create(surfs[s]);
+        vkvg_set_transform_batching(ctx, s == 1);
+        EXPECT_EQ(s == 1, vkvg_get_transform_batching(ctx));
+        for (int i = 0; i < 64; i++) {
+            vkvg_save(ctx);
+            vkvg_translate(ctx, (float)(i % 8) * 64, (float)(i / 8) * 64);
+            vkvg_scale(ctx, 2, 2);
+            vkvg_set_source_rgb(ctx, (float)(i % 4) / 4, (float)(i % 3) / 3, 1);
+            vkvg_rectangle(ctx, 2, 2, 24, 24);
+            vkvg_fill(ctx);
+            vkvg_restore(ctx);
+            vkvg_identity_matrix(ctx);
+            vkvg_translate(ctx, (float)(i % 8) * 64 + 8, (float)(i / 8) * 64 + 8);
+            vkvg_set_source_rgb(ctx, 0, 0, 0);
+            vkvg_rectangle(ctx, 0, 0, 16, 16);
+            vkvg_stroke(ctx);
+        }
+        EXPECT_EQ(VKVG_STATUS_SUCCESS, vkvg_status(ctx));
+        vkvg_destroy(ctx);
+    }
+    EXPECT_EQ(VKVG_STATUS_SUCCESS, vkvg_surface_write_to_memory(surfs[0], refBmp));
+    EXPECT_EQ(VKVG_STATUS_SUCCESS, vkvg_surface_write_to_memory(surfs[1], bmp));
+    EXPECT_EQ(0, memcmp(refBmp, bmp, size));
+
+    vkvg_surface_destroy(surfs[1]);
+    free(refBmp);
+    free(bmp);
+}
+TEST_F(ContextTest, CtxDrawReordering) {
+    const uint32_t size   = 512 * 512 * 4;
+    unsigned char *refBmp = (unsigned char *)malloc(size);
+    unsigned char *bmp    = (unsigned char *)malloc(size);
+
+    // non overlapping draws commute, grouping them by operator gives the same pixels.
+    VkvgSurface surfs[2] = {surf, vkvg_surface_create(dev, 512, 512)};
+    for (int s = 0; s < 2; s++) {
+        VkvgContext ctx = vkvg_create(surfs[s]);
+        vkvg_set_source_rgb(ctx, 0, 0, 1);
+        vkvg_paint(ctx);
+        vkvg_set_draw_reordering(ctx, s == 1);
+        EXPECT_EQ(s == 1, vkvg_get_draw_reordering(ctx));
+        for (int i = 0; i < 64; i++) {
+            vkvg_set_operator(ctx, i % 3 ? VKVG_OPERATOR_OVER : VKVG_OPERATOR_CLEAR);
+            vkvg_set_opacity(ctx, (float)(i % 4 + 1) / 4);
+            vkvg_set_source_rgb(ctx, (float)(i % 2), 1, 0);
+            vkvg_rectangle(ctx, (float)(i % 8) * 64 + 4, (float)(i / 8) * 64 + 4, 56, 56);
+            vkvg_fill(ctx);
+        }
+        EXPECT_FLOAT_EQ(1.0f, vkvg_get_opacity(ctx));
+        EXPECT_EQ(VKVG_STATUS_SUCCESS, vkvg_status(ctx));
+        vkvg_destroy(ctx);
+    }
+    EXPECT_EQ(VKVG_STATUS_SUCCESS, vkvg_surface_write_to_memory(surfs[0], refBmp));
+    EXPECT_EQ(VKVG_STATUS_SUCCESS, vkvg_surface_write_to_memory(surfs[1], bmp));
+    EXPECT_EQ(0, memcmp(refBmp, bmp, size));
+
+    vkvg_surface_destroy(surfs[1]);
+    free(refBmp);
+    free(bmp);
+}
+TEST_F(ContextTest, CtxSolidOpacity) {
+    const uint32_t size = 512 * 512 * 4;
+    unsigned char *bmp  = (unsigned char *)malloc(size);
+    auto alphaAt        = [&](int x, int y) { return bmp[(y * 512 + x) * 4 + 3]; };
+
+    // opacity is carried by the vertex color of solid sources, it must be applied once.
+    for (int batching = 0; batching < 2; batching++) {
+        VkvgContext ctx = vkvg_create(surf);
+        vkvg_clear(ctx);
+        vkvg_set_transform_batching(ctx, batching == 1);
+        vkvg_set_source_rgb(ctx, 1, 1, 1);
+        vkvg_set_opacity(ctx, 0.5f);
+        vkvg_translate(ctx, 100, 100);
+        vkvg_rectangle(ctx, 0, 0, 200, 200);
+        vkvg_fill(ctx);
+        EXPECT_EQ(VKVG_STATUS_SUCCESS, vkvg_status(ctx));
+        vkvg_destroy(ctx);
+
+        EXPECT_EQ(VKVG_STATUS_SUCCESS, vkvg_surface_write_to_memory(surf, bmp));
+        EXPECT_NEAR(128, alphaAt(200, 200), 1);
+        EXPECT_EQ(0, alphaAt(50, 50));
+    }
+    free(bmp);
+}
+TEST_F(ContextTest, CtxTolerance) {
+    VkvgContext ctx = vkvg_create(surf);
+    EXPECT_FLOAT_EQ(0.25f, vkvg_get_tolerance(ctx));
+
+    vkvg_set_tolerance(ctx, 2.0f);
+    EXPECT_FLOAT_EQ(2.0f, vkvg_get_tolerance(ctx));
+    vkvg_save(ctx);
+    vkvg_set_tolerance(ctx, 0);
+    EXPECT_LT(0.0f, vkvg_get_tolerance(ctx));
+    vkvg_restore(ctx);
+    EXPECT_FLOAT_EQ(2.0f, vkvg_get_tolerance(ctx));
+
+    // coarse and scaled curves still close and fill correctly.
+    vkvg_scale(ctx, 0.1f, 0.1f);
+    vkvg_arc(ctx, 2560, 2560, 2000, 0, 6.2831853f);
+    vkvg_curve_to(ctx, 4000, 100, 100, 4000, 2560, 2560);
+    vkvg_fill(ctx);
+    EXPECT_EQ(VKVG_STATUS_SUCCESS, vkvg_status(ctx));
+    vkvg_destroy(ctx);
+}
+TEST_F(ContextTest, CtxFillRules) {
+    const uint32_t size = 512 * 512 * 4;
+    unsigned char *bmp  = (unsigned char *)malloc(size);
+    // alpha of the pixel at the center, in the ring, and in the crossing of the bow tie.
+    auto alphaAt = [&](int x, int y) { return bmp[(y * 512 + x) * 4 + 3]; };
+
+    for (int rule = 0; rule < 2; rule++) {
+        for (int reversed = 0; reversed < 2; reversed++) {
+            VkvgContext ctx = vkvg_create(surf);
+            vkvg_clear(ctx);
+            vkvg_set_fill_rule(ctx, rule ? VKVG_FILL_RULE_EVEN_ODD : VKVG_FILL_RULE_NON_ZERO);
+            vkvg_set_source_rgb(ctx, 1, 1, 1);
+            // outer square and inner square, same or opposite orientation
+            vkvg_rectangle(ctx, 100, 100, 300, 300);
+            if (reversed) {
+                vkvg_move_to(ctx, 200, 200);
+                vkvg_line_to(ctx, 200, 300);
+                vkvg_line_to(ctx, 300, 300);
+                vkvg_line_to(ctx, 300, 200);
+                vkvg_close_path(ctx);
+            } else
+                vkvg_rectangle(ctx, 200, 200, 100, 100);
+            // self intersecting bow tie
+            vkvg_move_to(ctx, 420, 420);
+            vkvg_line_to(ctx, 500, 500);
+            vkvg_line_to(ctx, 500, 420);
+            vkvg_line_to(ctx, 420, 500);
+            vkvg_close_path(ctx);
+            vkvg_fill(ctx);
+            EXPECT_EQ(VKVG_STATUS_SUCCESS, vkvg_status(ctx));
+            vkvg_destroy(ctx);
+
+            EXPECT_EQ(VKVG_STATUS_SUCCESS, vkvg_surface_write_to_memory(surf, bmp));
+            EXPECT_EQ(255, alphaAt(150, 250));
+            EXPECT_EQ((rule == 0 && !reversed) ? 255 : 0, alphaAt(250, 250));
+            EXPECT_EQ(255, alphaAt(490, 460));
+            EXPECT_EQ(0, alphaAt(460, 490));
+            EXPECT_EQ(0, alphaAt(50, 50));
+        }
+    }
+    free(bmp);
+}
+TEST_F(ContextTest, CtxStencilFill) {
+    const uint32_t size = 512 * 512 * 4;
+    unsigned char *bmp  = (unsigned char *)malloc(size);
+    auto alphaAt        = [&](int x, int y) { return bmp[(y * 512 + x) * 4 + 3]; };
+
+    for (int rule = 0; rule < 2; rule++) {
+        for (int clip = 0; clip < 2; clip++) {
+            VkvgContext ctx = vkvg_create(surf);
+            vkvg_clear(ctx);
+            vkvg_set_fill_rule(ctx, rule ? VKVG_FILL_RULE_EVEN_ODD : VKVG_FILL_RULE_NON_ZERO);
+            vkvg_set_source_rgb(ctx, 1, 1, 1);
+            // pentagram with subdivided edges, enough points to be filled on stencil. Center winding is 2.
+            const int   subdiv = 200;
+            const float pi     = 3.14159265f;
+            for (int i = 0; i < 5; i++) {
+                float a0 = -pi / 2 + i * 4 * pi / 5, a1 = a0 + 4 * pi / 5;
+                float x0 = 256 + 200 * cosf(a0), y0 = 256 + 200 * sinf(a0);
+                float x1 = 256 + 200 * cosf(a1), y1 = 256 + 200 * sinf(a1);
+                for (int j = 0; j < subdiv; j++) {
+                    float t = (float)j / subdiv;
+                    if (i == 0 && j == 0)
+                        vkvg_move_to(ctx, x0, y0);
+                    else
+                        vkvg_line_to(ctx, x0 + t * (x1 - x0), y0 + t * (y1 - y0));
+                }
+            }
+            vkvg_close_path(ctx);
+            if (clip) {
+                vkvg_clip(ctx);
+                vkvg_paint(ctx);
+            } else
+                vkvg_fill(ctx);
+            EXPECT_EQ(VKVG_STATUS_SUCCESS, vkvg_status(ctx));
+            vkvg_destroy(ctx);
+
+            EXPECT_EQ(VKVG_STATUS_SUCCESS, vkvg_surface_write_to_memory(surf, bmp));
+            EXPECT_EQ(rule == 0 ? 255 : 0, alphaAt(256, 256));
+            EXPECT_EQ(255, alphaAt(256, 86));
+            EXPECT_EQ(0, alphaAt(10, 10));
+        }
+    }
+    free(bmp);
+}
+TEST_F(ContextTest, CtxStencilWindingOverflow) {
+    const uint32_t size = 512 * 512 * 4;
+    unsigned char *bmp  = (unsigned char *)malloc(size);
+    auto alphaAt        = [&](int x, int y) { return bmp[(y * 512 + x) * 4 + 3]; };
+
+    VkvgContext ctx = vkvg_create(surf);
+    vkvg_clear(ctx);
+    vkvg_set_source_rgb(ctx, 1, 1, 1);
+    // {17/8} star with subdivided edges, center winding is 8 which wraps to 0 on the 3 bits stencil counter.
+    const int   subdiv = 40;
+    const float pi     = 3.14159265f;
+    for (int i = 0; i < 17; i++) {
+        float a0 = -pi / 2 + i * 16 * pi / 17, a1 = a0 + 16 * pi / 17;
+        float x0 = 256 + 200 * cosf(a0), y0 = 256 + 200 * sinf(a0);
+        float x1 = 256 + 200 * cosf(a1), y1 = 256 + 200 * sinf(a1);
+        for (int j = 0; j < subdiv; j++) {
+            float t = (float)j / subdiv;
+            if (i == 0 && j == 0)
+                vkvg_move_to(ctx, x0, y0);
+            else
+                vkvg_line_to(ctx, x0 + t * (x1 - x0), y0 + t * (y1 - y0));
+        }
+    }
+    vkvg_close_path(ctx);
+    vkvg_fill(ctx);
+    EXPECT_EQ(VKVG_STATUS_SUCCESS, vkvg_status(ctx));
+    vkvg_destroy(ctx);
+
+    EXPECT_EQ(VKVG_STATUS_SUCCESS, vkvg_surface_write_to_memory(surf, bmp));
+    EXPECT_EQ(255, alphaAt(256, 256));
+    EXPECT_EQ(0, alphaAt(10, 10));
+    free(bmp);
+}
+
+TEST_F(ContextTest, CtxFillLargePolygons) {
+    const uint32_t size = 512 * 512 * 4;
+    unsigned char *bmp  = (unsigned char *)malloc(size);
+    auto alphaAt        = [&](int x, int y) { return bmp[(y * 512 + x) * 4 + 3]; };
+    const float pi      = 3.14159265f;
+
+    // jagged ring around a reversed hole, fill times are recorded as test properties. Each ring is filled on the
+    // stencil, then up to 100k points by the ear clipper, or the tesselator when one is enabled.
+    for (int n = 10000; n <= 1000000; n *= 10) {
+        for (int tess = 0; tess < (n <= 100000 ? 2 : 1); tess++) {
+            vkvg_device_set_stencil_fill_threshold(dev, tess ? UINT32_MAX : 0);
+            VkvgContext ctx = vkvg_create(surf);
+            vkvg_clear(ctx);
+            vkvg_set_source_rgb(ctx, 1, 1, 1);
+            for (int i = 0; i < n; i++) {
+                float a = 2 * pi * i / n, r = (i % 2) ? 230.f : 226.f;
+                if (i == 0)
+                    vkvg_move_to(ctx, 256 + r * cosf(a), 256 + r * sinf(a));
+                else
+                    vkvg_line_to(ctx, 256 + r * cosf(a), 256 + r * sinf(a));
+            }
+            vkvg_close_path(ctx);
+            for (int i = 0; i < n / 10; i++) {
+                float a = -2 * pi * i / (n / 10);
+                if (i == 0)
+                    vkvg_move_to(ctx, 256 + 100 * cosf(a), 256 + 100 * sinf(a));
+                else
+                    vkvg_line_to(ctx, 256 + 100 * cosf(a), 256 + 100 * sinf(a));
+            }
+            vkvg_close_path(ctx);
+
+            auto start = std::chrono::steady_clock::now();
+            vkvg_fill(ctx);
+            vkvg_flush(ctx);
+            auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+            RecordProperty((tess ? "tess_fill_ms_" : "fill_ms_") + std::to_string(n), (int)ms.count());
+
+            EXPECT_EQ(VKVG_STATUS_SUCCESS, vkvg_status(ctx));
+            vkvg_destroy(ctx);
+
+            EXPECT_EQ(VKVG_STATUS_SUCCESS, vkvg_surface_write_to_memory(surf, bmp));
+            EXPECT_EQ(0, alphaAt(256, 256));
+            EXPECT_EQ(255, alphaAt(256, 90));
+            EXPECT_EQ(0, alphaAt(10, 10));
+        }
+    }
+    free(bmp);
+}
+TEST_F(ContextTest, CtxEarcutFill) {
+    const uint32_t size = 512 * 512 * 4;
+    unsigned char *bmp  = (unsigned char *)malloc(size);
+    auto alphaAt        = [&](int x, int y) { return bmp[(y * 512 + x) * 4 + 3]; };
+
+    // small concave paths, tesselated by the ear clipper when no tesselator is enabled.
+    vkvg_device_set_stencil_fill_threshold(dev, UINT32_MAX);
+    for (int shape = 0; shape < 3; shape++) {
+        VkvgContext ctx = vkvg_create(surf);
+        vkvg_clear(ctx);
+        vkvg_set_source_rgb(ctx, 1, 1, 1);
+        if (shape == 0) {
+            // notched square with a reversed triangle hole
+            vkvg_move_to(ctx, 100, 100);
+            vkvg_line_to(ctx, 400, 100);
+            vkvg_line_to(ctx, 400, 400);
+            vkvg_line_to(ctx, 250, 330);
+            vkvg_line_to(ctx, 100, 400);
+            vkvg_close_path(ctx);
+            vkvg_move_to(ctx, 200, 150);
+            vkvg_line_to(ctx, 250, 250);
+            vkvg_line_to(ctx, 300, 150);
+            vkvg_close_path(ctx);
+        } else if (shape == 1) {
+            // two lobes touching at one vertex, no ear is left until the polygon is split there.
+            vkvg_move_to(ctx, 100, 100);
+            vkvg_line_to(ctx, 250, 250);
+            vkvg_line_to(ctx, 400, 100);
+            vkvg_line_to(ctx, 400, 400);
+            vkvg_line_to(ctx, 250, 250);
+            vkvg_line_to(ctx, 100, 400);
+            vkvg_close_path(ctx);
+        } else {
+            // collinear points and a zero width spike, then a flat ring and an open segment.
+            vkvg_move_to(ctx, 100, 100);
+            vkvg_line_to(ctx, 250, 100);
+            vkvg_line_to(ctx, 400, 100);
+            vkvg_line_to(ctx, 400, 250);
+            vkvg_line_to(ctx, 480, 250);
+            vkvg_line_to(ctx, 400, 250);
+            vkvg_line_to(ctx, 400, 400);
+            vkvg_line_to(ctx, 250, 250);
+            vkvg_line_to(ctx, 100, 400);
+            vkvg_close_path(ctx);
+            vkvg_move_to(ctx, 50, 450);
+            vkvg_line_to(ctx, 250, 450);
+            vkvg_line_to(ctx, 450, 450);
+            vkvg_close_path(ctx);
+            vkvg_move_to(ctx, 20, 20);
+            vkvg_line_to(ctx, 20, 200);
+        }
+        vkvg_fill(ctx);
+        EXPECT_EQ(VKVG_STATUS_SUCCESS, vkvg_status(ctx));
+        vkvg_destroy(ctx);
+
+        EXPECT_EQ(VKVG_STATUS_SUCCESS, vkvg_surface_write_to_memory(surf, bmp));
+        EXPECT_EQ(0, alphaAt(10, 10));
+        if (shape == 0) {
+            EXPECT_EQ(0, alphaAt(250, 180));
+            EXPECT_EQ(255, alphaAt(150, 130));
+            EXPECT_EQ(255, alphaAt(110, 300));
+            EXPECT_EQ(0, alphaAt(250, 380));
+        } else if (shape == 1) {
+            EXPECT_EQ(255, alphaAt(150, 250));
+            EXPECT_EQ(255, alphaAt(350, 250));
+            EXPECT_EQ(0, alphaAt(250, 150));
+            EXPECT_EQ(0, alphaAt(250, 350));
+        } else {
+            EXPECT_EQ(255, alphaAt(250, 200));
+            EXPECT_EQ(255, alphaAt(110, 300));
+            EXPECT_EQ(0, alphaAt(250, 350));
+            EXPECT_EQ(0, alphaAt(440, 240));
+            EXPECT_EQ(0, alphaAt(250, 450));
+            EXPECT_EQ(0, alphaAt(20, 100));
+        }
+    }
+    free(bmp);
+}
+
+TEST_F(ContextTest, CtxConvexFill) {
+    const uint32_t size = 512 * 512 * 4;
+    unsigned char *bmp  = (unsigned char *)malloc(size);
+    auto alphaAt        = [&](int x, int y) { return bmp[(y * 512 + x) * 4 + 3]; };
+
+    for (int shape = 0; shape < 3; shape++) {
+        VkvgContext ctx = vkvg_create(surf);
+        vkvg_clear(ctx);
+        vkvg_set_source_rgb(ctx, 1, 1, 1);
+        if (shape == 0)
+            vkvg_ellipse(ctx, 200, 100, 256, 256, 0);
+        else if (shape == 1)
+            vkvg_rounded_rectangle(ctx, 56, 56, 400, 400, 60);
+        else {
+            // notched square starting next to the notch, a fan from the first point would cover it.
+            vkvg_move_to(ctx, 100, 400);
+            vkvg_line_to(ctx, 100, 100);
+            vkvg_line_to(ctx, 400, 100);
+            vkvg_line_to(ctx, 400, 400);
+            vkvg_line_to(ctx, 250, 250);
+            vkvg_close_path(ctx);
+        }
+        vkvg_fill(ctx);
+        EXPECT_EQ(VKVG_STATUS_SUCCESS, vkvg_status(ctx));
+        vkvg_destroy(ctx);
+
+        EXPECT_EQ(VKVG_STATUS_SUCCESS, vkvg_surface_write_to_memory(surf, bmp));
+        EXPECT_EQ(0, alphaAt(10, 10));
+        if (shape == 0) {
+            EXPECT_EQ(255, alphaAt(256, 256));
+            EXPECT_EQ(255, alphaAt(446, 256));
+            EXPECT_EQ(0, alphaAt(256, 366));
+        } else if (shape == 1) {
+            EXPECT_EQ(255, alphaAt(256, 256));
+            EXPECT_EQ(255, alphaAt(256, 60));
+            EXPECT_EQ(0, alphaAt(60, 60));
+        } else {
+            EXPECT_EQ(255, alphaAt(250, 200));
+            EXPECT_EQ(0, alphaAt(250, 350));
+        }
+    }
+    free(bmp);
+}
+
+TEST_F(ContextTest, CtxAnalyticAA) {
+    vkvg_device_create_info_t info{};
+    info.analyticAA    = true;
+    VkvgDevice  aaDev  = vkvg_device_create(&info);
+    VkvgSurface aaSurf = vkvg_surface_create(aaDev, 512, 512);
+    EXPECT_EQ(VKVG_STATUS_SUCCESS, vkvg_device_status(aaDev));
+
+    const uint32_t size = 512 * 512 * 4;
+    unsigned char *bmp  = (unsigned char *)malloc(size);
+    auto alphaAt        = [&](int x, int y) { return bmp[(y * 512 + x) * 4 + 3]; };
+
+    VkvgContext ctx = vkvg_create(aaSurf);
+    vkvg_clear(ctx);
+    vkvg_set_source_rgb(ctx, 1, 1, 1);
+    // pixel centers a quarter pixel outside the edges fall in the fringes.
+    vkvg_arc(ctx, 256, 256, 150.25f, 0, 2 * 3.14159265f);
+    vkvg_fill(ctx);
+    vkvg_set_line_width(ctx, 2);
+    vkvg_move_to(ctx, 20, 480.25f);
+    vkvg_line_to(ctx, 492, 480.25f);
+    vkvg_stroke(ctx);
+    EXPECT_EQ(VKVG_STATUS_SUCCESS, vkvg_status(ctx));
+    vkvg_destroy(ctx);
+
+    EXPECT_EQ(VKVG_STATUS_SUCCESS, vkvg_surface_write_to_memory(aaSurf, bmp));
+    EXPECT_EQ(255, alphaAt(256, 256));
+    EXPECT_EQ(0, alphaAt(10, 10));
+    EXPECT_LT(0, alphaAt(406, 256));
+    EXPECT_GT(255, alphaAt(406, 256));
+    EXPECT_EQ(255, alphaAt(256, 480));
+    EXPECT_LT(0, alphaAt(256, 481));
+    EXPECT_GT(255, alphaAt(256, 481));
+
+    free(bmp);
+    vkvg_surface_destroy(aaSurf);
+    vkvg_device_destroy(aaDev);
+}
+TEST_F(ContextTest, CtxAnalyticAAFillRules) {
+    vkvg_device_create_info_t info{};
+    info.analyticAA    = true;
+    VkvgDevice  aaDev  = vkvg_device_create(&info);
+    VkvgSurface aaSurf = vkvg_surface_create(aaDev, 512, 512);
+    EXPECT_EQ(VKVG_STATUS_SUCCESS, vkvg_device_status(aaDev));
+
+    const uint32_t size = 512 * 512 * 4;
+    unsigned char *bmp  = (unsigned char *)malloc(size);
+    auto alphaAt        = [&](int x, int y) { return bmp[(y * 512 + x) * 4 + 3]; };
+
+    // even-odd hole wound as its outer ring, its fringe is inside the hole.
+    VkvgContext ctx = vkvg_create(aaSurf);
+    vkvg_clear(ctx);
+    vkvg_set_source_rgb(ctx, 1, 1, 1);
+    vkvg_set_fill_rule(ctx, VKVG_FILL_RULE_EVEN_ODD);
+    vkvg_rectangle(ctx, 100, 100, 300, 300);
+    vkvg_rectangle(ctx, 200.25f, 200, 100, 100);
+    vkvg_fill(ctx);
+    EXPECT_EQ(VKVG_STATUS_SUCCESS, vkvg_status(ctx));
+    vkvg_destroy(ctx);
+
+    EXPECT_EQ(VKVG_STATUS_SUCCESS, vkvg_surface_write_to_memory(aaSurf, bmp));
+    EXPECT_EQ(255, alphaAt(150, 250));
+    EXPECT_EQ(255, alphaAt(199, 250));
+    EXPECT_LT(0, alphaAt(200, 250));
+    EXPECT_GT(255, alphaAt(200, 250));
+    EXPECT_EQ(0, alphaAt(250, 250));
+
+    // translucent self intersecting star, the edges crossing the fill get no fringe.
+    ctx = vkvg_create(aaSurf);
+    vkvg_clear(ctx);
+    vkvg_set_source_rgba(ctx, 1, 1, 1, 0.5f);
+    const float pi = 3.14159265f;
+    for (int i = 0; i < 5; i++) {
+        float a = -pi / 2 + i * 4 * pi / 5;
+        if (i == 0)
+            vkvg_move_to(ctx, 256 + 200 * cosf(a), 256 + 200 * sinf(a));
+        else
+            vkvg_line_to(ctx, 256 + 200 * cosf(a), 256 + 200 * sinf(a));
+    }
+    vkvg_close_path(ctx);
+    vkvg_fill(ctx);
+    EXPECT_EQ(VKVG_STATUS_SUCCESS, vkvg_status(ctx));
+    vkvg_destroy(ctx);
+
+    EXPECT_EQ(VKVG_STATUS_SUCCESS, vkvg_surface_write_to_memory(aaSurf, bmp));
+    // the horizontal line through the center stays in the star, crossing the inner pentagon edges.
+    int center = alphaAt(256, 256);
+    EXPECT_LT(0, center);
+    for (int x = 170; x < 342; x++)
+        EXPECT_NEAR(center, alphaAt(x, 256), 2) << "x = " << x;
+
+    free(bmp);
+    vkvg_surface_destroy(aaSurf);
+    vkvg_device_destroy(aaDev);
+}
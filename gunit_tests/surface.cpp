@@ -117,3 +117,63 @@ TEST_F(SurfaceTest, SurfClear) {
     checkPixels(surf, 0x00000000);
     vkvg_surface_destroy(surf);
 }
+
+TEST_F(SurfaceTest, SurfPool) {
+    vkvg_surface_pool_stats_t stats = vkvg_device_get_surface_pool_stats(dev);
+    EXPECT_EQ(0, stats.maxCount);
+
+    vkvg_device_set_surface_pool_size(dev, 2);
+
+    VkvgSurface surf = vkvg_surface_create(dev, 64, 64);
+    EXPECT_EQ(VKVG_STATUS_SUCCESS, vkvg_surface_status(surf));
+    vkvg_surface_destroy(surf);
+
+    stats = vkvg_device_get_surface_pool_stats(dev);
+    EXPECT_EQ(1, stats.count);
+    EXPECT_EQ(2, stats.maxCount);
+    EXPECT_EQ(0, stats.hits);
+    EXPECT_EQ(1, stats.misses);
+
+    surf = vkvg_surface_create(dev, 64, 64);
+    EXPECT_EQ(VKVG_STATUS_SUCCESS, vkvg_surface_status(surf));
+    EXPECT_EQ(1, vkvg_surface_get_reference_count(surf));
+    checkPixels(surf, 0x00000000);
+
+    VkvgSurface surf2 = vkvg_surface_create(dev, 32, 32);
+
+    stats = vkvg_device_get_surface_pool_stats(dev);
+    EXPECT_EQ(0, stats.count);
+    EXPECT_EQ(1, stats.hits);
+    EXPECT_EQ(2, stats.misses);
+
+    vkvg_surface_destroy(surf);
+    vkvg_surface_destroy(surf2);
+
+    vkvg_device_set_surface_pool_size(dev, 0);
+    stats = vkvg_device_get_surface_pool_stats(dev);
+    EXPECT_EQ(0, stats.count);
+    EXPECT_EQ(0, stats.maxCount);
+}
+
+TEST_F(SurfaceTest, SurfSharedStencil) {
+    const uint32_t imgSize = 8;
+    vkvg_device_set_shared_stencil(dev, true);
+
+    VkvgSurface surf = vkvg_surface_create(dev, imgSize, imgSize);
+    EXPECT_EQ(VKVG_STATUS_SUCCESS, vkvg_surface_status(surf));
+
+    for (int i = 0; i < 2; i++) {
+        VkvgContext ctx = vkvg_create(surf);
+        EXPECT_EQ(VKVG_STATUS_SUCCESS, vkvg_status(ctx));
+        vkvg_rectangle(ctx, 0, 0, imgSize, imgSize);
+        vkvg_clip(ctx);
+        vkvg_set_source_rgb(ctx, 1, 0, 0);
+        vkvg_paint(ctx);
+        vkvg_destroy(ctx);
+    }
+    vkvg_surface_clear(surf);
+    checkPixels(surf, 0x00000000);
+
+    vkvg_surface_destroy(surf);
+    vkvg_device_set_shared_stencil(dev, false);
+}
@@ -218,6 +218,10 @@ typedef enum {
  * with #vkvg_set_fill_rule and #vkvg_get_fill_rule.
  *
  * All further drawing and clipping operations are affected by this setting.
+ *
+ * Large non-zero paths are filled on the stencil with a 3 bits winding counter. Paths winding 8 times or more on a
+ * sample, as spirals, stars or many overlapping subpaths, are tesselated instead. The winding is first bounded from
+ * the direction reversals of the subpaths, heavily jagged outlines are then checked on each row of samples.
  */
 typedef enum {
     VKVG_FILL_RULE_EVEN_ODD, /*!< even-odd fill rule */
@@ -342,6 +346,9 @@ typedef struct {
     uint32_t sizeIndices;  /**< maximum size of host index cache			*/
     uint32_t sizeVBO;      /**< maximum size of vulkan vertex buffer		*/
     uint32_t sizeIBO;      /**< maximum size of vulkan index buffer		*/
+    uint32_t arrayGrowths; /**< count of host arrays and vulkan buffers growths	*/
+    uint32_t arrayShrinks; /**< count of host arrays shrunk to their high-water mark when a context is cached */
+    uint32_t curvePoints;  /**< count of points emitted by bezier curves flattening */
 } vkvg_debug_stats_t;
 
 vkvg_debug_stats_t vkvg_device_get_stats(VkvgDevice dev);
@@ -527,7 +534,7 @@ vkvg_public void          vkvg_matrix_get_scale(const vkvg_matrix_t *matrix, flo
  * Antialiasing level is configured when creating the device by selecting the sample count.
  * @ref vkvg_device_create will create a non-antialiased dev by selecting VK_SAMPLE_COUNT_1_BIT as sample count.
  * To create antialiased rendering device, call @ref vkvg_device_create_multisample with VkSampleCountFlags
- * greater than one.
+ * greater than one, or enable the analytic antialiasing of single sampled devices that costs no extra memory.
  *
  * vkvg use a single frame buffer format for now: VK_FORMAT_B8G8R8A8_UNORM.
  *
@@ -548,9 +555,17 @@ vkvg_public void          vkvg_matrix_get_scale(const vkvg_matrix_t *matrix, flo
  * @vkdev: vulkan logical device, may be null to create a new one.
  * @qFamIdx: graphic queue family index, ignored if vkdev is NULL.
  * @qIndex: queue index, ignored if vkdev is NULL.
+ * @qCount: count of queues of the family starting at qIndex usable by vkvg, ignored if vkdev is NULL or if the
+ * device is not thread aware. All of them must have been created with vkdev, the count is only clamped to the queue
+ * count of the family. If vkdev is NULL, all the queues of the graphic family are used up to a maximum of 4.
+ * Surfaces are assigned one of those queues round-robin, and their contexts submit to it. Surfaces drawn on
+ * different queues are synchronized with timeline semaphores, without them a single queue is used.
  * @deferredResolve: If true, the final simple sampled image of the surface will only be resolved on demand
  * when calling @ref vkvg_surface_get_vk_image or by explicitly calling @ref vkvg_multisample_surface_resolve.
  * If false, multisampled image is resolved on each draw operation.
+ * @analyticAA: single sampled devices only, fills and strokes get a half pixel wide fringe fading their edges
+ * instead of multisampling. Fills other than a single convex subpath are done on the stencil to find the outer
+ * side of their edges. Clipping stays aliased.
  */
 typedef struct {
     VkSampleCountFlags samples;
@@ -561,6 +576,8 @@ typedef struct {
     uint32_t           qFamIdx;
     uint32_t           qIndex;
     bool               threadAware; /**< if true, mutex is created and guard device queue and caches access */
+    uint32_t           qCount;      /**< count of queues from qIndex, 0 or 1 for a single queue */
+    bool               analyticAA;  /**< if true and samples is 1, edges are antialiased with coverage fringes */
 } vkvg_device_create_info_t;
 
 vkvg_public
@@ -568,13 +585,156 @@ vkvg_public
      * @brief Set maximum cached context count.
      *
      * The context cache stored destroyed contexts per thread to speed-up new context creation.
-     * To disable context cache, call this method with maxCount=0.
+     * The limit applies to each thread destroying contexts, not to the whole device, so up to maxCount contexts
+     * may be kept for every drawing thread. Contexts are only reused by the thread that cached them, those of
+     * exited threads stay cached until the cache size is lowered or the device is destroyed.
+     * To disable context cache and release all the cached contexts, call this method with maxCount=0.
      *
      * @param dev A valid vkvg device pointer.
-     * @param maxCount The maximum count of saved contexts for fast context instanciation.
+     * @param maxCount The maximum count of saved contexts per thread for fast context instanciation.
      */
     void
     vkvg_device_set_context_cache_size(VkvgDevice dev, uint32_t maxCount);
+/**
+ * @brief Fill the context cache of the calling thread.
+ *
+ * Create contexts ahead of time and store them in the context cache of the calling thread, so that the next
+ * calls to #vkvg_create or #vkvg_create_with_hint from this thread do not allocate vulkan ressources.
+ * Contexts are created until count or the cache size set with #vkvg_device_set_context_cache_size is reached.
+ *
+ * @param dev A valid vkvg device pointer.
+ * @param count The count of contexts to create.
+ * @param vertexCount The vertex buffer capacity of the created contexts, 0 for the default size.
+ */
+vkvg_public void vkvg_device_prewarm_contexts(VkvgDevice dev, uint32_t count, uint32_t vertexCount);
+/**
+ * @brief Set the vertex buffer ring depth of new contexts.
+ *
+ * Each context submits its drawing commands through a ring of command buffers with their own vertex and
+ * index buffers. While the gpu processes a submission, the next ones may be recorded without waiting.
+ * A deeper ring allows more submissions in flight at the cost of more gpu memory per context. A depth of 1 makes
+ * every flush wait for the previous one to complete. The default depth is 2. Contexts already created
+ * keep their ring.
+ *
+ * @param dev A valid vkvg device pointer.
+ * @param depth The count of buffer segments per context, minimum is 1.
+ */
+vkvg_public void vkvg_device_set_buffer_ring_depth(VkvgDevice dev, uint32_t depth);
+/**
+ * @brief Share stencil attachments between surfaces.
+ *
+ * Stencil content is only relevant during the life of a context. When enabled, surfaces created afterward
+ * have no stencil image, each context acquires a scratch stencil of the surface size from the device on creation
+ * and gives it back on destruction, so that the memory used for stencils depends on the count of living contexts
+ * instead of the count of surfaces. This is mostly useful with multisampling, where stencils are multisampled.
+ * The multisampled color image stays owned by the surface, its samples are reloaded by each render pass.
+ * Shared stencils are disabled by default.
+ *
+ * @param dev A valid vkvg device pointer.
+ * @param shared true to create the next surfaces without stencil, false to restore the default behaviour and
+ * free the unused scratch stencils.
+ */
+vkvg_public void vkvg_device_set_shared_stencil(VkvgDevice dev, bool shared);
+/**
+ * @brief Surface pool statistics.
+ *
+ * @ingroup device
+ */
+typedef struct {
+    uint32_t count;    /**< surfaces currently kept in the pool */
+    uint32_t maxCount; /**< maximum count of pooled surfaces, 0 if pooling is disabled */
+    uint32_t hits;     /**< surface creations served by the pool */
+    uint32_t misses;   /**< surface creations with pooling enabled that allocated new images */
+} vkvg_surface_pool_stats_t;
+/**
+ * @brief Set the maximum count of pooled surfaces.
+ *
+ * When enabled, surfaces whose last reference is released are kept by the device instead of being destroyed,
+ * and #vkvg_surface_create reuses a pooled surface with the same size, avoiding the creation of its images and
+ * framebuffer. A pooled surface is reused once its last submission is complete, its content is cleared.
+ * When the pool is full, the oldest surface is destroyed. Surfaces created on foreign images are never pooled.
+ * Pooling is disabled by default.
+ *
+ * @param dev A valid vkvg device pointer.
+ * @param maxCount The maximum count of surfaces kept for reuse, 0 disables pooling and frees the pool.
+ */
+vkvg_public void vkvg_device_set_surface_pool_size(VkvgDevice dev, uint32_t maxCount);
+/**
+ * @brief Query the surface pool usage.
+ *
+ * @param dev A valid vkvg device pointer.
+ * @return The current pool size and limit, and the hit and miss counts since device creation.
+ */
+vkvg_public vkvg_surface_pool_stats_t vkvg_device_get_surface_pool_stats(VkvgDevice dev);
+/**
+ * @brief Device buffer arena statistics.
+ *
+ * @ingroup device
+ */
+typedef struct {
+    uint32_t blockCount;      /**< vulkan buffers allocated by the arena */
+    uint32_t allocationCount; /**< live sub allocations */
+    uint64_t reservedBytes;   /**< total size of the arena blocks */
+    uint64_t usedBytes;       /**< total size of the live sub allocations, rounded to powers of two */
+} vkvg_buffer_arena_stats_t;
+/**
+ * @brief Query the device buffer arena usage.
+ *
+ * The vertex, index and gradient buffers of the contexts are sub allocated in a few persistently mapped vulkan
+ * buffers owned by the device, so that context creation and buffer growth seldom allocate device memory.
+ *
+ * @param dev A valid vkvg device pointer.
+ * @return The current count and size of the arena blocks and of their live sub allocations.
+ */
+vkvg_public vkvg_buffer_arena_stats_t vkvg_device_get_buffer_arena_stats(VkvgDevice dev);
+/**
+ * @brief Set the growth factor of the context arrays.
+ *
+ * When the path, point, vertex or index arrays of a context or its vulkan buffers are too small, they are
+ * reallocated with their size multiplied by this factor, so that huge pathes need few reallocations. A factor
+ * of 1 gives the linear growth of the previous versions. Arrays grown beyond the needs of the last use of a
+ * context are shrunk when it is stored in the context cache. The default factor is 2.
+ *
+ * @param dev A valid vkvg device pointer.
+ * @param factor The size multiplier, values lower than 1 are clamped to 1.
+ */
+vkvg_public void vkvg_device_set_array_growth_factor(VkvgDevice dev, float factor);
+/**
+ * @brief Set the point count above which concave paths are filled on the stencil.
+ *
+ * Concave paths up to this count of points are tesselated and drawn in a single batched call, larger ones are
+ * filled on the stencil in two or three passes, unless their non-zero winding may wrap the stencil counter. Filling
+ * on the stencil costs nothing on the cpu whatever the path complexity. A count of UINT32_MAX tesselates every
+ * path, but even-odd ones when the sweep tesselator is disabled, 0 sends every concave path to the stencil. The
+ * default count is 512.
+ *
+ * @param dev A valid vkvg device pointer.
+ * @param pointCount The maximum point count of tesselated paths.
+ */
+vkvg_public void vkvg_device_set_stencil_fill_threshold(VkvgDevice dev, uint32_t pointCount);
+/**
+ * @brief Batch the submissions of the contexts of this device.
+ *
+ * By default, each context flush is submitted immediately to the vulkan queue. With batching enabled, context
+ * submissions are queued on the device and coalesced into a single queue submission when the threshold count
+ * is reached, on a call to #vkvg_device_submit_pending, or when the completion of one of them is waited for,
+ * for example by #vkvg_flush or #vkvg_wait. Completion is still tracked per context. This reduces the submission
+ * overhead when many small contexts are drawn per frame. Batches are submitted to the first queue of the device,
+ * so with several queues, only the surfaces assigned to it are batched.
+ *
+ * @param dev A valid vkvg device pointer.
+ * @param threshold The count of queued submissions triggering a batch submission, 0 disables batching.
+ */
+vkvg_public void vkvg_device_set_submit_batching(VkvgDevice dev, uint32_t threshold);
+/**
+ * @brief Submit the queued context submissions.
+ *
+ * When submission batching is enabled with #vkvg_device_set_submit_batching, submit all the context
+ * submissions queued on the device in a single queue submission, typically once per frame.
+ *
+ * @param dev A valid vkvg device pointer.
+ */
+vkvg_public void vkvg_device_submit_pending(VkvgDevice dev);
 /**
  * @brief Create a new vkvg device.
  *
@@ -904,6 +1064,45 @@ typedef enum _vkvg_operator {
  * @return A new #VkvgContext or null if an error occured.
  */
 vkvg_public VkvgContext vkvg_create(VkvgSurface surf);
+/**
+ * @brief Create a new vkvg context with a buffer capacity hint.
+ *
+ * Same as #vkvg_create, but among the cached contexts of the calling thread, the one with the vertex buffer
+ * capacity closest above vertexCount is selected, or the biggest one. If no context is cached, the new context
+ * buffers are sized for vertexCount vertices. Giving the expected vertex count of a drawing avoids buffer
+ * growth while drawing.
+ * @param surf Target surface of the drawing operations.
+ * @param vertexCount The expected count of vertices of the drawing, 0 for the default size.
+ * @return A new #VkvgContext or null if an error occured.
+ */
+vkvg_public VkvgContext vkvg_create_with_hint(VkvgSurface surf, uint32_t vertexCount);
+/**
+ * @brief Create a sub context recording into secondary command buffers.
+ *
+ * A sub context draws on the target surface of its parent, but records its commands into vulkan secondary command
+ * buffers with its own vertex and index buffers, so that several sub contexts may build disjoint layers of a frame
+ * from different threads. A sub context never submits, its commands are executed by the parent with
+ * #vkvg_execute_sub_context. It draws within the clipping of the parent at execution time.
+ *
+ * Because it cannot wait for its own commands, operations of a sub context requiring such a wait put it in error
+ * (#VKVG_STATUS_INVALID_STATUS): using more gradients or surface sources between two executions than the context
+ * caches can hold, or nesting more than three saves of a clipped state.
+ * @remark A sub context has to be destroyed with #vkvg_destroy only once the parent submission executing its commands
+ * is done, for example after a call to #vkvg_flush on the parent.
+ * @param ctx The parent context, which may not be a sub context itself.
+ * @return A new sub context.
+ */
+vkvg_public VkvgContext vkvg_create_sub_context(VkvgContext ctx);
+/**
+ * @brief Execute the commands recorded by a sub context.
+ *
+ * Commands recorded by sub since its previous execution are executed in recording order in the current command buffer
+ * of ctx, inside a single render pass. Successive calls define the drawing order of the layers, so the result does
+ * not depend on the recording threads scheduling. No other thread may use sub during this call.
+ * @param ctx The parent context.
+ * @param sub A sub context created from ctx with #vkvg_create_sub_context.
+ */
+vkvg_public void vkvg_execute_sub_context(VkvgContext ctx, VkvgContext sub);
 /**
  * @brief Destroy vkvg context.
  *
@@ -950,6 +1149,38 @@ vkvg_public uint32_t vkvg_get_reference_count(VkvgContext ctx);
  * @param ctx The vkvg context to flush.
  */
 vkvg_public void vkvg_flush(VkvgContext ctx);
+/**
+ * @brief Submit all the pending drawing operations without waiting for their completion.
+ *
+ * Like #vkvg_flush, all the delayed drawing commands of the context are submitted to the gpu, but
+ * the cpu is not blocked until the gpu has finished processing them, so the next frame may be recorded
+ * while the previous one is still drawn. The returned ticket identify the last submission of the context
+ * and may be passed to #vkvg_wait or #vkvg_is_complete. Tickets are only valid for the context that
+ * produced them and grow monotonically.
+ * @param ctx The vkvg context to flush.
+ * @return a ticket for the last submission of this context, 0 if nothing was ever submitted or on error.
+ */
+vkvg_public uint64_t vkvg_flush_async(VkvgContext ctx);
+/**
+ * @brief Wait for the completion of a submission returned by #vkvg_flush_async.
+ *
+ * Block the calling thread until the gpu has finished the drawing operations identified by the ticket,
+ * or until the timeout expires. A timeout does not affect the context status.
+ * @param ctx The vkvg context that produced the ticket.
+ * @param ticket a ticket returned by #vkvg_flush_async on this context.
+ * @param timeout maximum wait time in nanoseconds, 0 to only query the current state, UINT64_MAX to wait
+ * without limit.
+ * @return #VKVG_STATUS_SUCCESS if the submission is completed, #VKVG_STATUS_TIMEOUT if it is still pending when
+ * timeout expires, or #VKVG_STATUS_INVALID_INDEX if the ticket has not been issued by this context.
+ */
+vkvg_public vkvg_status_t vkvg_wait(VkvgContext ctx, uint64_t ticket, uint64_t timeout);
+/**
+ * @brief Query without blocking if a submission returned by #vkvg_flush_async is completed.
+ * @param ctx The vkvg context that produced the ticket.
+ * @param ticket a ticket returned by #vkvg_flush_async on this context.
+ * @return true if the gpu has finished the drawing operations identified by the ticket.
+ */
+vkvg_public bool vkvg_is_complete(VkvgContext ctx, uint64_t ticket);
 /**
  * @brief Start a new empty path.
  *
@@ -1327,6 +1558,7 @@ vkvg_public void vkvg_clip_preserve(VkvgContext ctx);
  * @brief Set global opacity for drawing operations.
  *
  * This global opacity factor will affect all further drawing operations, the default value is 1.
+ * Opacity is carried by the emitted vertices, changing it does not end the current draw call.
  *
  * @param ctx a valid context handle.
  * @param opacity global opacity value between 0..1.
@@ -1428,6 +1660,27 @@ vkvg_public void vkvg_set_miter_limit(VkvgContext ctx, float limit);
  * @return the current miter limit for the context.
  */
 vkvg_public float vkvg_get_miter_limit(VkvgContext ctx);
+/**
+ * @brief Set the curve flattening tolerance.
+ *
+ * Bezier curves and arcs are converted to polylines whose distance to the exact curve stays below this
+ * tolerance, expressed in device pixels. The current transformation is taken into account, so scaled down
+ * drawings emit fewer points. Higher values reduce vertex counts for thumbnails and overviews, lower values
+ * give smoother curves at high zoom. The default tolerance is 0.25 pixel, values under 0.01 are clamped.
+ *
+ * @param ctx a valid vkvg @ref context
+ * @param tolerance the new tolerance in device pixels.
+ */
+vkvg_public void vkvg_set_tolerance(VkvgContext ctx, float tolerance);
+/**
+ * @brief Get the curve flattening tolerance.
+ *
+ * Gets the current tolerance, as set by @ref vkvg_set_tolerance().
+ *
+ * @param ctx a valid vkvg @ref context
+ * @return the current tolerance in device pixels.
+ */
+vkvg_public float vkvg_get_tolerance(VkvgContext ctx);
 /**
  * @brief set line terminations for the next draw command.
  *
@@ -1451,6 +1704,26 @@ vkvg_public void vkvg_set_line_join(VkvgContext ctx, vkvg_line_join_t join);
  * @param op
  */
 vkvg_public void vkvg_set_operator(VkvgContext ctx, vkvg_operator_t op);
+/**
+ * @brief Allow reordering of draws with different operators.
+ *
+ * By default, each operator change ends the current draw call so that drawing order is kept. With draw reordering
+ * enabled, the caller guarantees that the pending draws commute, for example because they do not overlap, and
+ * draws are grouped by operator up to the next flush or state change ending the draw call, so that the draw call
+ * count does not depend on the count of operator changes. The relative order of draws with the same operator is
+ * kept. Reordering is disabled by default and for contexts reused from the context cache.
+ *
+ * @param ctx a valid vkvg @ref context
+ * @param enable true if draws with different operators may be reordered.
+ */
+vkvg_public void vkvg_set_draw_reordering(VkvgContext ctx, bool enable);
+/**
+ * @brief Query the draw reordering mode.
+ *
+ * @param ctx a valid vkvg @ref context
+ * @return true if draws with different operators may be reordered, see #vkvg_set_draw_reordering.
+ */
+vkvg_public bool vkvg_get_draw_reordering(VkvgContext ctx);
 /**
  * @brief
  *
@@ -1627,6 +1900,26 @@ vkvg_public void vkvg_set_matrix(VkvgContext ctx, const vkvg_matrix_t *matrix);
  * @param matrix a valid #vkvg_matrix_t pointer to receive the current context's transform.
  */
 vkvg_public void vkvg_get_matrix(VkvgContext ctx, vkvg_matrix_t *const matrix);
+/**
+ * @brief Keep draw calls batched across transformation changes.
+ *
+ * By default, the current matrix is applied to the vertices by the vertex shader, so each matrix change has to
+ * end the current draw call. With transform batching enabled, vertices are transformed on the cpu when they are
+ * emitted, and consecutive objects drawn with different transformations share the same draw call. Matrix
+ * changes still end the current draw call while the source is a surface, its mapping depending on the inverse
+ * matrix. Transform batching is disabled by default and for contexts reused from the context cache.
+ *
+ * @param ctx a valid vkvg @ref context
+ * @param enable true to transform vertices on the cpu, false to restore the default behaviour.
+ */
+vkvg_public void vkvg_set_transform_batching(VkvgContext ctx, bool enable);
+/**
+ * @brief Query the transform batching mode.
+ *
+ * @param ctx a valid vkvg @ref context
+ * @return true if vertices are transformed on the cpu, see #vkvg_set_transform_batching.
+ */
+vkvg_public bool vkvg_get_transform_batching(VkvgContext ctx);
 /**
  * @brief Set the current matrix to identity.
  *
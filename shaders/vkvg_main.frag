@@ -50,7 +50,7 @@ layout (set=1, binding = 0) uniform sampler2D		source;
 layout (location = 0) in vec3		inFontUV;	//if it is a text drawing, inFontUV.z hold fontMap layer
 layout (location = 1) in vec4		inSrc;		//source bounds or color depending on pattern type
 layout (location = 2) in flat int	inPatType;	//pattern type
-layout (location = 3) in flat float	inOpacity;
+layout (location = 3) in float		inOpacity;
 layout (location = 4) in mat3x2		inMat;
 
 layout (location = 0) out vec4 outFragColor;
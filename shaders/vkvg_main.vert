@@ -26,12 +26,16 @@
 
 layout (location = 0) in vec2	inPos;
 layout (location = 1) in vec4	inColor;
+#ifdef VKVG_COMPACT_VERTEX
+layout (location = 2) in uint	inUV;	//font cache texel coordinates on 12 bits and layer on the 8 high bits, 0xFF for none
+#else
 layout (location = 2) in vec3	inUV;
+#endif
 
 layout (location = 0) out vec3	outUV;
 layout (location = 1) out vec4	outSrc;
 layout (location = 2) out flat int outPatType;
-layout (location = 3) out flat float outOpacity;
+layout (location = 3) out float outOpacity;	//interpolated, fringe vertices of the analytic antialiasing fade it
 layout (location = 4) out mat3x2 outMat;
 /*out gl_PerVertex
 {
@@ -56,12 +60,15 @@ layout(push_constant) uniform PushConsts {
 #define MESH			4
 #define RASTER_SOURCE	5
 
+#define FONT_PAGE_SIZE	1024.0	//must match vkvg_fonts.h
+
 void main()
 {
 	outPatType	= pc.fullScreenQuad_srcType & SRCTYPE_MASK;
 	outMat		= pc.matInv;
 	outSrc		= outPatType == SOLID ? inColor : pc.source;
-	outOpacity	= pc.opacity;
+	//opacity is applied to solid vertex colors on the cpu, other sources have it in the vertex alpha.
+	outOpacity	= outPatType == SOLID ? 1.0f : inColor.a;
 
 	if ((pc.fullScreenQuad_srcType & FULLSCREEN_BIT)==FULLSCREEN_BIT) {
 		gl_Position = vec4(inPos, 0.0f, 1.0f);
@@ -69,7 +76,15 @@ void main()
 		return;
 	}
 
+#ifdef VKVG_COMPACT_VERTEX
+	uint layer = inUV >> 24;
+	if (layer == 0xFF)
+		outUV = vec3(0,0,-1);
+	else
+		outUV = vec3(vec2(inUV & 0xFFF, (inUV >> 12) & 0xFFF) / FONT_PAGE_SIZE, layer);
+#else
 	outUV = inUV;
+#endif
 
 	vec2 p = vec2(
 		pc.mat[0][0] * inPos.x + pc.mat[1][0] * inPos.y + pc.mat[2][0],
@@ -124,6 +124,7 @@ void _record(vkvg_recording_t *rec, ...) {
             switch (r->cmd) {
             case VKVG_CMD_SET_LINE_WIDTH:
             case VKVG_CMD_SET_MITER_LIMIT:
+            case VKVG_CMD_SET_TOLERANCE:
                 STORE_FLOATS(1);
                 break;
             case VKVG_CMD_SET_LINE_JOIN:
@@ -280,6 +281,9 @@ void _replay_command(VkvgContext ctx, VkvgRecording rec, uint32_t index) {
             case VKVG_CMD_SET_MITER_LIMIT:
                 vkvg_set_miter_limit(ctx, floats[0]);
                 return;
+            case VKVG_CMD_SET_TOLERANCE:
+                vkvg_set_tolerance(ctx, floats[0]);
+                return;
             case VKVG_CMD_SET_LINE_JOIN:
                 vkvg_set_line_join(ctx, (vkvg_line_join_t)uints[0]);
                 return;
@@ -57,6 +57,7 @@
 #define VKVG_CMD_SET_OPERATOR          (0x0005 | VKVG_CMD_PATHPROPS_COMMANDS)
 #define VKVG_CMD_SET_FILL_RULE         (0x0006 | VKVG_CMD_PATHPROPS_COMMANDS)
 #define VKVG_CMD_SET_DASH              (0x0007 | VKVG_CMD_PATHPROPS_COMMANDS)
+#define VKVG_CMD_SET_TOLERANCE         (0x0008 | VKVG_CMD_PATHPROPS_COMMANDS)
 
 #define VKVG_CMD_TRANSLATE             (0x0001 | VKVG_CMD_TRANSFORM_COMMANDS)
 #define VKVG_CMD_ROTATE                (0x0002 | VKVG_CMD_TRANSFORM_COMMANDS)
@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2018-2022 Jean-Philippe Bruyère <jp_bruyere@hotmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the
+ * Software, and to permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+// Bezier flattening with a segment count computed up front and forward differencing,
+// points are written directly in the context point array.
+
+#include "vkvg_context_internal.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define VKVG_BEZIER_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#define VKVG_BEZIER_NEON
+#include <arm_neon.h>
+#endif
+
+// polynomial coefficients of one axis: B(t) = ((a*t + b)*t + c)*t + d
+typedef struct {
+    float a, b, c, d;
+} bezier_coefs_t;
+
+static inline bezier_coefs_t _bezier_coefs(float p0, float p1, float p2, float p3) {
+    return (bezier_coefs_t){-p0 + 3.f * (p1 - p2) + p3, 3.f * (p0 - 2.f * p1 + p2), 3.f * (p1 - p0), p0};
+}
+
+uint32_t _bezier_segment_count(float tolerance, const vec2 p[4]) {
+    // Wang's formula: n = sqrt(3*2/8 * max|p[i] - 2p[i+1] + p[i+2]| / tolerance)
+    float ddx0 = p[0].x - 2.f * p[1].x + p[2].x, ddy0 = p[0].y - 2.f * p[1].y + p[2].y;
+    float ddx1 = p[1].x - 2.f * p[2].x + p[3].x, ddy1 = p[1].y - 2.f * p[2].y + p[3].y;
+    float dd   = fmaxf(ddx0 * ddx0 + ddy0 * ddy0, ddx1 * ddx1 + ddy1 * ddy1);
+    float n    = ceilf(sqrtf(0.75f * sqrtf(dd) / tolerance));
+    if (!(n > 1.f)) // also catch NaN
+        return 1;
+    return n < (float)VKVG_BEZIER_MAX_SEGMENTS ? (uint32_t)n : VKVG_BEZIER_MAX_SEGMENTS;
+}
+
+// initial values of 4 lanes starting at t = t0 + i*h, with forward differences of step 4h
+static void _bezier_lanes_init(bezier_coefs_t k, float t0, float h, float *v, float *d1, float *d2, float *d3) {
+    float H = 4.f * h, H2 = H * H, H3 = H2 * H;
+    for (uint32_t i = 0; i < 4; i++) {
+        float t = t0 + (float)i * h;
+        v[i]    = ((k.a * t + k.b) * t + k.c) * t + k.d;
+        d1[i]   = k.a * (3.f * t * t * H + 3.f * t * H2 + H3) + k.b * (2.f * t * H + H2) + k.c * H;
+        d2[i]   = k.a * (6.f * t * H2 + 6.f * H3) + 2.f * k.b * H2;
+        d3[i]   = 6.f * k.a * H3;
+    }
+}
+
+#if defined(VKVG_BEZIER_SSE2) || defined(VKVG_BEZIER_NEON)
+static void _bezier_forward_diff_simd(bezier_coefs_t kx, bezier_coefs_t ky, uint32_t count, float h, vec2 *out) {
+    float vx[4], dx1[4], dx2[4], dx3[4], vy[4], dy1[4], dy2[4], dy3[4];
+    _bezier_lanes_init(kx, h, h, vx, dx1, dx2, dx3);
+    _bezier_lanes_init(ky, h, h, vy, dy1, dy2, dy3);
+
+    uint32_t i = 0;
+#ifdef VKVG_BEZIER_SSE2
+    __m128 px = _mm_loadu_ps(vx), px1 = _mm_loadu_ps(dx1), px2 = _mm_loadu_ps(dx2), px3 = _mm_loadu_ps(dx3);
+    __m128 py = _mm_loadu_ps(vy), py1 = _mm_loadu_ps(dy1), py2 = _mm_loadu_ps(dy2), py3 = _mm_loadu_ps(dy3);
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_ps((float *)(out + i), _mm_unpacklo_ps(px, py));
+        _mm_storeu_ps((float *)(out + i + 2), _mm_unpackhi_ps(px, py));
+        px  = _mm_add_ps(px, px1);
+        px1 = _mm_add_ps(px1, px2);
+        px2 = _mm_add_ps(px2, px3);
+        py  = _mm_add_ps(py, py1);
+        py1 = _mm_add_ps(py1, py2);
+        py2 = _mm_add_ps(py2, py3);
+    }
+    if (i < count) {
+        vec2 tmp[4];
+        _mm_storeu_ps((float *)tmp, _mm_unpacklo_ps(px, py));
+        _mm_storeu_ps((float *)(tmp + 2), _mm_unpackhi_ps(px, py));
+        memcpy(out + i, tmp, (count - i) * sizeof(vec2));
+    }
+#else
+    float32x4x2_t p  = {{vld1q_f32(vx), vld1q_f32(vy)}};
+    float32x4_t   px1 = vld1q_f32(dx1), px2 = vld1q_f32(dx2), px3 = vld1q_f32(dx3);
+    float32x4_t   py1 = vld1q_f32(dy1), py2 = vld1q_f32(dy2), py3 = vld1q_f32(dy3);
+    for (; i + 4 <= count; i += 4) {
+        vst2q_f32((float *)(out + i), p);
+        p.val[0] = vaddq_f32(p.val[0], px1);
+        px1      = vaddq_f32(px1, px2);
+        px2      = vaddq_f32(px2, px3);
+        p.val[1] = vaddq_f32(p.val[1], py1);
+        py1      = vaddq_f32(py1, py2);
+        py2      = vaddq_f32(py2, py3);
+    }
+    if (i < count) {
+        vec2 tmp[4];
+        vst2q_f32((float *)tmp, p);
+        memcpy(out + i, tmp, (count - i) * sizeof(vec2));
+    }
+#endif
+}
+#endif
+
+static void _bezier_forward_diff_scalar(bezier_coefs_t kx, bezier_coefs_t ky, uint32_t count, float h, vec2 *out) {
+    float h2 = h * h, h3 = h2 * h;
+    vec2  p  = {kx.d, ky.d};
+    vec2  d1 = {kx.a * h3 + kx.b * h2 + kx.c * h, ky.a * h3 + ky.b * h2 + ky.c * h};
+    vec2  d2 = {6.f * kx.a * h3 + 2.f * kx.b * h2, 6.f * ky.a * h3 + 2.f * ky.b * h2};
+    vec2  d3 = {6.f * kx.a * h3, 6.f * ky.a * h3};
+    for (uint32_t i = 0; i < count; i++) {
+        p      = vec2_add(p, d1);
+        d1     = vec2_add(d1, d2);
+        d2     = vec2_add(d2, d3);
+        out[i] = p;
+    }
+}
+
+void _bezier_forward_diff(const vec2 p[4], uint32_t segments, vec2 *out) {
+    bezier_coefs_t kx    = _bezier_coefs(p[0].x, p[1].x, p[2].x, p[3].x);
+    bezier_coefs_t ky    = _bezier_coefs(p[0].y, p[1].y, p[2].y, p[3].y);
+    uint32_t       count = segments - 1;
+    float          h     = 1.f / (float)segments;
+#if defined(VKVG_BEZIER_SSE2) || defined(VKVG_BEZIER_NEON)
+    if (count >= 4) {
+        _bezier_forward_diff_simd(kx, ky, count, h, out);
+        return;
+    }
+#endif
+    _bezier_forward_diff_scalar(kx, ky, count, h, out);
+}
+
+void _flatten_bezier(VkvgContext ctx, float tolerance, float x1, float y1, float x2, float y2, float x3, float y3,
+                     float x4, float y4) {
+    vec2     p[4]     = {{x1, y1}, {x2, y2}, {x3, y3}, {x4, y4}};
+    uint32_t segments = _bezier_segment_count(tolerance, p);
+    if (segments < 2)
+        return;
+    // the end point is added by the caller.
+    if (_ensure_point_array(ctx, segments))
+        return;
+    _bezier_forward_diff(p, segments, &ctx->points[ctx->pointCount]);
+
+    uint32_t added = segments - 1;
+    for (uint32_t i = ctx->pointCount; i < ctx->pointCount + added; i++)
+        _update_convexity(ctx, vec2_sub(ctx->points[i], ctx->points[i - 1]));
+    ctx->pointCount += added;
+    ctx->pathes[ctx->pathPtr] += added;
+    if (ctx->segmentPtr > 0)
+        ctx->pathes[ctx->pathPtr + ctx->segmentPtr] += added;
+}
@@ -0,0 +1,189 @@
+/*
+ * Copyright (c) 2018-2022 Jean-Philippe Bruyère <jp_bruyere@hotmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the
+ * Software, and to permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "vkvg_buffer_arena.h"
+#include "vkvg_device_internal.h"
+
+#define ARENA_LOCK(dev)                                                                                                \
+    if ((dev)->threadAware)                                                                                            \
+        mtx_lock(&(dev)->arena.mutex);
+#define ARENA_UNLOCK(dev)                                                                                              \
+    if ((dev)->threadAware)                                                                                            \
+        mtx_unlock(&(dev)->arena.mutex);
+
+// smallest order whose span in VKVG_ARENA_MIN_ALLOC units holds size bytes.
+static uint32_t _arena_order(VkDeviceSize size) {
+    uint32_t     order = 0;
+    VkDeviceSize span  = VKVG_ARENA_MIN_ALLOC;
+    while (span < size) {
+        span <<= 1;
+        order++;
+    }
+    return order;
+}
+// recompute the free orders of the ancestors of node i after a change.
+static void _arena_update_parents(vkvg_arena_block_t *block, uint32_t i, uint32_t order) {
+    while (i > 0) {
+        i = (i - 1) / 2;
+        order++;
+        uint8_t l = block->tree[2 * i + 1], r = block->tree[2 * i + 2];
+        // both halves entirely free merge into a free span of this order.
+        block->tree[i] = (l == order && r == order) ? (uint8_t)(order + 1) : MAX(l, r);
+    }
+}
+static vkvg_arena_block_t *_arena_create_block(VkvgDevice dev, uint32_t maxOrder) {
+    vkvg_arena_block_t *block = (vkvg_arena_block_t *)calloc(1, sizeof(vkvg_arena_block_t));
+    if (!block)
+        return NULL;
+    uint32_t nodeCount = (2u << maxOrder) - 1;
+    block->tree        = (uint8_t *)malloc(nodeCount);
+    if (!block->tree) {
+        free(block);
+        return NULL;
+    }
+    block->maxOrder = maxOrder;
+    // every node is free, its largest free span is its own order.
+    for (uint32_t depth = 0, first = 0; depth <= maxOrder; depth++, first = first * 2 + 1)
+        memset(&block->tree[first], (int)(maxOrder - depth + 1), (size_t)1 << depth);
+
+    VkDeviceSize size = (VkDeviceSize)VKVG_ARENA_MIN_ALLOC << maxOrder;
+    vkh_buffer_init((VkhDevice)&dev->vkDev,
+                    VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT |
+                        VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+                    VKH_MEMORY_USAGE_CPU_TO_GPU, size, &block->buff, true);
+    if (block->buff.buffer == VK_NULL_HANDLE || !vkh_buffer_get_mapped_pointer(&block->buff)) {
+        LOG(VKVG_LOG_ERR, "Buffer arena: block allocation failed (%lu bytes)\n", (unsigned long)size);
+        vkh_buffer_reset(&block->buff);
+        free(block->tree);
+        free(block);
+        return NULL;
+    }
+#if defined(DEBUG) && defined(VKVG_DBG_UTILS)
+    vkh_device_set_object_name((VkhDevice)&dev->vkDev, VK_OBJECT_TYPE_BUFFER, (uint64_t)block->buff.buffer,
+                               "Device Arena Block");
+#endif
+    dev->arena.blockCount++;
+    dev->arena.reservedBytes += size;
+    return block;
+}
+static void _arena_destroy_block(VkvgDevice dev, vkvg_arena_block_t *block) {
+    dev->arena.blockCount--;
+    dev->arena.reservedBytes -= (VkDeviceSize)VKVG_ARENA_MIN_ALLOC << block->maxOrder;
+    vkh_buffer_reset(&block->buff);
+    free(block->tree);
+    free(block);
+}
+// take the leftmost free span of the requested order in the block, return false if none.
+static bool _arena_block_alloc(vkvg_arena_block_t *block, uint32_t order, VkDeviceSize *offset) {
+    if (block->tree[0] < order + 1)
+        return false;
+    uint32_t i = 0;
+    for (uint32_t o = block->maxOrder; o > order; o--) {
+        i = 2 * i + 1;
+        if (block->tree[i] < order + 1)
+            i++; // left half is too fragmented, right one has a span large enough.
+    }
+    block->tree[i] = 0;
+    _arena_update_parents(block, i, order);
+    block->allocCount++;
+
+    uint32_t levelFirst = (1u << (block->maxOrder - order)) - 1;
+    *offset             = ((VkDeviceSize)(i - levelFirst) << order) * VKVG_ARENA_MIN_ALLOC;
+    return true;
+}
+
+bool _arena_alloc(VkvgDevice dev, VkDeviceSize size, vkvg_buffer_range_t *range) {
+    uint32_t order = _arena_order(size);
+    bool     res   = false;
+
+    ARENA_LOCK(dev);
+
+    vkvg_arena_block_t *block = dev->arena.blocks;
+    while (block && (order > block->maxOrder || !_arena_block_alloc(block, order, &range->offset)))
+        block = block->pNext;
+
+    if (!block) {
+        // oversized requests get a dedicated block.
+        block = _arena_create_block(dev, MAX(order, _arena_order(VKVG_ARENA_BLOCK_SIZE)));
+        if (block) {
+            _arena_block_alloc(block, order, &range->offset);
+            block->pNext      = dev->arena.blocks;
+            dev->arena.blocks = block;
+        }
+    }
+    if (block) {
+        range->block = block;
+        range->size  = (VkDeviceSize)VKVG_ARENA_MIN_ALLOC << order;
+        dev->arena.usedBytes += range->size;
+        dev->arena.allocationCount++;
+        res = true;
+    }
+
+    ARENA_UNLOCK(dev);
+
+    LOG(VKVG_LOG_DBG_ARRAYS, "Buffer arena: alloc %lu bytes -> %s\n", (unsigned long)size, res ? "ok" : "failed");
+    return res;
+}
+void _arena_free(VkvgDevice dev, vkvg_buffer_range_t *range) {
+    vkvg_arena_block_t *block = range->block;
+    if (!block)
+        return;
+    uint32_t order = _arena_order(range->size);
+
+    ARENA_LOCK(dev);
+
+    uint32_t i     = (uint32_t)(range->offset / VKVG_ARENA_MIN_ALLOC >> order) + (1u << (block->maxOrder - order)) - 1;
+    block->tree[i] = (uint8_t)(order + 1);
+    _arena_update_parents(block, i, order);
+    block->allocCount--;
+
+    dev->arena.usedBytes -= range->size;
+    dev->arena.allocationCount--;
+
+    // keep a single default sized block for the next allocations.
+    if (block->allocCount == 0 &&
+        (dev->arena.blockCount > 1 || block->maxOrder > _arena_order(VKVG_ARENA_BLOCK_SIZE))) {
+        vkvg_arena_block_t **prev = &dev->arena.blocks;
+        while (*prev != block)
+            prev = &(*prev)->pNext;
+        *prev = block->pNext;
+        _arena_destroy_block(dev, block);
+    }
+
+    ARENA_UNLOCK(dev);
+
+    *range = (vkvg_buffer_range_t){0};
+}
+// called on device destruction, once the gpu is idle.
+void _arena_destroy(VkvgDevice dev) {
+    if (dev->arena.allocationCount > 0)
+        LOG(VKVG_LOG_ERR, "Buffer arena: %u allocations still alive on destroy\n", dev->arena.allocationCount);
+    while (dev->arena.blocks) {
+        vkvg_arena_block_t *next = dev->arena.blocks->pNext;
+        _arena_destroy_block(dev, dev->arena.blocks);
+        dev->arena.blocks = next;
+    }
+}
+void *_arena_get_mapped_pointer(vkvg_buffer_range_t *range) {
+    return (char *)vkh_buffer_get_mapped_pointer(&range->block->buff) + range->offset;
+}
+void _arena_flush(vkvg_buffer_range_t *range) { vkh_buffer_flush(&range->block->buff); }
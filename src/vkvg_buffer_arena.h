@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2018-2022 Jean-Philippe Bruyère <jp_bruyere@hotmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the
+ * Software, and to permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef VKVG_BUFFER_ARENA_H
+#define VKVG_BUFFER_ARENA_H
+
+#include "vkvg_internal.h"
+
+#define VKVG_ARENA_BLOCK_SIZE 0x400000 // default size of the device buffer arena blocks (4MB)
+#define VKVG_ARENA_MIN_ALLOC  256      // smallest sub allocation, keep offsets aligned for uniform buffers
+
+/* The device buffer arena sub allocates the vertex, index and uniform buffers of the contexts in a few big
+ * persistently mapped vulkan buffers, so that creating or growing a context buffer does not allocate device
+ * memory. Each block is managed by a binary buddy allocator, requests are rounded to the next power of two.
+ */
+typedef struct _vkvg_arena_block_t {
+    vkh_buffer_t                buff;       // vulkan buffer with persistent mapped memory
+    uint32_t                    maxOrder;   // log2 of the block size in VKVG_ARENA_MIN_ALLOC units
+    uint8_t                    *tree;       // buddy tree, per node the largest free order under it plus one, 0 if full
+    uint32_t                    allocCount; // live sub allocations, empty blocks are freed unless last
+    struct _vkvg_arena_block_t *pNext;
+} vkvg_arena_block_t;
+
+// sub allocation of a device arena block
+typedef struct {
+    vkvg_arena_block_t *block;  // owning block, NULL if not allocated
+    VkDeviceSize        offset; // offset in the block buffer, aligned on the allocation size
+    VkDeviceSize        size;   // usable size, the requested one rounded to the next power of two
+} vkvg_buffer_range_t;
+
+typedef struct {
+    mtx_t               mutex;           // used only if device is in thread aware mode
+    vkvg_arena_block_t *blocks;          // single linked list of blocks, newest first
+    uint32_t            blockCount;      // count of allocated blocks
+    VkDeviceSize        reservedBytes;   // total size of the blocks
+    VkDeviceSize        usedBytes;       // total size of the live sub allocations
+    uint32_t            allocationCount; // count of live sub allocations
+} vkvg_buffer_arena_t;
+
+bool  _arena_alloc(VkvgDevice dev, VkDeviceSize size, vkvg_buffer_range_t *range);
+void  _arena_free(VkvgDevice dev, vkvg_buffer_range_t *range);
+void  _arena_destroy(VkvgDevice dev);
+void *_arena_get_mapped_pointer(vkvg_buffer_range_t *range);
+void  _arena_flush(vkvg_buffer_range_t *range);
+#endif
@@ -24,6 +24,8 @@ static VkClearValue clearValues[3] = {
 void _init_ctx(VkvgContext ctx) {
     ctx->lineWidth                       = 1.f;
     ctx->miterLimit                      = 10.f;
+    ctx->tolerance                       = VKVG_CURVE_TOLERANCE;
+    ctx->matScale                        = 1.f;
     ctx->curOperator                     = VKVG_OPERATOR_OVER;
     ctx->curFillRule                     = VKVG_FILL_RULE_NON_ZERO;
     ctx->bounds                          = (VkRect2D){{0, 0}, {ctx->pSurf->width, ctx->pSurf->height}};
@@ -34,7 +36,12 @@ void _init_ctx(VkvgContext ctx) {
                                                             VKVG_IDENTITY_MATRIX,
                                                             VKVG_IDENTITY_MATRIX};
     ctx->clearRect                       = (VkClearRect){{{0}, {ctx->pSurf->width, ctx->pSurf->height}}, 0, 1};
+    ctx->stencil                         = ctx->pSurf->stencil;
     ctx->renderPassBeginInfo.framebuffer = ctx->pSurf->fb;
+    if (ctx->stencil == NULL && !ctx->secondary) { // sub contexts draw in the render pass of their parent.
+        ctx->stencil = _device_acquire_scratch_stencil(ctx->dev, ctx->pSurf->width, ctx->pSurf->height);
+        ctx->renderPassBeginInfo.framebuffer = _create_framebuffer_with_stencil(ctx->pSurf, ctx->stencil);
+    }
     ctx->renderPassBeginInfo.renderArea.extent.width  = ctx->pSurf->width;
     ctx->renderPassBeginInfo.renderArea.extent.height = ctx->pSurf->height;
     ctx->renderPassBeginInfo.pClearValues             = clearValues;
@@ -59,55 +66,44 @@ void _init_ctx(VkvgContext ctx) {
     ctx->selectedFontName[0] = 0;
     ctx->pattern             = NULL;
     ctx->curColor            = 0xff000000; // opaque black
+    ctx->vxColor             = ctx->curColor;
+    ctx->reorderDraws        = false;
+    ctx->opRangeCount        = 0;
     ctx->cmdStarted          = false;
     ctx->curClipState        = vkvg_clip_state_none;
 
 
-    ctx->vertCount = ctx->indCount = 0;
+    ctx->vertCount = ctx->indCount = ctx->xformVertBase = 0;
+    ctx->vertBase = ctx->indBase = 0;
+    ctx->gradCount = ctx->gradOffset = 0;
+    ctx->transformBatching           = false;
 #ifdef VKVG_ENABLE_VK_TIMELINE_SEMAPHORE
+    // timeline values are relative to the previous surface for cached contexts.
     ctx->timelineStep = 0;
+    for (uint32_t i = 0; i < ctx->vaoRingDepth; i++)
+        ctx->vaoRing[i].timelineStep = 0;
 #endif
 }
 
-VkvgContext vkvg_create(VkvgSurface surf) {
-    LOG(VKVG_LOG_INFO, "CREATE Context\n");
-    if (vkvg_surface_status(surf)) {
-        LOG(VKVG_LOG_ERR, "CREATE Context failed, invalid surface\n");
-        return (VkvgContext)&_vkvg_status_invalid_surface;
-    }
-    VkvgDevice  dev = surf->dev;
-    if (vkvg_device_status(dev)) {
-        LOG(VKVG_LOG_ERR, "CREATE Context failed, invalid device\n");
-        return (VkvgContext)&_vkvg_status_device_error;
-    }
-    VkvgContext ctx = NULL;
-
-    if (_device_try_get_cached_context(dev, &ctx)) {
-        ctx->pSurf = surf;
-        ctx->status = VKVG_STATUS_SUCCESS;
-        _init_ctx(ctx);
-        _update_descriptor_set(ctx, surf->dev->emptyImg, ctx->dsSrc);
-        _clear_path(ctx);
-        ctx->cmd = ctx->cmdBuffers[0]; // current recording buffer
-        return ctx;
-    }
-    ctx = (vkvg_context *)calloc(1, sizeof(vkvg_context));
+// allocate a new context with its vulkan ressources, without binding it to a surface. Buffers are sized for
+// sizeHint vertices if greater than the default size.
+VkvgContext _alloc_context(VkvgDevice dev, bool secondary, uint32_t sizeHint) {
+    VkvgContext ctx = (vkvg_context *)calloc(1, sizeof(vkvg_context));
 
     if (!ctx) {
         LOG(VKVG_LOG_ERR, "CREATE context failed, no memory\n");
         return (VkvgContext)&_vkvg_status_no_memory;
     }
 
-    LOG(VKVG_LOG_INFO, "CREATE Context: ctx = %p; surf = %p\n", ctx, surf);
-    ctx->pSurf = surf;
+    ctx->secondary = secondary;
 
     ctx->sizePoints   = VKVG_PTS_SIZE;
-    ctx->sizeVertices = ctx->sizeVBO = VKVG_VBO_SIZE;
-    ctx->sizeIndices = ctx->sizeIBO = VKVG_IBO_SIZE;
+    ctx->sizeVertices = ctx->sizeVBO = MAX(VKVG_VBO_SIZE, sizeHint);
+    ctx->sizeIndices = ctx->sizeIBO = MAX(VKVG_IBO_SIZE, sizeHint * (VKVG_IBO_SIZE / VKVG_VBO_SIZE));
     ctx->sizePathes                 = VKVG_PATHES_SIZE;
     ctx->renderPassBeginInfo.sType  = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
 
-    ctx->dev = surf->dev;
+    ctx->dev = dev;
 
     ctx->points      = (vec2 *)malloc(VKVG_VBO_SIZE * sizeof(vec2));
     ctx->pathes      = (uint32_t *)malloc(VKVG_PATHES_SIZE * sizeof(uint32_t));
@@ -128,31 +124,38 @@ VkvgContext vkvg_create(VkvgSurface surf) {
         return (VkvgContext)&_vkvg_status_no_memory;
     }
 
-    _init_ctx(ctx);
-
     VkhDevice vkhd = (VkhDevice)&dev->vkDev;
     // for context to be thread safe, command pool and descriptor pool have to be created in the thread of the context.
     ctx->cmdPool = vkh_cmd_pool_create(vkhd, dev->gQueue->familyIndex, VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT);
 
-#ifndef VKVG_ENABLE_VK_TIMELINE_SEMAPHORE
-    ctx->flushFence = vkh_fence_create_signaled((VkhDevice)&ctx->dev->vkDev);
+    _create_vao_ring(ctx);
+    if (!ctx->vaoRing) {
+        vkDestroyCommandPool(dev->vkDev, ctx->cmdPool, NULL);
+        free(ctx->points);
+        free(ctx->pathes);
+        free(ctx->vertexCache);
+        free(ctx->indexCache);
+        free(ctx);
+        LOG(VKVG_LOG_ERR, "CREATE context failed, no memory\n");
+        return (VkvgContext)&_vkvg_status_no_memory;
+    }
+#ifdef VKVG_VAO_ZERO_COPY
+    ctx->hostVertexCache  = ctx->vertexCache;
+    ctx->hostIndexCache   = ctx->indexCache;
+    ctx->sizeHostVertices = ctx->sizeVertices;
+    ctx->sizeHostIndices  = ctx->sizeIndices;
+    _map_vao_segment(ctx);
 #endif
-
-    _create_vertices_buff(ctx);
     _create_gradient_buff(ctx);
-    _create_cmd_buff(ctx);
     _createDescriptorPool(ctx);
     _init_descriptor_sets(ctx);
     _font_cache_update_context_descset(ctx);
-    _update_descriptor_set(ctx, surf->dev->emptyImg, ctx->dsSrc);
+    _update_descriptor_set(ctx, dev->emptyImg, ctx->dsSrc);
     _update_gradient_desc_set(ctx);
+    ctx->dsSrcCur = ctx->dsSrc;
 
     _clear_path(ctx);
-
-    ctx->cmd = ctx->cmdBuffers[0]; // current recording buffer
-
-    ctx->references = 1;
-    ctx->status     = VKVG_STATUS_SUCCESS;
+    // status is already no memory if the device arena could not provide the context buffers.
 
     LOG(VKVG_LOG_DBG_ARRAYS, "INIT\tctx = %p; pathes:%ju pts:%ju vch:%d vbo:%d ich:%d ibo:%d\n", ctx,
         (uint64_t)ctx->sizePathes, (uint64_t)ctx->sizePoints, ctx->sizeVertices, ctx->sizeVBO, ctx->sizeIndices,
@@ -160,28 +163,79 @@ VkvgContext vkvg_create(VkvgSurface surf) {
 
 #if defined(DEBUG) && defined(VKVG_DBG_UTILS)
     vkh_device_set_object_name(vkhd, VK_OBJECT_TYPE_COMMAND_POOL, (uint64_t)ctx->cmdPool, "CTX Cmd Pool");
-    vkh_device_set_object_name(vkhd, VK_OBJECT_TYPE_COMMAND_BUFFER, (uint64_t)ctx->cmdBuffers[0], "CTX Cmd Buff A");
-    vkh_device_set_object_name(vkhd, VK_OBJECT_TYPE_COMMAND_BUFFER, (uint64_t)ctx->cmdBuffers[1], "CTX Cmd Buff B");
-#ifndef VKVG_ENABLE_VK_TIMELINE_SEMAPHORE
-    vkh_device_set_object_name(vkhd, VK_OBJECT_TYPE_FENCE, (uint64_t)ctx->flushFence, "CTX Flush Fence");
-#endif
     vkh_device_set_object_name(vkhd, VK_OBJECT_TYPE_DESCRIPTOR_POOL, (uint64_t)ctx->descriptorPool,
                                "CTX Descriptor Pool");
     vkh_device_set_object_name(vkhd, VK_OBJECT_TYPE_DESCRIPTOR_SET, (uint64_t)ctx->dsSrc, "CTX DescSet SOURCE");
     vkh_device_set_object_name(vkhd, VK_OBJECT_TYPE_DESCRIPTOR_SET, (uint64_t)ctx->dsFont, "CTX DescSet FONT");
     vkh_device_set_object_name(vkhd, VK_OBJECT_TYPE_DESCRIPTOR_SET, (uint64_t)ctx->dsGrad, "CTX DescSet GRADIENT");
-
-    vkh_device_set_object_name(vkhd, VK_OBJECT_TYPE_BUFFER, (uint64_t)ctx->indices.buffer, "CTX Index Buff");
-    vkh_device_set_object_name(vkhd, VK_OBJECT_TYPE_BUFFER, (uint64_t)ctx->vertices.buffer, "CTX Vertex Buff");
 #endif
 
     return ctx;
 }
+// secondary contexts record into secondary command buffers executed by a parent context, they are never cached.
+VkvgContext _create_context(VkvgSurface surf, bool secondary, uint32_t sizeHint) {
+    LOG(VKVG_LOG_INFO, "CREATE Context\n");
+    if (vkvg_surface_status(surf)) {
+        LOG(VKVG_LOG_ERR, "CREATE Context failed, invalid surface\n");
+        return (VkvgContext)&_vkvg_status_invalid_surface;
+    }
+    VkvgDevice  dev = surf->dev;
+    if (vkvg_device_status(dev)) {
+        LOG(VKVG_LOG_ERR, "CREATE Context failed, invalid device\n");
+        return (VkvgContext)&_vkvg_status_device_error;
+    }
+    VkvgContext ctx = NULL;
+
+    if (!secondary && _device_try_get_cached_context(dev, sizeHint, &ctx)) {
+        ctx->pSurf = surf;
+        ctx->status = VKVG_STATUS_SUCCESS;
+        _init_ctx(ctx);
+        _update_descriptor_set(ctx, surf->dev->emptyImg, ctx->dsSrc);
+        ctx->dsSrcCur    = ctx->dsSrc;
+        ctx->srcFallback = false;
+        _clear_path(ctx);
+        return ctx;
+    }
+    ctx = _alloc_context(dev, secondary, sizeHint);
+    if (ctx->status)
+        return ctx;
+
+    LOG(VKVG_LOG_INFO, "CREATE Context: ctx = %p; surf = %p\n", ctx, surf);
+    ctx->pSurf      = surf;
+    ctx->references = 1;
+
+    _init_ctx(ctx);
+    if (secondary) // attachments are loaded and cleared by the render pass of the parent.
+        ctx->renderPassBeginInfo.renderPass = dev->renderPass;
+
+    return ctx;
+}
+VkvgContext vkvg_create(VkvgSurface surf) { return _create_context(surf, false, 0); }
+VkvgContext vkvg_create_with_hint(VkvgSurface surf, uint32_t vertexCount) {
+    return _create_context(surf, false, vertexCount);
+}
+VkvgContext vkvg_create_sub_context(VkvgContext ctx) {
+    if (vkvg_status(ctx) || ctx->secondary) {
+        LOG(VKVG_LOG_ERR, "CREATE sub context failed, invalid parent context\n");
+        return (VkvgContext)&_vkvg_status_invalid_status;
+    }
+    return _create_context(ctx->pSurf, true, 0);
+}
+void vkvg_execute_sub_context(VkvgContext ctx, VkvgContext sub) {
+    if (vkvg_status(ctx) || vkvg_status(sub))
+        return;
+    if (ctx->secondary || !sub->secondary || sub->pSurf != ctx->pSurf) {
+        LOG(VKVG_LOG_ERR, "EXECUTE sub context failed, sub = %p is not a sub context of ctx = %p\n", sub, ctx);
+        return;
+    }
+    _execute_sub_context(ctx, sub);
+}
 void vkvg_flush(VkvgContext ctx) {
     if (vkvg_status(ctx))
         return;
     _flush_cmd_buff(ctx);
-    _wait_ctx_flush_end(ctx);
+    if (!ctx->secondary) // sub contexts commands are only handed over to the parent.
+        _wait_ctx_flush_end(ctx);
     /*
     #ifdef DEBUG
 
@@ -206,6 +260,32 @@ void vkvg_flush(VkvgContext ctx) {
     */
 }
 
+uint64_t vkvg_flush_async(VkvgContext ctx) {
+    if (vkvg_status(ctx))
+        return 0;
+    _flush_cmd_buff(ctx);
+    return _get_flush_ticket(ctx);
+}
+vkvg_status_t vkvg_wait(VkvgContext ctx, uint64_t ticket, uint64_t timeout) {
+    if (vkvg_status(ctx))
+        return vkvg_status(ctx);
+    if (ticket > _get_flush_ticket(ctx))
+        return VKVG_STATUS_INVALID_INDEX;
+    VkResult res = _wait_flush_ticket(ctx, ticket, timeout);
+    if (res == VK_SUCCESS)
+        return VKVG_STATUS_SUCCESS;
+    if (res == VK_TIMEOUT)
+        return VKVG_STATUS_TIMEOUT;
+    LOG(VKVG_LOG_ERR, "CTX: vkvg_wait failed (%d)\n", res);
+    ctx->status = VKVG_STATUS_DEVICE_ERROR;
+    return ctx->status;
+}
+bool vkvg_is_complete(VkvgContext ctx, uint64_t ticket) {
+    if (vkvg_status(ctx) || ticket > _get_flush_ticket(ctx))
+        return false;
+    return _wait_flush_ticket(ctx, ticket, 0) == VK_SUCCESS;
+}
+
 void _clear_context(VkvgContext ctx) {
     // free saved context stack elmt
     vkvg_context_save_t *next = ctx->pSavedCtxs;
@@ -217,7 +297,7 @@ void _clear_context(VkvgContext ctx) {
     }
     // free additional stencil use in save/restore process
     if (ctx->savedStencils) {
-        uint8_t curSaveStencil = ctx->curSavBit / 6;
+        uint8_t curSaveStencil = ctx->curSavBit / STENCIL_SAVE_BIT_COUNT;
         for (int i = curSaveStencil; i > 0; i--)
             vkh_image_destroy(ctx->savedStencils[i - 1]);
         free(ctx->savedStencils);
@@ -263,8 +343,12 @@ void vkvg_destroy(VkvgContext ctx) {
         _destroy_recording(ctx->recording);
 #endif
 
+    if (ctx->secondary)
+        _wait_sub_ctx_executed(ctx);
+
     if (ctx->pattern)
         vkvg_pattern_destroy(ctx->pattern);
+    _reset_source_cache(ctx);
 
     _clear_context(ctx);
 
@@ -285,17 +369,26 @@ void vkvg_destroy(VkvgContext ctx) {
         dbgstats->sizeVBO = ctx->sizeVBO;
     if (dbgstats->sizeIBO < ctx->sizeIBO)
         dbgstats->sizeIBO = ctx->sizeIBO;
+    dbgstats->curvePoints += ctx->curvePoints;
+    ctx->curvePoints = 0;
 
     if (ctx->dev->threadAware)
         mtx_unlock(&ctx->dev->mutex);
 #endif
 
+    _release_scratch_stencil(ctx);
+    // transitions recorded in a cmd never submitted must not be awaited by the other contexts of the surface.
+    LOCK_SURFACE(ctx->pSurf)
+    _release_pending_transition(ctx);
+    UNLOCK_SURFACE(ctx->pSurf)
     vkvg_surface_destroy(ctx->pSurf);
 
-    if (!ctx->status && ctx->dev->cachedContextCount < VKVG_MAX_CACHED_CONTEXT_COUNT) {
-        _device_store_context(ctx);
-        ctx->status = VKVG_STATUS_IN_CACHE;
-        return;
+    if (!ctx->status && !ctx->secondary) {
+        _shrink_host_arrays(ctx); // before storing, cached contexts may be released by other threads.
+        if (_device_store_context(ctx)) {
+            ctx->status = VKVG_STATUS_IN_CACHE;
+            return;
+        }
     }
 
     _release_context_ressources(ctx);
@@ -309,9 +402,9 @@ void vkvg_set_opacity(VkvgContext ctx, float opacity) {
     if (EQUF(ctx->pushConsts.opacity, opacity))
         return;
 
-    _emit_draw_cmd_undrawn_vertices(ctx);
+    // opacity is applied to the next vertices, draw call goes on.
     ctx->pushConsts.opacity = opacity;
-    ctx->pushCstDirty       = true;
+    _update_vertex_color(ctx);
 }
 float vkvg_get_opacity(VkvgContext ctx) {
     if (vkvg_status(ctx))
@@ -412,14 +505,9 @@ void vkvg_arc(VkvgContext ctx, float xc, float yc, float radius, float a1, float
     if (_current_path_is_empty(ctx)) {
         _set_curve_start(ctx);
         _add_point(ctx, v.x, v.y);
-        if (!ctx->pathPtr)
-            ctx->simpleConvex = true;
-        else
-            ctx->simpleConvex = false;
     } else {
         _line_to(ctx, v.x, v.y);
         _set_curve_start(ctx);
-        ctx->simpleConvex = false;
     }
 
     a += step;
@@ -465,14 +553,9 @@ void vkvg_arc_negative(VkvgContext ctx, float xc, float yc, float radius, float
     if (_current_path_is_empty(ctx)) {
         _set_curve_start(ctx);
         _add_point(ctx, v.x, v.y);
-        if (!ctx->pathPtr)
-            ctx->simpleConvex = true;
-        else
-            ctx->simpleConvex = false;
     } else {
         _line_to(ctx, v.x, v.y);
         _set_curve_start(ctx);
-        ctx->simpleConvex = false;
     }
 
     a -= step;
@@ -545,24 +628,31 @@ void _curve_to(VkvgContext ctx, float x1, float y1, float x2, float y2, float x3
             (EQUF(_get_current_position(ctx).x, x1) && EQUF(_get_current_position(ctx).y, y1)))
             return;
     }
-    ctx->simpleConvex = false;
     _set_curve_start(ctx);
     if (_current_path_is_empty(ctx))
         _add_point(ctx, x1, y1);
 
     vec2 cp = _get_current_position(ctx);
 
-    // compute dyn distanceTolerance depending on current scale
-    float sx = 1, sy = 1;
-    vkvg_matrix_get_scale(&ctx->pushConsts.mat, &sx, &sy);
-    float distanceTolerance = fabs(0.25f / fmaxf(sx, sy));
-
-    _recursive_bezier(ctx, distanceTolerance, cp.x, cp.y, x1, y1, x2, y2, x3, y3, 0);
+#if VKVG_DBG_STATS
+    uint32_t firstPoint = ctx->pointCount;
+#endif
+    // tolerance in user space depending on current scale
+    float tolerance = ctx->tolerance / _get_matrix_scale(ctx);
+#ifdef VKVG_RECURSIVE_BEZIER
+    // squared distance, control points distances to the chord are summed.
+    _recursive_bezier(ctx, 4.f * tolerance * tolerance, cp.x, cp.y, x1, y1, x2, y2, x3, y3, 0);
+#else
+    _flatten_bezier(ctx, tolerance, cp.x, cp.y, x1, y1, x2, y2, x3, y3);
+#endif
     /*cp.x = x3;
     cp.y = y3;
     if (!vec2_equ(ctx->points[ctx->pointCount-1],cp))*/
     _add_point(ctx, x3, y3);
     _set_curve_end(ctx);
+#if VKVG_DBG_STATS
+    ctx->curvePoints += ctx->pointCount - firstPoint;
+#endif
 }
 const double quadraticFact = 2.0 / 3.0;
 void _quadratic_to(VkvgContext ctx, float x1, float y1, float x2, float y2) {
@@ -613,7 +703,14 @@ void vkvg_fill_rectangle(VkvgContext ctx, float x, float y, float w, float h) {
     if (vkvg_status(ctx))
         return;
     LOG(VKVG_LOG_INFO_CMD, "\tCMD: fill_rectangle:\n");
+#ifdef VKVG_VAO_ZERO_COPY
+    _ensure_vao_mapped(ctx);
+#endif
     _vao_add_rectangle(ctx, x, y, w, h);
+    if (ctx->dev->analyticAA) {
+        vec2 ring[] = {{x, y}, {x, y + h}, {x + w, y + h}, {x + w, y}};
+        _add_edge_fringe(ctx, ring, 4, false);
+    }
     //_record_draw_cmd(ctx);
 }
 
@@ -705,7 +802,7 @@ static const VkClearAttachment clearColorAttach = {VK_IMAGE_ASPECT_COLOR_BIT, 0,
 
 void _reset_clip(VkvgContext ctx) {
     _emit_draw_cmd_undrawn_vertices(ctx);
-    if (!ctx->cmdStarted) {
+    if (!ctx->cmdStarted && !ctx->secondary) {
         // if command buffer is not already started and in a renderpass, we use the renderpass
         // with the loadop clear for stencil
         ctx->renderPassBeginInfo.renderPass = ctx->dev->renderPass_ClearStencil;
@@ -713,6 +810,7 @@ void _reset_clip(VkvgContext ctx) {
         _start_cmd_for_render_pass(ctx);
         return;
     }
+    _ensure_renderpass_is_started(ctx); // sub contexts clear with commands instead of load ops
     vkCmdClearAttachments(ctx->cmd, 1, &clearStencil, 1, &ctx->clearRect);
 }
 
@@ -743,11 +841,12 @@ void vkvg_clear(VkvgContext ctx) {
         ctx->curClipState = vkvg_clip_state_clear;
 
     _emit_draw_cmd_undrawn_vertices(ctx);
-    if (!ctx->cmdStarted) {
+    if (!ctx->cmdStarted && !ctx->secondary) {
         ctx->renderPassBeginInfo.renderPass = ctx->dev->renderPass_ClearAll;
         _start_cmd_for_render_pass(ctx);
         return;
     }
+    _ensure_renderpass_is_started(ctx); // sub contexts clear with commands instead of load ops
     VkClearAttachment ca[2] = {clearColorAttach, clearStencil};
     vkCmdClearAttachments(ctx->cmd, 2, ca, 1, &ctx->clearRect);
 }
@@ -767,7 +866,7 @@ void _clip_preserve(VkvgContext ctx) {
     vkh_cmd_label_start(ctx->cmd, "clip", DBG_LAB_COLOR_CLIP);
 #endif
 
-    if (ctx->curFillRule == VKVG_FILL_RULE_EVEN_ODD) {
+    if (ctx->curFillRule == VKVG_FILL_RULE_EVEN_ODD || _fill_with_stencil(ctx)) {
         _poly_fill(ctx, NULL);
         CmdBindPipeline(ctx->cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, ctx->dev->pipelineClipping);
     } else {
@@ -800,24 +899,38 @@ void _fill_preserve(VkvgContext ctx) {
         return;
 
     LOG(VKVG_LOG_INFO, "FILL: ctx = %p; path cpt = %d;\n", ctx, ctx->subpathCount);
+#ifdef VKVG_VAO_ZERO_COPY
+    _ensure_vao_mapped(ctx);
+#endif
 
-    if (ctx->curFillRule == VKVG_FILL_RULE_EVEN_ODD) {
+    bool stencilFringes = _fill_fringes_on_stencil(ctx);
+    if (stencilFringes || _fill_with_stencil(ctx)) {
         _emit_draw_cmd_undrawn_vertices(ctx);
         vec4 bounds = {FLT_MAX, FLT_MAX, FLT_MIN, FLT_MIN};
         _poly_fill(ctx, &bounds);
+        if (stencilFringes)
+            _add_stencil_fringes(ctx);
         _bind_draw_pipeline(ctx);
         CmdSetStencilCompareMask(ctx->cmd, VK_STENCIL_FRONT_AND_BACK, STENCIL_FILL_BIT);
         _draw_full_screen_quad(ctx, &bounds);
         CmdSetStencilCompareMask(ctx->cmd, VK_STENCIL_FRONT_AND_BACK, STENCIL_CLIP_BIT);
-        return;
+    } else {
+        if (ctx->vertCount - ctx->curVertOffset + ctx->pointCount > VKVG_IBO_MAX)
+            _emit_draw_cmd_undrawn_vertices(ctx); // limit draw call to addressable vx with choosen index type
+
+        if (ctx->pattern) // if not solid color, source img or gradient has to be bound
+            _ensure_renderpass_is_started(ctx);
+#ifdef VKVG_FILL_NZ_SWEEP
+        // even-odd fills are tesselated too, no stencil pass is needed.
+        if (ctx->curFillRule == VKVG_FILL_RULE_EVEN_ODD)
+            _tess_fill(ctx, VKVG_FILL_RULE_EVEN_ODD);
+        else
+#endif
+            _fill_non_zero(ctx);
     }
-
-    if (ctx->vertCount - ctx->curVertOffset + ctx->pointCount > VKVG_IBO_MAX)
-        _emit_draw_cmd_undrawn_vertices(ctx); // limit draw call to addressable vx with choosen index type
-
-    if (ctx->pattern) // if not solid color, source img or gradient has to be bound
-        _ensure_renderpass_is_started(ctx);
-    _fill_non_zero(ctx);
+    // drawn after the fill with the current pipeline, unless already drawn from the stencil.
+    if (ctx->dev->analyticAA && !stencilFringes)
+        _add_fill_fringes(ctx);
 }
 void _stroke_preserve(VkvgContext ctx) {
     _finish_path(ctx);
@@ -826,6 +939,9 @@ void _stroke_preserve(VkvgContext ctx) {
         return;
 
     LOG(VKVG_LOG_INFO, "STROKE: ctx = %p; path ptr = %d;\n", ctx, ctx->pathPtr);
+#ifdef VKVG_VAO_ZERO_COPY
+    _ensure_vao_mapped(ctx);
+#endif
 
     stroke_context_t str = {0};
     str.hw               = ctx->lineWidth * 0.5f;
@@ -845,7 +961,8 @@ void _stroke_preserve(VkvgContext ctx) {
             lastSegmentPointIdx = str.cp + (ctx->pathes[ptrPath + ptrSegment] & PATH_ELT_MASK) - 1;
         }
 
-        str.firstIdx = (VKVG_IBO_INDEX_TYPE)(ctx->vertCount - ctx->curVertOffset);
+        str.firstIdx     = (VKVG_IBO_INDEX_TYPE)(ctx->vertCount - ctx->curVertOffset);
+        str.outlineCount = 0;
 
         // LOG(VKVG_LOG_INFO_PATH, "\tPATH: points count=%10d end point idx=%10d", ctx->pathes[ptrPath]&PATH_ELT_MASK,
         // lastPathPointIdx);
@@ -930,6 +1047,7 @@ void _stroke_preserve(VkvgContext ctx) {
                 inds[5] = ii + 1;
             }
             str.cp++;
+            _add_stroke_fringe(ctx, &str, true);
         } else
             _draw_stoke_cap(ctx, &str, ctx->points[str.cp],
                             vec2_line_norm(ctx->points[str.cp - 1], ctx->points[str.cp]), false);
@@ -1050,6 +1168,12 @@ void vkvg_set_miter_limit(VkvgContext ctx, float limit) {
     RECORD(ctx, VKVG_CMD_SET_LINE_WIDTH, limit);
     ctx->miterLimit = limit;
 }
+void vkvg_set_tolerance(VkvgContext ctx, float tolerance) {
+    if (vkvg_status(ctx))
+        return;
+    RECORD(ctx, VKVG_CMD_SET_TOLERANCE, tolerance);
+    ctx->tolerance = fmaxf(tolerance, VKVG_MIN_TOLERANCE);
+}
 void vkvg_set_line_cap(VkvgContext ctx, vkvg_line_cap_t cap) {
     if (vkvg_status(ctx))
         return;
@@ -1069,14 +1193,31 @@ void vkvg_set_operator(VkvgContext ctx, vkvg_operator_t op) {
     if (op == ctx->curOperator)
         return;
 
-    _emit_draw_cmd_undrawn_vertices(
-        ctx); // draw call with different ops cant be combined, so emit draw cmd for previous vertices.
+    // draw call with different ops cant be combined, so emit draw cmd for previous vertices, unless they may
+    // be reordered, in which case pending indices are grouped by operator on emission.
+    if (ctx->reorderDraws && _add_operator_range(ctx)) {
+        ctx->curOperator = op;
+        return;
+    }
+    _emit_draw_cmd_undrawn_vertices(ctx);
 
     ctx->curOperator = op;
 
     if (ctx->cmdStarted)
         _bind_draw_pipeline(ctx);
 }
+void vkvg_set_draw_reordering(VkvgContext ctx, bool enable) {
+    if (vkvg_status(ctx) || ctx->reorderDraws == enable)
+        return;
+    LOG(VKVG_LOG_INFO_CMD, "CMD: set_draw_reordering: %d\n", enable);
+    _emit_draw_cmd_undrawn_vertices(ctx);
+    ctx->reorderDraws = enable;
+}
+bool vkvg_get_draw_reordering(VkvgContext ctx) {
+    if (vkvg_status(ctx))
+        return false;
+    return ctx->reorderDraws;
+}
 void vkvg_set_fill_rule(VkvgContext ctx, vkvg_fill_rule_t fr) {
     if (vkvg_status(ctx))
         return;
@@ -1100,6 +1241,11 @@ float vkvg_get_miter_limit(VkvgContext ctx) {
         return 0;
     return ctx->miterLimit;
 }
+float vkvg_get_tolerance(VkvgContext ctx) {
+    if (vkvg_status(ctx))
+        return 0;
+    return ctx->tolerance;
+}
 void vkvg_set_dash(VkvgContext ctx, const float *dashes, uint32_t num_dashes, float offset) {
     if (vkvg_status(ctx))
         return;
@@ -1258,7 +1404,7 @@ void vkvg_save(VkvgContext ctx) {
     vkvg_context_save_t *sav = (vkvg_context_save_t *)calloc(1, sizeof(vkvg_context_save_t));
 
     _flush_cmd_buff(ctx);
-    if (!_wait_ctx_flush_end(ctx)) {
+    if (!ctx->secondary && !_wait_ctx_flush_end(ctx)) { // sub context commands are ordered by the parent.
         free(sav);
         return;
     }
@@ -1266,9 +1412,17 @@ void vkvg_save(VkvgContext ctx) {
     if (ctx->curClipState == vkvg_clip_state_clip) {
         sav->clippingState = vkvg_clip_state_clip_saved;
 
-        uint8_t curSaveStencil = ctx->curSavBit / 6;
+        uint8_t curSaveStencil = ctx->curSavBit / STENCIL_SAVE_BIT_COUNT;
 
-        if (ctx->curSavBit > 0 && ctx->curSavBit % 6 == 0) { // new save/restore stencil image have to be created
+        if (ctx->curSavBit > 0 &&
+            ctx->curSavBit % STENCIL_SAVE_BIT_COUNT == 0) { // new save/restore stencil image have to be created
+            if (ctx->secondary) {
+                LOG(VKVG_LOG_ERR, "CTX: sub context %p cannot save more than %d clipping states\n", ctx,
+                    STENCIL_SAVE_BIT_COUNT);
+                free(sav);
+                ctx->status = VKVG_STATUS_INVALID_STATUS;
+                return;
+            }
             VkhImage *savedStencilsPtr = NULL;
             if (savedStencilsPtr)
                 savedStencilsPtr = (VkhImage *)realloc(ctx->savedStencils, curSaveStencil * sizeof(VkhImage));
@@ -1292,7 +1446,7 @@ void vkvg_save(VkvgContext ctx) {
             vkh_cmd_label_start(ctx->cmd, "new save/restore stencil", DBG_LAB_COLOR_SAV);
 #endif
 
-            vkh_image_set_layout(ctx->cmd, ctx->pSurf->stencil, dev->stencilAspectFlag,
+            vkh_image_set_layout(ctx->cmd, ctx->stencil, dev->stencilAspectFlag,
                                  VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
                                  VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
             vkh_image_set_layout(ctx->cmd, savStencil, dev->stencilAspectFlag, VK_IMAGE_LAYOUT_GENERAL,
@@ -1302,10 +1456,10 @@ void vkvg_save(VkvgContext ctx) {
             VkImageCopy cregion = {.srcSubresource = {VK_IMAGE_ASPECT_STENCIL_BIT, 0, 0, 1},
                                    .dstSubresource = {VK_IMAGE_ASPECT_STENCIL_BIT, 0, 0, 1},
                                    .extent         = {ctx->pSurf->width, ctx->pSurf->height, 1}};
-            vkCmdCopyImage(ctx->cmd, vkh_image_get_vkimage(ctx->pSurf->stencil), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+            vkCmdCopyImage(ctx->cmd, vkh_image_get_vkimage(ctx->stencil), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
                            vkh_image_get_vkimage(savStencil), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &cregion);
 
-            vkh_image_set_layout(ctx->cmd, ctx->pSurf->stencil, dev->stencilAspectFlag,
+            vkh_image_set_layout(ctx->cmd, ctx->stencil, dev->stencilAspectFlag,
                                  VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
                                  VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT);
 
@@ -1317,7 +1471,7 @@ void vkvg_save(VkvgContext ctx) {
             _wait_and_submit_cmd(ctx);
         }
 
-        uint8_t curSaveBit = 1 << (ctx->curSavBit % 6 + 2);
+        uint8_t curSaveBit = 1 << (ctx->curSavBit % STENCIL_SAVE_BIT_COUNT + STENCIL_SAVE_BIT_SHIFT);
 
         _start_cmd_for_render_pass(ctx);
 
@@ -1353,6 +1507,7 @@ void vkvg_save(VkvgContext ctx) {
     }
     sav->lineWidth   = ctx->lineWidth;
     sav->miterLimit  = ctx->miterLimit;
+    sav->tolerance   = ctx->tolerance;
     sav->curOperator = ctx->curOperator;
     sav->lineCap     = ctx->lineCap;
     sav->lineWidth   = ctx->lineWidth;
@@ -1390,18 +1545,19 @@ void vkvg_restore(VkvgContext ctx) {
     ctx->pSavedCtxs          = sav->pNext;
 
     _flush_cmd_buff(ctx);
-    if (!_wait_ctx_flush_end(ctx))
+    if (!ctx->secondary && !_wait_ctx_flush_end(ctx)) // sub context commands are ordered by the parent.
         return;
 
     ctx->pushConsts   = sav->pushConsts;
     ctx->pushCstDirty = true;
+    ctx->matScale     = 0;
 
     if (ctx->curClipState) { //!=none
         if (ctx->curClipState == vkvg_clip_state_clip && sav->clippingState == vkvg_clip_state_clear) {
             _reset_clip(ctx);
         } else {
 
-            uint8_t curSaveBit = 1 << ((ctx->curSavBit - 1) % 6 + 2);
+            uint8_t curSaveBit = 1 << ((ctx->curSavBit - 1) % STENCIL_SAVE_BIT_COUNT + STENCIL_SAVE_BIT_SHIFT);
 
             _start_cmd_for_render_pass(ctx);
 
@@ -1432,9 +1588,9 @@ void vkvg_restore(VkvgContext ctx) {
     if (sav->clippingState == vkvg_clip_state_clip_saved) {
         ctx->curSavBit--;
 
-        uint8_t curSaveStencil = ctx->curSavBit / 6;
+        uint8_t curSaveStencil = ctx->curSavBit / STENCIL_SAVE_BIT_COUNT;
         if (ctx->curSavBit > 0 &&
-            ctx->curSavBit % 6 ==
+            ctx->curSavBit % STENCIL_SAVE_BIT_COUNT ==
                 0) { // addtional save/restore stencil image have to be copied back to surf stencil first
             VkhImage savStencil = ctx->savedStencils[curSaveStencil - 1];
 
@@ -1445,7 +1601,7 @@ void vkvg_restore(VkvgContext ctx) {
             vkh_cmd_label_start(ctx->cmd, "additional stencil copy while restoring", DBG_LAB_COLOR_SAV);
 #endif
 
-            vkh_image_set_layout(ctx->cmd, ctx->pSurf->stencil, ctx->dev->stencilAspectFlag,
+            vkh_image_set_layout(ctx->cmd, ctx->stencil, ctx->dev->stencilAspectFlag,
                                  VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
                                  VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
             vkh_image_set_layout(ctx->cmd, savStencil, ctx->dev->stencilAspectFlag,
@@ -1456,9 +1612,9 @@ void vkvg_restore(VkvgContext ctx) {
                                    .dstSubresource = {VK_IMAGE_ASPECT_STENCIL_BIT, 0, 0, 1},
                                    .extent         = {ctx->pSurf->width, ctx->pSurf->height, 1}};
             vkCmdCopyImage(ctx->cmd, vkh_image_get_vkimage(savStencil), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
-                           vkh_image_get_vkimage(ctx->pSurf->stencil), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1,
+                           vkh_image_get_vkimage(ctx->stencil), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1,
                            &cregion);
-            vkh_image_set_layout(ctx->cmd, ctx->pSurf->stencil, ctx->dev->stencilAspectFlag,
+            vkh_image_set_layout(ctx->cmd, ctx->stencil, ctx->dev->stencilAspectFlag,
                                  VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
                                  VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT);
 
@@ -1487,6 +1643,7 @@ void vkvg_restore(VkvgContext ctx) {
 
     ctx->lineWidth   = sav->lineWidth;
     ctx->miterLimit  = sav->miterLimit;
+    ctx->tolerance   = sav->tolerance;
     ctx->curOperator = sav->curOperator;
     ctx->lineCap     = sav->lineCap;
     ctx->lineJoin    = sav->lineJoint;
@@ -1507,6 +1664,7 @@ void vkvg_restore(VkvgContext ctx) {
         ctx->curColor = sav->curColor;
         _update_cur_pattern(ctx, NULL);
     }
+    _update_vertex_color(ctx); // restored opacity
 
     _free_ctx_save(sav);
 }
@@ -1516,7 +1674,7 @@ void vkvg_translate(VkvgContext ctx, float dx, float dy) {
         return;
     RECORD(ctx, VKVG_CMD_TRANSLATE, dx, dy);
     LOG(VKVG_LOG_INFO_CMD, "CMD: translate: %f, %f\n", dx, dy);
-    _emit_draw_cmd_undrawn_vertices(ctx);
+    _prepare_matrix_change(ctx);
     vkvg_matrix_translate(&ctx->pushConsts.mat, dx, dy);
     _set_mat_inv_and_vkCmdPush(ctx);
 }
@@ -1525,7 +1683,7 @@ void vkvg_scale(VkvgContext ctx, float sx, float sy) {
         return;
     RECORD(ctx, VKVG_CMD_SCALE, sx, sy);
     LOG(VKVG_LOG_INFO_CMD, "CMD: scale: %f, %f\n", sx, sy);
-    _emit_draw_cmd_undrawn_vertices(ctx);
+    _prepare_matrix_change(ctx);
     vkvg_matrix_scale(&ctx->pushConsts.mat, sx, sy);
     _set_mat_inv_and_vkCmdPush(ctx);
 }
@@ -1534,7 +1692,7 @@ void vkvg_rotate(VkvgContext ctx, float radians) {
         return;
     RECORD(ctx, VKVG_CMD_ROTATE, radians);
     LOG(VKVG_LOG_INFO_CMD, "CMD: rotate: %f\n", radians);
-    _emit_draw_cmd_undrawn_vertices(ctx);
+    _prepare_matrix_change(ctx);
     vkvg_matrix_rotate(&ctx->pushConsts.mat, radians);
     _set_mat_inv_and_vkCmdPush(ctx);
 }
@@ -1544,7 +1702,7 @@ void vkvg_transform(VkvgContext ctx, const vkvg_matrix_t *matrix) {
     RECORD(ctx, VKVG_CMD_TRANSFORM, matrix);
     LOG(VKVG_LOG_INFO_CMD, "CMD: transform: %f, %f, %f, %f, %f, %f\n", matrix->xx, matrix->yx, matrix->xy, matrix->yy,
         matrix->x0, matrix->y0);
-    _emit_draw_cmd_undrawn_vertices(ctx);
+    _prepare_matrix_change(ctx);
     vkvg_matrix_t res;
     vkvg_matrix_multiply(&res, &ctx->pushConsts.mat, matrix);
     ctx->pushConsts.mat = res;
@@ -1555,7 +1713,7 @@ void vkvg_identity_matrix(VkvgContext ctx) {
         return;
     RECORD(ctx, VKVG_CMD_IDENTITY_MATRIX);
     LOG(VKVG_LOG_INFO_CMD, "CMD: identity_matrix:\n");
-    _emit_draw_cmd_undrawn_vertices(ctx);
+    _prepare_matrix_change(ctx);
     vkvg_matrix_t im    = VKVG_IDENTITY_MATRIX;
     ctx->pushConsts.mat = im;
     _set_mat_inv_and_vkCmdPush(ctx);
@@ -1566,7 +1724,7 @@ void vkvg_set_matrix(VkvgContext ctx, const vkvg_matrix_t *matrix) {
     RECORD(ctx, VKVG_CMD_SET_MATRIX, matrix);
     LOG(VKVG_LOG_INFO_CMD, "CMD: set_matrix: %f, %f, %f, %f, %f, %f\n", matrix->xx, matrix->yx, matrix->xy, matrix->yy,
         matrix->x0, matrix->y0);
-    _emit_draw_cmd_undrawn_vertices(ctx);
+    _prepare_matrix_change(ctx);
     ctx->pushConsts.mat = (*matrix);
     _set_mat_inv_and_vkCmdPush(ctx);
 }
@@ -1575,6 +1733,21 @@ void vkvg_get_matrix(VkvgContext ctx, vkvg_matrix_t *const matrix) {
         return;
     *matrix = ctx->pushConsts.mat;
 }
+void vkvg_set_transform_batching(VkvgContext ctx, bool enable) {
+    if (vkvg_status(ctx) || ctx->transformBatching == enable)
+        return;
+    LOG(VKVG_LOG_INFO_CMD, "CMD: set_transform_batching: %d\n", enable);
+    // vertices not yet drawn are in the space expected by the previous mode.
+    _emit_draw_cmd_undrawn_vertices(ctx);
+    ctx->xformVertBase     = ctx->vertCount;
+    ctx->transformBatching = enable;
+    ctx->pushCstDirty      = true;
+}
+bool vkvg_get_transform_batching(VkvgContext ctx) {
+    if (vkvg_status(ctx))
+        return false;
+    return ctx->transformBatching;
+}
 
 void vkvg_elliptic_arc_to(VkvgContext ctx, float x2, float y2, bool largeArc, bool sweepFlag, float rx, float ry,
                           float phi) {
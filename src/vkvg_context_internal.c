@@ -39,7 +39,69 @@
 #include "glutess.h"
 #endif
 
+// size of a growing array, at least minSize, geometric growth avoids quadratic realloc traffic on huge pathes.
+uint32_t _next_array_size(VkvgContext ctx, uint32_t size, uint32_t minSize, uint32_t granularity) {
+    uint64_t newSize = (uint64_t)((double)size * ctx->dev->arrayGrowthFactor);
+    if (newSize < minSize)
+        newSize = minSize;
+    newSize = (newSize + granularity - 1) / granularity * granularity;
+#if VKVG_DBG_STATS
+    ATOMIC_INC(ctx->dev->debug_stats.arrayGrowths);
+#endif
+    return (uint32_t)MIN(newSize, UINT32_MAX);
+}
+// shrink a host array to the high-water mark of its use, return the new array pointer.
+static void *_shrink_array(VkvgContext ctx, void *array, uint32_t *size, uint32_t hwm, uint32_t granularity,
+                           size_t eltSize) {
+    uint32_t target = MAX(granularity, (hwm + granularity - 1) / granularity * granularity);
+    if ((double)*size <= (double)target * ctx->dev->arrayGrowthFactor)
+        return array;
+    void *tmp = realloc(array, (size_t)target * eltSize);
+    if (tmp == NULL) // keep the bigger array
+        return array;
+    LOG(VKVG_LOG_DBG_ARRAYS, "shrink array: %u -> %u Ptr: %p -> %p\n", *size, target, array, tmp);
+    *size = target;
+#if VKVG_DBG_STATS
+    ATOMIC_INC(ctx->dev->debug_stats.arrayShrinks);
+#endif
+    return tmp;
+}
+// one huge drawing should not pin memory in a cached context, arrays grown beyond the use of the last context life
+// are shrunk.
+void _shrink_host_arrays(VkvgContext ctx) {
+    ctx->points = (vec2 *)_shrink_array(ctx, ctx->points, &ctx->sizePoints, ctx->hwmPoints, VKVG_PTS_SIZE,
+                                        sizeof(vec2));
+    ctx->pathes = (uint32_t *)_shrink_array(ctx, ctx->pathes, &ctx->sizePathes, ctx->hwmPathes, VKVG_PATHES_SIZE,
+                                            sizeof(uint32_t));
+#ifdef VKVG_VAO_ZERO_COPY
+    ctx->hostVertexCache = (Vertex *)_shrink_array(ctx, ctx->hostVertexCache, &ctx->sizeHostVertices,
+                                                   ctx->hwmVertices, VKVG_VBO_SIZE, sizeof(Vertex));
+    ctx->hostIndexCache  = (VKVG_IBO_INDEX_TYPE *)_shrink_array(ctx, ctx->hostIndexCache, &ctx->sizeHostIndices,
+                                                                ctx->hwmIndices, VKVG_IBO_SIZE,
+                                                                sizeof(VKVG_IBO_INDEX_TYPE));
+    if (!ctx->vaoMapped) {
+        ctx->vertexCache  = ctx->hostVertexCache;
+        ctx->indexCache   = ctx->hostIndexCache;
+        ctx->sizeVertices = ctx->sizeHostVertices;
+        ctx->sizeIndices  = ctx->sizeHostIndices;
+    }
+#else
+    ctx->vertexCache = (Vertex *)_shrink_array(ctx, ctx->vertexCache, &ctx->sizeVertices, ctx->hwmVertices,
+                                               VKVG_VBO_SIZE, sizeof(Vertex));
+    ctx->indexCache  = (VKVG_IBO_INDEX_TYPE *)_shrink_array(ctx, ctx->indexCache, &ctx->sizeIndices, ctx->hwmIndices,
+                                                            VKVG_IBO_SIZE, sizeof(VKVG_IBO_INDEX_TYPE));
+#endif
+    ctx->hwmPoints = ctx->hwmPathes = ctx->hwmVertices = ctx->hwmIndices = 0;
+    _tess_arena_release(ctx);
+}
 void _resize_vertex_cache(VkvgContext ctx, uint32_t newSize) {
+#ifdef VKVG_VAO_ZERO_COPY
+    if (ctx->vaoMapped) { // vbo is too small, fall back to host caches until next flush.
+        _unmap_vao_segment(ctx, 0, 0);
+        if (ctx->vaoMapped) // host caches could not be grown, the mapped pointer may not be reallocated.
+            return;
+    }
+#endif
     Vertex *tmp = (Vertex *)realloc(ctx->vertexCache, (size_t)newSize * sizeof(Vertex));
     LOG(VKVG_LOG_DBG_ARRAYS,
         "resize vertex cache (vx count=%u): old size: %u -> new size: %u size(byte): %zu Ptr: %p -> %p\n",
@@ -52,8 +114,19 @@ void _resize_vertex_cache(VkvgContext ctx, uint32_t newSize) {
     }
     ctx->vertexCache  = tmp;
     ctx->sizeVertices = newSize;
+#ifdef VKVG_VAO_ZERO_COPY
+    ctx->hostVertexCache  = tmp;
+    ctx->sizeHostVertices = newSize;
+#endif
 }
 void _resize_index_cache(VkvgContext ctx, uint32_t newSize) {
+#ifdef VKVG_VAO_ZERO_COPY
+    if (ctx->vaoMapped) { // ibo is too small, fall back to host caches until next flush.
+        _unmap_vao_segment(ctx, 0, 0);
+        if (ctx->vaoMapped) // host caches could not be grown, the mapped pointer may not be reallocated.
+            return;
+    }
+#endif
     VKVG_IBO_INDEX_TYPE *tmp =
         (VKVG_IBO_INDEX_TYPE *)realloc(ctx->indexCache, (size_t)newSize * sizeof(VKVG_IBO_INDEX_TYPE));
     LOG(VKVG_LOG_DBG_ARRAYS, "resize IBO: new size: %lu Ptr: %p -> %p\n", (size_t)newSize * sizeof(VKVG_IBO_INDEX_TYPE),
@@ -66,42 +139,40 @@ void _resize_index_cache(VkvgContext ctx, uint32_t newSize) {
     }
     ctx->indexCache  = tmp;
     ctx->sizeIndices = newSize;
+#ifdef VKVG_VAO_ZERO_COPY
+    ctx->hostIndexCache  = tmp;
+    ctx->sizeHostIndices = newSize;
+#endif
 }
 void _ensure_vertex_cache_size(VkvgContext ctx, uint32_t addedVerticesCount) {
     if (ctx->sizeVertices - ctx->vertCount > VKVG_ARRAY_THRESHOLD + addedVerticesCount)
         return;
-    uint32_t newSize = ctx->sizeVertices + addedVerticesCount;
-    uint32_t modulo  = addedVerticesCount % VKVG_VBO_SIZE;
-    if (modulo > 0)
-        newSize += VKVG_VBO_SIZE - modulo;
-    _resize_vertex_cache(ctx, newSize);
+    _resize_vertex_cache(ctx, _next_array_size(ctx, ctx->sizeVertices, ctx->sizeVertices + addedVerticesCount,
+                                               VKVG_VBO_SIZE));
 }
 void _check_vertex_cache_size(VkvgContext ctx) {
     assert(ctx->sizeVertices > ctx->vertCount);
     if (ctx->sizeVertices - VKVG_ARRAY_THRESHOLD > ctx->vertCount)
         return;
-    _resize_vertex_cache(ctx, ctx->sizeVertices + VKVG_VBO_SIZE);
+    _resize_vertex_cache(ctx, _next_array_size(ctx, ctx->sizeVertices, ctx->sizeVertices + 1, VKVG_VBO_SIZE));
 }
 void _ensure_index_cache_size(VkvgContext ctx, uint32_t addedIndicesCount) {
     assert(ctx->sizeIndices > ctx->indCount);
     if (ctx->sizeIndices - VKVG_ARRAY_THRESHOLD > ctx->indCount + addedIndicesCount)
         return;
-    uint32_t newSize = ctx->sizeIndices + addedIndicesCount;
-    uint32_t modulo  = addedIndicesCount % VKVG_IBO_SIZE;
-    if (modulo > 0)
-        newSize += VKVG_IBO_SIZE - modulo;
-    _resize_index_cache(ctx, newSize);
+    _resize_index_cache(ctx, _next_array_size(ctx, ctx->sizeIndices, ctx->sizeIndices + addedIndicesCount,
+                                              VKVG_IBO_SIZE));
 }
 void _check_index_cache_size(VkvgContext ctx) {
     if (ctx->sizeIndices - VKVG_ARRAY_THRESHOLD > ctx->indCount)
         return;
-    _resize_index_cache(ctx, ctx->sizeIndices + VKVG_IBO_SIZE);
+    _resize_index_cache(ctx, _next_array_size(ctx, ctx->sizeIndices, ctx->sizeIndices + 1, VKVG_IBO_SIZE));
 }
 // check host path array size, return true if error. pathPtr is already incremented
 bool _check_pathes_array(VkvgContext ctx) {
     if (ctx->sizePathes - ctx->pathPtr - ctx->segmentPtr > VKVG_ARRAY_THRESHOLD)
         return false;
-    ctx->sizePathes += VKVG_PATHES_SIZE;
+    ctx->sizePathes = _next_array_size(ctx, ctx->sizePathes, ctx->sizePathes + 1, VKVG_PATHES_SIZE);
     uint32_t *tmp = (uint32_t *)realloc(ctx->pathes, (size_t)ctx->sizePathes * sizeof(uint32_t));
     LOG(VKVG_LOG_DBG_ARRAYS, "resize PATH: new size: %u Ptr: %p -> %p\n", ctx->sizePathes, ctx->pathes, tmp);
     if (tmp == NULL) {
@@ -114,10 +185,13 @@ bool _check_pathes_array(VkvgContext ctx) {
     return false;
 }
 // check host point array size, return true if error
-bool _check_point_array(VkvgContext ctx) {
-    if (ctx->sizePoints - VKVG_ARRAY_THRESHOLD > ctx->pointCount)
+bool _check_point_array(VkvgContext ctx) { return _ensure_point_array(ctx, 0); }
+// reserve room for addedPoints more points in the host point array, return true if error
+bool _ensure_point_array(VkvgContext ctx, uint32_t addedPoints) {
+    if (ctx->sizePoints - VKVG_ARRAY_THRESHOLD > ctx->pointCount + addedPoints)
         return false;
-    ctx->sizePoints += VKVG_PTS_SIZE;
+    ctx->sizePoints = _next_array_size(ctx, ctx->sizePoints, ctx->pointCount + addedPoints + VKVG_ARRAY_THRESHOLD + 1,
+                                       VKVG_PTS_SIZE);
     vec2 *tmp = (vec2 *)realloc(ctx->points, (size_t)ctx->sizePoints * sizeof(vec2));
     LOG(VKVG_LOG_DBG_ARRAYS, "resize Points: new size(point): %u Ptr: %p -> %p\n", ctx->sizePoints, ctx->points, tmp);
     if (tmp == NULL) {
@@ -158,6 +232,52 @@ void _set_curve_end(VkvgContext ctx) {
     _check_pathes_array(ctx);
     ctx->pathes[ctx->pathPtr + ctx->segmentPtr] = 0;
 }
+// Convexity of the current subpath is updated for each new edge: turns have to keep the same direction, and the
+// sign of the edges coordinates may change at most twice on each axis, so that the path winds only once.
+// Nearly collinear edges are not taken into account.
+void _update_convexity(VkvgContext ctx, vec2 edge) {
+    vkvg_convexity_t *c = &ctx->convexity;
+    if (c->concave || (edge.x == 0 && edge.y == 0))
+        return;
+    if (c->refEdge.x == 0 && c->refEdge.y == 0)
+        c->refEdge = c->firstEdge = edge;
+    else {
+        // turns deviating less than a thousandth of a pixel are taken as straight, this absorbs the float
+        // rounding of densely flattened curves. The reference edge is kept until a turn is significant so
+        // that small turns of a smooth curve add up instead of being lost.
+        float cross = vec2_zcross(c->refEdge, edge);
+        float la = fabsf(c->refEdge.x) + fabsf(c->refEdge.y), lb = fabsf(edge.x) + fabsf(edge.y);
+        if (fabsf(cross) > fmaxf(1e-6f * la * lb, 1e-3f * (la + lb))) {
+            int8_t turn = cross > 0 ? 1 : -1;
+            if (c->turn == 0)
+                c->turn = turn;
+            else if (c->turn != turn)
+                c->concave = true;
+            c->refEdge = edge;
+        } else if (vec2_dot(c->refEdge, edge) < 0)
+            c->concave = true; // path going backward
+    }
+    int8_t dx = (edge.x > 1e-3f) - (edge.x < -1e-3f), dy = (edge.y > 1e-3f) - (edge.y < -1e-3f);
+    if (dx) {
+        if (c->lastDx && dx != c->lastDx)
+            c->dxChanges++;
+        c->lastDx = dx;
+    }
+    if (dy) {
+        if (c->lastDy && dy != c->lastDy)
+            c->dyChanges++;
+        c->lastDy = dy;
+    }
+    if (c->dxChanges > 2 || c->dyChanges > 2)
+        c->concave = true;
+}
+// add the closing edge and the turn on the first point, return true if the subpath is convex.
+bool _close_convexity(VkvgContext ctx, vec2 closingEdge) {
+    vkvg_convexity_t *c = &ctx->convexity;
+    _update_convexity(ctx, closingEdge);
+    _update_convexity(ctx, c->firstEdge);
+    return !c->concave && c->turn != 0;
+}
 // path start pointed at ptrPath has curve bit
 bool _path_has_curves(VkvgContext ctx, uint32_t ptrPath) { return ctx->pathes[ptrPath] & PATH_HAS_CURVES_BIT; }
 void _finish_path(VkvgContext ctx) {
@@ -173,8 +293,9 @@ void _finish_path(VkvgContext ctx) {
 
     LOG(VKVG_LOG_INFO_PATH, "PATH: points count=%10d\n", ctx->pathes[ctx->pathPtr] & PATH_ELT_MASK);
 
-    if (ctx->pathPtr == 0 && ctx->simpleConvex)
-        ctx->pathes[0] |= PATH_IS_CONVEX_BIT;
+    uint32_t firstPtIdx = ctx->pointCount - (ctx->pathes[ctx->pathPtr] & PATH_ELT_MASK);
+    if (_close_convexity(ctx, vec2_sub(ctx->points[firstPtIdx], ctx->points[ctx->pointCount - 1])))
+        ctx->pathes[ctx->pathPtr] |= PATH_IS_CONVEX_BIT;
 
     if (ctx->segmentPtr > 0) { // pathes having curves are segmented
         ctx->pathes[ctx->pathPtr] |= PATH_HAS_CURVES_BIT;
@@ -193,16 +314,16 @@ void _finish_path(VkvgContext ctx) {
     ctx->pathes[ctx->pathPtr] = 0;
     ctx->segmentPtr           = 0;
     ctx->subpathCount++;
-    ctx->simpleConvex = false;
 }
 // clear path datas in context
 void _clear_path(VkvgContext ctx) {
+    ctx->hwmPoints            = MAX(ctx->hwmPoints, ctx->pointCount);
+    ctx->hwmPathes            = MAX(ctx->hwmPathes, ctx->pathPtr + ctx->segmentPtr + 1);
     ctx->pathPtr              = 0;
     ctx->pathes[ctx->pathPtr] = 0;
     ctx->pointCount           = 0;
     ctx->segmentPtr           = 0;
     ctx->subpathCount         = 0;
-    ctx->simpleConvex         = false;
 }
 void _remove_last_point(VkvgContext ctx) {
     ctx->pathes[ctx->pathPtr]--;
@@ -230,6 +351,11 @@ void _add_point(VkvgContext ctx, float x, float y) {
         return;*/
     LOG(VKVG_LOG_INFO_PTS, "_add_point: (%f, %f)\n", x, y);
 
+    if (_current_path_is_empty(ctx))
+        ctx->convexity = (vkvg_convexity_t){0};
+    else
+        _update_convexity(ctx, vec2_sub(v, ctx->points[ctx->pointCount - 1]));
+
     ctx->points[ctx->pointCount] = v;
     ctx->pointCount++;           // total point count of pathes, (for array bounds check)
     ctx->pathes[ctx->pathPtr]++; // total point count in path
@@ -242,70 +368,218 @@ float _normalizeAngle(float a) {
         res += 2.0f * M_PIF;
     return res;
 }
+// angle step keeping the sagitta of the arc chords in device space under the context tolerance.
 float _get_arc_step(VkvgContext ctx, float radius) {
-    float sx, sy;
-    vkvg_matrix_get_scale(&ctx->pushConsts.mat, &sx, &sy);
-    float r = radius * fabsf(fmaxf(sx, sy));
-    if (r < 30.0f)
-        return fminf(M_PIF / 3.f, M_PIF / r);
-    return fminf(M_PIF / 3.f, M_PIF / (r * 0.4f));
+    float r = radius * _get_matrix_scale(ctx);
+    if (r <= ctx->tolerance)
+        return M_PIF / 3.f;
+    return fminf(M_PIF / 3.f, 2.f * acosf(1.f - ctx->tolerance / r));
 }
 void _create_gradient_buff(VkvgContext ctx) {
-    vkh_buffer_init((VkhDevice)&ctx->dev->vkDev, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VKH_MEMORY_USAGE_CPU_TO_GPU,
-                    sizeof(vkvg_gradient_t), &ctx->uboGrad, true);
+    if (!_arena_alloc(ctx->dev, VKVG_GRADIENT_RECORDS * ctx->dev->gradStride, &ctx->uboGrad))
+        ctx->status = VKVG_STATUS_NO_MEMORY;
 }
-void _create_vertices_buff(VkvgContext ctx) {
-    vkh_buffer_init((VkhDevice)&ctx->dev->vkDev, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VKH_MEMORY_USAGE_CPU_TO_GPU,
-                    ctx->sizeVBO * sizeof(Vertex), &ctx->vertices, true);
-    vkh_buffer_init((VkhDevice)&ctx->dev->vkDev, VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VKH_MEMORY_USAGE_CPU_TO_GPU,
-                    ctx->sizeIBO * sizeof(VKVG_IBO_INDEX_TYPE), &ctx->indices, true);
+// (re)allocate the vertex and index ranges of a segment in the device arena, the slack of the power of two
+// rounding of the arena is kept as extra capacity.
+static bool _alloc_vao_segment_buffers(VkvgContext ctx, vkvg_vao_segment_t *seg, bool vertices, bool indices) {
+    if (vertices) {
+        _arena_free(ctx->dev, &seg->vertices);
+        if (!_arena_alloc(ctx->dev, ctx->sizeVBO * sizeof(Vertex), &seg->vertices))
+            goto no_memory;
+        seg->sizeVBO = (uint32_t)(seg->vertices.size / sizeof(Vertex));
+    }
+    if (indices) {
+        _arena_free(ctx->dev, &seg->indices);
+        if (!_arena_alloc(ctx->dev, ctx->sizeIBO * sizeof(VKVG_IBO_INDEX_TYPE), &seg->indices))
+            goto no_memory;
+        seg->sizeIBO = (uint32_t)(seg->indices.size / sizeof(VKVG_IBO_INDEX_TYPE));
+    }
+    return true;
+no_memory:
+    seg->sizeVBO = seg->sizeIBO = 0;
+    ctx->status                 = VKVG_STATUS_NO_MEMORY;
+    return false;
 }
-void _resize_vbo(VkvgContext ctx, uint32_t new_size) {
-    if (!_wait_ctx_flush_end(ctx)) // wait previous cmd if not completed
+void _init_vao_segment(VkvgContext ctx, vkvg_vao_segment_t *seg, VkCommandBuffer cmd) {
+    VkhDevice vkhd = (VkhDevice)&ctx->dev->vkDev;
+    seg->cmd       = cmd;
+    _alloc_vao_segment_buffers(ctx, seg, true, true);
+#ifdef VKVG_ENABLE_VK_TIMELINE_SEMAPHORE
+    if (ctx->secondary)
+#endif
+        seg->fence = vkh_fence_create_signaled(vkhd);
+#if defined(DEBUG) && defined(VKVG_DBG_UTILS)
+    vkh_device_set_object_name(vkhd, VK_OBJECT_TYPE_COMMAND_BUFFER, (uint64_t)seg->cmd, "CTX Cmd Buff");
+    if (seg->fence)
+        vkh_device_set_object_name(vkhd, VK_OBJECT_TYPE_FENCE, (uint64_t)seg->fence, "CTX Flush Fence");
+#endif
+}
+void _create_vao_ring(VkvgContext ctx) {
+    VkhDevice vkhd     = (VkhDevice)&ctx->dev->vkDev;
+    ctx->vaoRingDepth  = MAX(1, ctx->dev->vaoRingDepth);
+    ctx->vaoRingIdx    = 0;
+    ctx->vaoRing       = (vkvg_vao_segment_t *)calloc(ctx->vaoRingDepth, sizeof(vkvg_vao_segment_t));
+    if (!ctx->vaoRing)
+        return;
+
+    VkCommandBufferLevel level = ctx->secondary ? VK_COMMAND_BUFFER_LEVEL_SECONDARY : VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    for (uint32_t i = 0; i < ctx->vaoRingDepth; i++) {
+        VkCommandBuffer cmd;
+        vkh_cmd_buffs_create(vkhd, ctx->cmdPool, level, 1, &cmd);
+        _init_vao_segment(ctx, &ctx->vaoRing[i], cmd);
+    }
+    ctx->cmd = ctx->vaoRing[0].cmd;
+}
+void _destroy_vao_ring(VkvgContext ctx) {
+    VkDevice dev = ctx->dev->vkDev;
+    for (uint32_t i = 0; i < ctx->vaoRingDepth; i++) {
+        vkvg_vao_segment_t *seg = &ctx->vaoRing[i];
+        vkDestroyFence(dev, seg->fence, NULL);
+        vkFreeCommandBuffers(dev, ctx->cmdPool, 1, &seg->cmd);
+        _arena_free(ctx->dev, &seg->indices);
+        _arena_free(ctx->dev, &seg->vertices);
+    }
+    free(ctx->vaoRing);
+    ctx->vaoRing = NULL;
+}
+// sub contexts cannot wait for segments awaiting execution by the parent, a new segment is inserted in the ring
+// at the current position instead.
+bool _insert_vao_segment(VkvgContext ctx) {
+    vkvg_vao_segment_t *ring =
+        (vkvg_vao_segment_t *)realloc(ctx->vaoRing, (ctx->vaoRingDepth + 1) * sizeof(vkvg_vao_segment_t));
+    if (ring == NULL) {
+        ctx->status = VKVG_STATUS_NO_MEMORY;
+        return false;
+    }
+    vkvg_vao_segment_t *seg = &ring[ctx->vaoRingIdx];
+    memmove(seg + 1, seg, (ctx->vaoRingDepth - ctx->vaoRingIdx) * sizeof(vkvg_vao_segment_t));
+    memset(seg, 0, sizeof(vkvg_vao_segment_t));
+    ctx->vaoRing = ring;
+    ctx->vaoRingDepth++;
+
+    VkCommandBuffer cmd;
+    vkh_cmd_buffs_create((VkhDevice)&ctx->dev->vkDev, ctx->cmdPool, VK_COMMAND_BUFFER_LEVEL_SECONDARY, 1, &cmd);
+    _init_vao_segment(ctx, seg, cmd);
+    ctx->cmd = cmd;
+    return true;
+}
+// wait for the gpu to release the current vao segment so that its command buffer may be recorded
+// and its vertex and index buffers filled. Buffers smaller than the context sizes are grown here.
+bool _acquire_vao_segment(VkvgContext ctx) {
+    if (ctx->secondary && ctx->vaoRing[ctx->vaoRingIdx].subSeq && !_insert_vao_segment(ctx))
+        return false;
+    vkvg_vao_segment_t *seg = &ctx->vaoRing[ctx->vaoRingIdx];
+    if (_wait_vao_segment(ctx, seg, VKVG_FENCE_TIMEOUT) != VK_SUCCESS) {
+        LOG(VKVG_LOG_DEBUG, "CTX: _acquire_vao_segment timeout\n");
+        ctx->status = VKVG_STATUS_TIMEOUT;
+        return false;
+    }
+    if (!ctx->secondary) // this segment submission and the previous ones are done
+#ifdef VKVG_ENABLE_VK_TIMELINE_SEMAPHORE
+        _release_completed_sources(ctx, seg->timelineStep);
+#else
+        _release_completed_sources(ctx, seg->ticket);
+#endif
+#ifdef VKVG_VAO_ZERO_COPY
+    if (seg->sizeVBO < ctx->sizeVBO || seg->sizeIBO < ctx->sizeIBO) {
+        _unmap_vao_segment(ctx, 0, 0); // mapped buffers are about to be reallocated
+        if (ctx->vaoMapped)
+            return false;
+    }
+#endif
+    if (seg->sizeVBO < ctx->sizeVBO || seg->sizeIBO < ctx->sizeIBO)
+        return _alloc_vao_segment_buffers(ctx, seg, seg->sizeVBO < ctx->sizeVBO, seg->sizeIBO < ctx->sizeIBO);
+    return true;
+}
+#ifdef VKVG_VAO_ZERO_COPY
+// emit next vertices and indices directly in the mapped vk buffers of the current vao segment, this implies waiting
+// for the previous use of the segment. If host caches are not empty, they are kept until next flush.
+void _map_vao_segment(VkvgContext ctx) {
+    if (ctx->vaoMapped) // buffers of the previous segment may not be written anymore.
+        _unmap_vao_segment(ctx, 0, 0);
+    if (ctx->vertCount > 0 || ctx->indCount > 0 || !_acquire_vao_segment(ctx))
+        return;
+    vkvg_vao_segment_t *seg = &ctx->vaoRing[ctx->vaoRingIdx];
+    ctx->vertexCache        = (Vertex *)_arena_get_mapped_pointer(&seg->vertices);
+    ctx->indexCache         = (VKVG_IBO_INDEX_TYPE *)_arena_get_mapped_pointer(&seg->indices);
+    ctx->sizeVertices       = seg->sizeVBO;
+    ctx->sizeIndices        = seg->sizeIBO;
+    ctx->vaoMapped          = true;
+}
+// called before emitting vertices, the next segment is only waited for and mapped once the previous one has been
+// submitted and new vertices are about to be written.
+void _ensure_vao_mapped(VkvgContext ctx) {
+    if (!ctx->vaoMapped && ctx->vertCount == 0 && ctx->indCount == 0)
+        _map_vao_segment(ctx);
+}
+// switch back to host caches, vertices and indices emitted in the mapped buffers starting at vxBase and idxBase
+// are copied at the start of the host caches.
+void _unmap_vao_segment(VkvgContext ctx, uint32_t vxBase, uint32_t idxBase) {
+    if (!ctx->vaoMapped)
         return;
+    if (ctx->sizeHostVertices < ctx->sizeVertices) {
+        Vertex *tmp = (Vertex *)realloc(ctx->hostVertexCache, (size_t)ctx->sizeVertices * sizeof(Vertex));
+        if (tmp == NULL) {
+            ctx->status = VKVG_STATUS_NO_MEMORY;
+            LOG(VKVG_LOG_ERR, "resize host vertex cache failed: vert count: %u\n", ctx->sizeVertices);
+            return;
+        }
+        ctx->hostVertexCache  = tmp;
+        ctx->sizeHostVertices = ctx->sizeVertices;
+    }
+    if (ctx->sizeHostIndices < ctx->sizeIndices) {
+        VKVG_IBO_INDEX_TYPE *tmp = (VKVG_IBO_INDEX_TYPE *)realloc(
+            ctx->hostIndexCache, (size_t)ctx->sizeIndices * sizeof(VKVG_IBO_INDEX_TYPE));
+        if (tmp == NULL) {
+            ctx->status = VKVG_STATUS_NO_MEMORY;
+            LOG(VKVG_LOG_ERR, "resize host index cache failed: idx count: %u\n", ctx->sizeIndices);
+            return;
+        }
+        ctx->hostIndexCache  = tmp;
+        ctx->sizeHostIndices = ctx->sizeIndices;
+    }
+    LOG(VKVG_LOG_DBG_ARRAYS, "unmap vao segment: vertices = %u indices = %u\n", ctx->vertCount - vxBase,
+        ctx->indCount - idxBase);
+    memcpy(ctx->hostVertexCache, &ctx->vertexCache[vxBase], (ctx->vertCount - vxBase) * sizeof(Vertex));
+    memcpy(ctx->hostIndexCache, &ctx->indexCache[idxBase], (ctx->indCount - idxBase) * sizeof(VKVG_IBO_INDEX_TYPE));
+    ctx->vertexCache  = ctx->hostVertexCache;
+    ctx->indexCache   = ctx->hostIndexCache;
+    ctx->sizeVertices = ctx->sizeHostVertices;
+    ctx->sizeIndices  = ctx->sizeHostIndices;
+    ctx->vaoMapped    = false;
+}
+#endif
+// vbo and ibo resize only affect the current segment, others are grown when reused.
+void _resize_vbo(VkvgContext ctx, uint32_t new_size) {
     LOG(VKVG_LOG_DBG_ARRAYS, "resize VBO: %d -> ", ctx->sizeVBO);
-    ctx->sizeVBO = new_size;
-    uint32_t mod = ctx->sizeVBO % VKVG_VBO_SIZE;
-    if (mod > 0)
-        ctx->sizeVBO += VKVG_VBO_SIZE - mod;
+    ctx->sizeVBO = _next_array_size(ctx, ctx->sizeVBO, new_size, VKVG_VBO_SIZE);
     LOG(VKVG_LOG_DBG_ARRAYS, "%d\n", ctx->sizeVBO);
-    vkh_buffer_resize(&ctx->vertices, ctx->sizeVBO * sizeof(Vertex), true);
+    _acquire_vao_segment(ctx); // wait previous use of the segment if not completed
 }
 void _resize_ibo(VkvgContext ctx, size_t new_size) {
-    if (!_wait_ctx_flush_end(ctx)) // wait previous cmd if not completed
-        return;
-    ctx->sizeIBO = new_size;
-    uint32_t mod = ctx->sizeIBO % VKVG_IBO_SIZE;
-    if (mod > 0)
-        ctx->sizeIBO += VKVG_IBO_SIZE - mod;
+    ctx->sizeIBO = _next_array_size(ctx, ctx->sizeIBO, (uint32_t)new_size, VKVG_IBO_SIZE);
     LOG(VKVG_LOG_DBG_ARRAYS, "resize IBO: new size: %d\n", ctx->sizeIBO);
-    vkh_buffer_resize(&ctx->indices, ctx->sizeIBO * sizeof(VKVG_IBO_INDEX_TYPE), true);
+    _acquire_vao_segment(ctx); // wait previous use of the segment if not completed
 }
 void _add_vertexf(VkvgContext ctx, float x, float y) {
     Vertex *pVert = &ctx->vertexCache[ctx->vertCount];
-    pVert->pos.x  = x;
-    pVert->pos.y  = y;
-    pVert->color  = ctx->curColor;
-    pVert->uv.z   = -1;
-    LOG(VKVG_LOG_INFO_VBO, "Add Vertexf %10d: pos:(%10.4f, %10.4f) uv:(%10.4f,%10.4f,%10.4f) color:0x%.8x \n",
-        ctx->vertCount, pVert->pos.x, pVert->pos.y, pVert->uv.x, pVert->uv.y, pVert->uv.z, pVert->color);
+    *pVert        = (Vertex){{x, y}, ctx->vxColor, VKVG_VERTEX_NO_UV};
+    LOG(VKVG_LOG_INFO_VBO, "Add Vertexf %10d: pos:(%10.4f, %10.4f) " VKVG_UV_LOG_FMT " color:0x%.8x \n", ctx->vertCount,
+        pVert->pos.x, pVert->pos.y, VKVG_UV_LOG_ARGS(*pVert), pVert->color);
     ctx->vertCount++;
     _check_vertex_cache_size(ctx);
 }
 void _add_vertexf_unchecked(VkvgContext ctx, float x, float y) {
     Vertex *pVert = &ctx->vertexCache[ctx->vertCount];
-    pVert->pos.x  = x;
-    pVert->pos.y  = y;
-    pVert->color  = ctx->curColor;
-    pVert->uv.z   = -1;
-    LOG(VKVG_LOG_INFO_VBO, "Add Vertexf %10d: pos:(%10.4f, %10.4f) uv:(%10.4f,%10.4f,%10.4f) color:0x%.8x \n",
-        ctx->vertCount, pVert->pos.x, pVert->pos.y, pVert->uv.x, pVert->uv.y, pVert->uv.z, pVert->color);
+    *pVert        = (Vertex){{x, y}, ctx->vxColor, VKVG_VERTEX_NO_UV};
+    LOG(VKVG_LOG_INFO_VBO, "Add Vertexf %10d: pos:(%10.4f, %10.4f) " VKVG_UV_LOG_FMT " color:0x%.8x \n", ctx->vertCount,
+        pVert->pos.x, pVert->pos.y, VKVG_UV_LOG_ARGS(*pVert), pVert->color);
     ctx->vertCount++;
 }
 void _add_vertex(VkvgContext ctx, Vertex v) {
     ctx->vertexCache[ctx->vertCount] = v;
-    LOG(VKVG_LOG_INFO_VBO, "Add Vertex  %10d: pos:(%10.4f, %10.4f) uv:(%10.4f,%10.4f,%10.4f) color:0x%.8x \n",
-        ctx->vertCount, v.pos.x, v.pos.y, v.uv.x, v.uv.y, v.uv.z, v.color);
+    LOG(VKVG_LOG_INFO_VBO, "Add Vertex  %10d: pos:(%10.4f, %10.4f) " VKVG_UV_LOG_FMT " color:0x%.8x \n", ctx->vertCount,
+        v.pos.x, v.pos.y, VKVG_UV_LOG_ARGS(v), v.color);
     ctx->vertCount++;
     _check_vertex_cache_size(ctx);
 }
@@ -373,10 +647,10 @@ void _add_triangle_indices_unchecked(VkvgContext ctx, VKVG_IBO_INDEX_TYPE i0, VK
     LOG(VKVG_LOG_INFO_IBO, "Triangle IDX: %d %d %d (indCount=%d)\n", i0, i1, i2, ctx->indCount);
 }
 void _vao_add_rectangle(VkvgContext ctx, float x, float y, float width, float height) {
-    Vertex              v[4]     = {{{x, y}, ctx->curColor, {0, 0, -1}},
-                                    {{x, y + height}, ctx->curColor, {0, 0, -1}},
-                                    {{x + width, y}, ctx->curColor, {0, 0, -1}},
-                                    {{x + width, y + height}, ctx->curColor, {0, 0, -1}}};
+    Vertex              v[4]     = {{{x, y}, ctx->vxColor, VKVG_VERTEX_NO_UV},
+                                    {{x, y + height}, ctx->vxColor, VKVG_VERTEX_NO_UV},
+                                    {{x + width, y}, ctx->vxColor, VKVG_VERTEX_NO_UV},
+                                    {{x + width, y + height}, ctx->vxColor, VKVG_VERTEX_NO_UV}};
     VKVG_IBO_INDEX_TYPE firstIdx = (VKVG_IBO_INDEX_TYPE)(ctx->vertCount - ctx->curVertOffset);
     Vertex             *pVert    = &ctx->vertexCache[ctx->vertCount];
     memcpy(pVert, v, 4 * sizeof(Vertex));
@@ -394,29 +668,88 @@ void _ensure_renderpass_is_started(VkvgContext ctx) {
     else if (ctx->pushCstDirty)
         _update_push_constants(ctx);
 }
-void _create_cmd_buff(VkvgContext ctx) {
-    vkh_cmd_buffs_create((VkhDevice)&ctx->dev->vkDev, ctx->cmdPool, VK_COMMAND_BUFFER_LEVEL_PRIMARY, 2,
-                         ctx->cmdBuffers);
-#if defined(DEBUG) && defined(ENABLE_VALIDATION)
-    vkh_device_set_object_name((VkhDevice)&ctx->pSurf->dev->vkDev, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT,
-                               (uint64_t)ctx->cmd, "vkvgCtxCmd");
-#endif
-}
 void _clear_attachment(VkvgContext ctx) {}
 
-bool _wait_ctx_flush_end(VkvgContext ctx) {
-    LOG(VKVG_LOG_INFO, "CTX: _wait_flush_fence\n");
+// wait for all the submissions of this context to be completed.
+// wait for the last submission of a vao segment, submitting first its device batch if still queued.
+// With timeline semaphores, the timeout only applies to sub contexts.
+VkResult _wait_vao_segment(VkvgContext ctx, vkvg_vao_segment_t *seg, uint64_t timeout) {
 #ifdef VKVG_ENABLE_VK_TIMELINE_SEMAPHORE
-    if (vkh_timeline_wait((VkhDevice)&ctx->dev->vkDev, ctx->pSurf->timeline, ctx->timelineStep) == VK_SUCCESS)
-        return true;
+    if (!ctx->secondary) {
+        if (seg->batch)
+            _device_submit_batch(ctx->dev, seg->batch);
+        else if (ctx->pSurf->queueIdx != 0) {
+            // submissions on other queues may wait for steps still queued in the batch of the first queue.
+            _device_lock_queue(ctx->dev, 0);
+            _device_unlock_queue(ctx->dev, 0);
+        }
+        return seg->timelineStep == 0
+                   ? VK_SUCCESS
+                   : vkh_timeline_wait((VkhDevice)&ctx->dev->vkDev, ctx->pSurf->timeline, seg->timelineStep);
+    }
 #else
-    if (WaitForFences(ctx->dev->vkDev, 1, &ctx->flushFence, VK_TRUE, VKVG_FENCE_TIMEOUT) == VK_SUCCESS)
-        return true;
+    if (seg->batch)
+        return _device_wait_batch(ctx->dev, seg->batch, timeout);
 #endif
+    if (timeout == 0)
+        return vkGetFenceStatus(ctx->dev->vkDev, seg->fence) == VK_SUCCESS ? VK_SUCCESS : VK_TIMEOUT;
+    return WaitForFences(ctx->dev->vkDev, 1, &seg->fence, VK_TRUE, timeout);
+}
+bool _wait_ctx_flush_end(VkvgContext ctx) {
+    LOG(VKVG_LOG_INFO, "CTX: _wait_flush_fence\n");
+    if (ctx->secondary) {
+        for (uint32_t i = 0; i < ctx->vaoRingDepth; i++) {
+            if (ctx->vaoRing[i].subSeq == 0)
+                continue;
+            LOG(VKVG_LOG_ERR, "CTX: sub context %p cannot wait for commands not yet executed by its parent\n", ctx);
+            ctx->status = VKVG_STATUS_INVALID_STATUS;
+            return false;
+        }
+    }
+    uint32_t i = 0;
+    while (i < ctx->vaoRingDepth && _wait_vao_segment(ctx, &ctx->vaoRing[i], VKVG_FENCE_TIMEOUT) == VK_SUCCESS)
+        i++;
+    if (i == ctx->vaoRingDepth)
+        return true;
     LOG(VKVG_LOG_DEBUG, "CTX: _wait_flush_fence timeout\n");
     ctx->status = VKVG_STATUS_TIMEOUT;
     return false;
 }
+// return the ticket of the last submission of this context, 0 if nothing has been submitted yet.
+uint64_t _get_flush_ticket(VkvgContext ctx) {
+#ifdef VKVG_ENABLE_VK_TIMELINE_SEMAPHORE
+    return ctx->timelineStep;
+#else
+    return ctx->submitCount;
+#endif
+}
+// wait for the submission identified by ticket to be completed, timeout is in nanoseconds, 0 to only poll.
+// Unlike _wait_ctx_flush_end, a timeout does not affect the context status.
+VkResult _wait_flush_ticket(VkvgContext ctx, uint64_t ticket, uint64_t timeout) {
+    if (ticket == 0)
+        return VK_SUCCESS;
+#ifdef VKVG_ENABLE_VK_TIMELINE_SEMAPHORE
+    for (uint32_t i = 0; i < ctx->vaoRingDepth; i++) {
+        if (ctx->vaoRing[i].batch) // queued submissions have to be submitted first
+            _device_submit_batch(ctx->dev, ctx->vaoRing[i].batch);
+    }
+    // timeline values are monotonic, so the semaphore counter directly tells if ticket is reached.
+    VkSemaphoreWaitInfo waitInfo = {.sType          = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+                                    .semaphoreCount = 1,
+                                    .pSemaphores    = &ctx->pSurf->timeline,
+                                    .pValues        = &ticket};
+    return vkWaitSemaphores(ctx->dev->vkDev, &waitInfo, timeout);
+#else
+    // a vao segment is only reused once its previous submission is completed, so if no segment
+    // still holds the ticket, the submission is done.
+    for (uint32_t i = 0; i < ctx->vaoRingDepth; i++) {
+        vkvg_vao_segment_t *seg = &ctx->vaoRing[i];
+        if (seg->ticket == ticket)
+            return _wait_vao_segment(ctx, seg, timeout);
+    }
+    return VK_SUCCESS;
+#endif
+}
 
 bool _wait_and_submit_cmd(VkvgContext ctx) {
     if (!ctx->cmdStarted) // current cmd buff is empty, be aware that wait is also canceled!!
@@ -424,50 +757,117 @@ bool _wait_and_submit_cmd(VkvgContext ctx) {
 
     LOG(VKVG_LOG_INFO, "CTX: _wait_and_submit_cmd\n");
 
+    if (ctx->secondary)
+        _hand_over_sub_segment(ctx);
+    else
+        _submit_ctx_cmd(ctx);
+
+    // next segment will be waited for on first use, cpu is free to continue recording.
+    ctx->vaoRingIdx = (ctx->vaoRingIdx + 1) % ctx->vaoRingDepth;
+    ctx->cmd        = ctx->vaoRing[ctx->vaoRingIdx].cmd;
+    ctx->cmdStarted = false;
+#ifdef VKVG_VAO_ZERO_COPY
+    // buffers of the submitted segment may not be written anymore, the next one is mapped on first use.
+    _unmap_vao_segment(ctx, 0, 0);
+#endif
+    return true;
+}
+// sub contexts do not submit, the recorded segment waits for its execution by the parent which will signal its fence.
+void _hand_over_sub_segment(VkvgContext ctx) {
+    vkvg_vao_segment_t *seg = &ctx->vaoRing[ctx->vaoRingIdx];
+    ResetFences(ctx->dev->vkDev, 1, &seg->fence);
+    seg->subSeq = ++ctx->subSeqCount;
+}
+// the render pass transitions recorded by the context are submitted or dropped, surface must be locked.
+void _release_pending_transition(VkvgContext ctx) {
+    if (!ctx->pendingTransition)
+        return;
+    ctx->pendingTransition = false;
+    ctx->pSurf->pendingTransitions--;
+}
+#ifdef VKVG_ENABLE_VK_TIMELINE_SEMAPHORE
+// add the timeline of a source sampled by the submission. Its step is reserved under the source lock, the
+// submission follows before the lock of the target surface is released.
+static void _add_source_timeline(VkvgContext ctx, vkvg_vao_segment_t *seg, VkvgSurface source) {
+    if (source == ctx->pSurf)
+        return;
+    for (uint32_t i = 0; i < seg->semaphoreCount; i++) {
+        if (seg->semaphores[i] == source->timeline) // same surface with another sampler
+            return;
+    }
+    uint32_t i = seg->semaphoreCount++;
+    LOCK_SURFACE(source)
+    seg->semaphores[i]   = source->timeline;
+    seg->waitValues[i]   = source->timelineStep;
+    seg->signalValues[i] = ++source->timelineStep;
+    seg->waitStages[i]   = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+    UNLOCK_SURFACE(source)
+    // the awaited step may still be queued in the batch of the first queue, it is flushed so that the queue of the
+    // target is not stalled until then.
+    if (source->queueIdx == 0 && ctx->pSurf->queueIdx != 0) {
+        _device_lock_queue(ctx->dev, 0);
+        _device_unlock_queue(ctx->dev, 0);
+    }
+}
+#endif
+void _submit_ctx_cmd(VkvgContext ctx) {
+    vkvg_vao_segment_t   *seg    = &ctx->vaoRing[ctx->vaoRingIdx];
+    vkvg_batched_submit_t submit = {.cmd = ctx->cmd};
 #ifdef VKVG_ENABLE_VK_TIMELINE_SEMAPHORE
     VkvgSurface surf = ctx->pSurf;
     VkvgDevice  dev  = surf->dev;
-    // vkh_timeline_wait ((VkhDevice)&dev->vkDev, surf->timeline, ct->timelineStep);
-    if (ctx->pattern && ctx->pattern->type == VKVG_PATTERN_TYPE_SURFACE) {
-        // add source surface timeline sync.
-        VkvgSurface source = (VkvgSurface)ctx->pattern->data;
-        LOCK_SURFACE(surf)
-        LOCK_SURFACE(source)
-        LOCK_DEVICE
-        vkh_cmd_submit_timelined2(dev->gQueue, &ctx->cmd, (VkSemaphore[2]){surf->timeline, source->timeline},
-                                  (uint64_t[2]){surf->timelineStep, source->timelineStep},
-                                  (uint64_t[2]){surf->timelineStep + 1, source->timelineStep + 1});
-        surf->timelineStep++;
-        source->timelineStep++;
-        ctx->timelineStep = surf->timelineStep;
-        UNLOCK_DEVICE
-        UNLOCK_SURFACE(source)
-        UNLOCK_SURFACE(surf)
-    } else {
-        LOCK_SURFACE(surf)
-        LOCK_DEVICE
-        vkh_cmd_submit_timelined(dev->gQueue, &ctx->cmd, surf->timeline, surf->timelineStep, surf->timelineStep + 1);
-        surf->timelineStep++;
-        ctx->timelineStep = surf->timelineStep;
-        UNLOCK_DEVICE
-        UNLOCK_SURFACE(surf)
+    LOCK_SURFACE(surf)
+    seg->semaphores[0]   = surf->timeline;
+    seg->waitValues[0]   = surf->timelineStep;
+    seg->signalValues[0] = surf->timelineStep + 1;
+    seg->waitStages[0]   = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+    seg->semaphoreCount  = 1;
+    // every source sampled since the last submission is synchronized, not only the current one.
+    for (uint32_t i = 0; i < ctx->srcCacheCount; i++) {
+        if (ctx->srcCache[i].surf && ctx->srcCache[i].inCmd)
+            _add_source_timeline(ctx, seg, ctx->srcCache[i].surf);
     }
+    if (ctx->srcFallback)
+        _add_source_timeline(ctx, seg, (VkvgSurface)ctx->pattern->data);
+    submit.semaphoreCount = seg->semaphoreCount;
+    submit.semaphores     = seg->semaphores;
+    submit.waitValues     = seg->waitValues;
+    submit.signalValues   = seg->signalValues;
+    submit.waitStages     = seg->waitStages;
+    // batches are submitted to the first queue.
+    seg->batch = surf->queueIdx == 0 ? _device_queue_submit(dev, &submit) : 0;
+    if (seg->batch == 0)
+        _device_submit_timelined(dev, surf->queueIdx, &submit);
+    surf->timelineStep++;
+    ctx->timelineStep = seg->timelineStep = surf->timelineStep;
+    _release_pending_transition(ctx);
+    UNLOCK_SURFACE(surf)
 #else
-
-    if (!_wait_ctx_flush_end(ctx))
-        return false;
-    ResetFences(ctx->dev->vkDev, 1, &ctx->flushFence);
-    _device_submit_cmd(ctx->dev, &ctx->cmd, ctx->flushFence);
+    LOCK_SURFACE(ctx->pSurf)
+    // batches are submitted to the first queue.
+    seg->batch = ctx->pSurf->queueIdx == 0 ? _device_queue_submit(ctx->dev, &submit) : 0;
+    if (seg->batch == 0) {
+        // the segment has been acquired before recording, so its fence is signaled.
+        ResetFences(ctx->dev->vkDev, 1, &seg->fence);
+        _device_submit_cmd_to_queue(ctx->dev, ctx->pSurf->queueIdx, &ctx->cmd, seg->fence);
+    }
+    seg->ticket = ++ctx->submitCount;
+    _release_pending_transition(ctx);
+    UNLOCK_SURFACE(ctx->pSurf)
 #endif
-
-    if (ctx->cmd == ctx->cmdBuffers[0])
-        ctx->cmd = ctx->cmdBuffers[1];
-    else
-        ctx->cmd = ctx->cmdBuffers[0];
-
-    ResetCommandBuffer(ctx->cmd, 0);
-    ctx->cmdStarted = false;
-    return true;
+    // cached sources are released once their last submission is done, the current one stays in use.
+    uint64_t ticket = _get_flush_ticket(ctx);
+    for (uint32_t i = 0; i < ctx->srcCacheCount; i++) {
+        vkvg_source_desc_t *src = &ctx->srcCache[i];
+        if (src->surf == NULL || !src->inCmd)
+            continue;
+        src->ticket = ticket;
+        src->inCmd  = src->ds == ctx->dsSrcCur;
+    }
+    // sub contexts segments executed in this cmd may be reused once it is done.
+    for (uint32_t i = 0; i < ctx->subFenceCount; i++)
+        _device_signal_fence(ctx->dev, ctx->pSurf->queueIdx, ctx->subFences[i]);
+    ctx->subFenceCount = 0;
 }
 /*void _explicit_ms_resolve (VkvgContext ctx){//should init cmd before calling this (unused, using automatic resolve by
 renderpass) vkh_image_set_layout (ctx->cmd, ctx->pSurf->imgMS, VK_IMAGE_ASPECT_COLOR_BIT,
@@ -493,39 +893,71 @@ renderpass) vkh_image_set_layout (ctx->cmd, ctx->pSurf->imgMS, VK_IMAGE_ASPECT_C
 }*/
 
 // pre flush vertices because of vbo or ibo too small, all vertices except last draw call are flushed
-// this function expects a vertex offset > 0
+// this function expects a vertex offset > vertex base
 void _flush_vertices_caches_until_vertex_base(VkvgContext ctx) {
-    _wait_ctx_flush_end(ctx);
-
-    memcpy(vkh_buffer_get_mapped_pointer(&ctx->vertices), ctx->vertexCache, ctx->curVertOffset * sizeof(Vertex));
-    memcpy(vkh_buffer_get_mapped_pointer(&ctx->indices), ctx->indexCache,
-           ctx->curIndStart * sizeof(VKVG_IBO_INDEX_TYPE));
-
-    // copy remaining vertices and indices to caches starts
-    // this could be optimized at the cost of additional offsets.
-    ctx->vertCount -= ctx->curVertOffset;
-    ctx->indCount -= ctx->curIndStart;
-    memcpy(ctx->vertexCache, &ctx->vertexCache[ctx->curVertOffset], ctx->vertCount * sizeof(Vertex));
-    memcpy(ctx->indexCache, &ctx->indexCache[ctx->curIndStart], ctx->indCount * sizeof(VKVG_IBO_INDEX_TYPE));
-
-    ctx->curVertOffset = 0;
-    ctx->curIndStart   = 0;
+#ifdef VKVG_VAO_ZERO_COPY
+    if (ctx->vaoMapped) {
+        // drawn vertices are already in the vk buffers, remaining ones are moved to the host caches starts.
+        _unmap_vao_segment(ctx, ctx->curVertOffset, ctx->curIndStart);
+        // vbo window starts at cache beginning when mapped.
+        ctx->vertCount -= ctx->curVertOffset;
+        ctx->xformVertBase -= MIN(ctx->xformVertBase, ctx->curVertOffset);
+        ctx->indCount -= ctx->curIndStart;
+        ctx->curVertOffset = 0;
+        ctx->curIndStart   = 0;
+        return;
+    }
+#endif
+    vkvg_vao_segment_t *seg = &ctx->vaoRing[ctx->vaoRingIdx];
+
+    memcpy(_arena_get_mapped_pointer(&seg->vertices), &ctx->vertexCache[ctx->vertBase],
+           (ctx->curVertOffset - ctx->vertBase) * sizeof(Vertex));
+    memcpy(_arena_get_mapped_pointer(&seg->indices), &ctx->indexCache[ctx->indBase],
+           (ctx->curIndStart - ctx->indBase) * sizeof(VKVG_IBO_INDEX_TYPE));
+
+    // remaining vertices and indices stay in place, next vbo and ibo windows start at the current offsets.
+    // Indices are relative to the vertex offset, so they are still valid.
+    ctx->vertBase = ctx->curVertOffset;
+    ctx->indBase  = ctx->curIndStart;
+    // windows are moved back to the caches starts when nothing remains, or once past the half of the caches to
+    // keep them from growing with every vertex of a long recording.
+    if (ctx->vertBase == ctx->vertCount || ctx->vertBase > ctx->sizeVertices / 2 ||
+        ctx->indBase > ctx->sizeIndices / 2) {
+        ctx->vertCount -= ctx->vertBase;
+        ctx->indCount -= ctx->indBase;
+        memmove(ctx->vertexCache, &ctx->vertexCache[ctx->vertBase], ctx->vertCount * sizeof(Vertex));
+        memmove(ctx->indexCache, &ctx->indexCache[ctx->indBase], ctx->indCount * sizeof(VKVG_IBO_INDEX_TYPE));
+        ctx->xformVertBase -= MIN(ctx->xformVertBase, ctx->vertBase);
+        ctx->curVertOffset = ctx->curIndStart = ctx->vertBase = ctx->indBase = 0;
+    }
 }
-// copy vertex and index caches to the vbo and ibo vkbuffers used by gpu for drawing
-// current running cmd has to be completed to free usage of those
+// copy vertex and index caches to the vbo and ibo vkbuffers of the current vao segment used by gpu for drawing.
+// The segment has been acquired when its cmd was started, so previous submissions may still be running.
 void _flush_vertices_caches(VkvgContext ctx) {
-    if (!_wait_ctx_flush_end(ctx))
+    ctx->hwmVertices = MAX(ctx->hwmVertices, ctx->vertCount);
+    ctx->hwmIndices  = MAX(ctx->hwmIndices, ctx->indCount);
+#ifdef VKVG_VAO_ZERO_COPY
+    if (ctx->vaoMapped) { // vertices and indices are already in the vk buffers.
+        ctx->vertCount = ctx->indCount = ctx->curIndStart = ctx->curVertOffset = ctx->xformVertBase = 0;
+        ctx->opRangeCount = 0;
         return;
+    }
+#endif
+    vkvg_vao_segment_t *seg = &ctx->vaoRing[ctx->vaoRingIdx];
 
-    memcpy(vkh_buffer_get_mapped_pointer(&ctx->vertices), ctx->vertexCache, ctx->vertCount * sizeof(Vertex));
-    memcpy(vkh_buffer_get_mapped_pointer(&ctx->indices), ctx->indexCache, ctx->indCount * sizeof(VKVG_IBO_INDEX_TYPE));
+    memcpy(_arena_get_mapped_pointer(&seg->vertices), &ctx->vertexCache[ctx->vertBase],
+           (ctx->vertCount - ctx->vertBase) * sizeof(Vertex));
+    memcpy(_arena_get_mapped_pointer(&seg->indices), &ctx->indexCache[ctx->indBase],
+           (ctx->indCount - ctx->indBase) * sizeof(VKVG_IBO_INDEX_TYPE));
 
-    ctx->vertCount = ctx->indCount = ctx->curIndStart = ctx->curVertOffset = 0;
+    ctx->vertCount = ctx->indCount = ctx->curIndStart = ctx->curVertOffset = ctx->xformVertBase = 0;
+    ctx->vertBase = ctx->indBase = ctx->opRangeCount = 0;
 }
 // this func expect cmdStarted to be true
 void _end_render_pass(VkvgContext ctx) {
     LOG(VKVG_LOG_INFO, "END RENDER PASS: ctx = %p;\n", ctx);
-    CmdEndRenderPass(ctx->cmd);
+    if (!ctx->secondary)
+        CmdEndRenderPass(ctx->cmd);
 #if defined(DEBUG) && defined(VKVG_DBG_UTILS)
     vkh_cmd_label_end(ctx->cmd);
 #endif
@@ -533,16 +965,16 @@ void _end_render_pass(VkvgContext ctx) {
 }
 
 void _check_vao_size(VkvgContext ctx) {
-    if (ctx->vertCount > ctx->sizeVBO || ctx->indCount > ctx->sizeIBO) {
+    if (ctx->vertCount - ctx->vertBase > ctx->sizeVBO || ctx->indCount - ctx->indBase > ctx->sizeIBO) {
         // vbo or ibo buffers too small
         if (ctx->cmdStarted)
             // if cmd is started buffers, are already bound, so no resize is possible
             // instead we flush, and clear vbo and ibo caches
             _flush_cmd_until_vx_base(ctx);
-        if (ctx->vertCount > ctx->sizeVBO)
-            _resize_vbo(ctx, ctx->sizeVertices);
-        if (ctx->indCount > ctx->sizeIBO)
-            _resize_ibo(ctx, ctx->sizeIndices);
+        if (ctx->vertCount - ctx->vertBase > ctx->sizeVBO)
+            _resize_vbo(ctx, ctx->sizeVertices - ctx->vertBase);
+        if (ctx->indCount - ctx->indBase > ctx->sizeIBO)
+            _resize_ibo(ctx, ctx->sizeIndices - ctx->indBase);
     }
 }
 
@@ -551,25 +983,34 @@ void _emit_draw_cmd_undrawn_vertices(VkvgContext ctx) {
     if (ctx->indCount == ctx->curIndStart)
         return;
 
+    _transform_pending_vertices(ctx);
+
     _check_vao_size(ctx);
 
     _ensure_renderpass_is_started(ctx);
 
+    // draw commands are relative to the vbo and ibo windows in the caches.
+    uint32_t firstIdx = ctx->curIndStart - ctx->indBase;
+    int32_t  vxOffset = (int32_t)(ctx->curVertOffset - ctx->vertBase);
+
 #ifdef VKVG_WIRED_DEBUG
     if (vkvg_wired_debug & vkvg_wired_debug_mode_normal)
-        CmdDrawIndexed(ctx->cmd, ctx->indCount - ctx->curIndStart, 1, ctx->curIndStart, (int32_t)ctx->curVertOffset, 0);
+        CmdDrawIndexed(ctx->cmd, ctx->indCount - ctx->curIndStart, 1, firstIdx, vxOffset, 0);
     if (vkvg_wired_debug & vkvg_wired_debug_mode_lines) {
         CmdBindPipeline(ctx->cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, ctx->pSurf->dev->pipelineLineList);
-        CmdDrawIndexed(ctx->cmd, ctx->indCount - ctx->curIndStart, 1, ctx->curIndStart, (int32_t)ctx->curVertOffset, 0);
+        CmdDrawIndexed(ctx->cmd, ctx->indCount - ctx->curIndStart, 1, firstIdx, vxOffset, 0);
     }
     if (vkvg_wired_debug & vkvg_wired_debug_mode_points) {
         CmdBindPipeline(ctx->cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, ctx->pSurf->dev->pipelineWired);
-        CmdDrawIndexed(ctx->cmd, ctx->indCount - ctx->curIndStart, 1, ctx->curIndStart, (int32_t)ctx->curVertOffset, 0);
+        CmdDrawIndexed(ctx->cmd, ctx->indCount - ctx->curIndStart, 1, firstIdx, vxOffset, 0);
     }
     if (vkvg_wired_debug & vkvg_wired_debug_mode_both)
         CmdBindPipeline(ctx->cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, ctx->pSurf->dev->pipe_OVER);
 #else
-    CmdDrawIndexed(ctx->cmd, ctx->indCount - ctx->curIndStart, 1, ctx->curIndStart, (int32_t)ctx->curVertOffset, 0);
+    if (ctx->opRangeCount > 0)
+        _emit_draw_cmds_by_operator(ctx, firstIdx, vxOffset);
+    else
+        CmdDrawIndexed(ctx->cmd, ctx->indCount - ctx->curIndStart, 1, firstIdx, vxOffset, 0);
 #endif
     LOG(VKVG_LOG_INFO,
         "RECORD DRAW CMD: ctx = %p; vertices = %d; indices = %d (vxOff = %d idxStart = %d idxTot = %d )\n", ctx,
@@ -578,11 +1019,12 @@ void _emit_draw_cmd_undrawn_vertices(VkvgContext ctx) {
 
     ctx->curIndStart   = ctx->indCount;
     ctx->curVertOffset = ctx->vertCount;
+    ctx->opRangeCount  = 0;
 }
 // preflush vertices with drawcommand already emited
 void _flush_cmd_until_vx_base(VkvgContext ctx) {
     _end_render_pass(ctx);
-    if (ctx->curVertOffset > 0) {
+    if (ctx->curVertOffset > ctx->vertBase) {
         LOG(VKVG_LOG_INFO, "FLUSH UNTIL VX BASE CTX: ctx = %p; vertices = %d; indices = %d\n", ctx, ctx->vertCount,
             ctx->indCount);
         _flush_vertices_caches_until_vertex_base(ctx);
@@ -603,8 +1045,9 @@ void _flush_cmd_buff(VkvgContext ctx) {
 }
 
 // bind correct draw pipeline depending on current OPERATOR
-void _bind_draw_pipeline(VkvgContext ctx) {
-    switch (ctx->curOperator) {
+void _bind_draw_pipeline(VkvgContext ctx) { _bind_operator_pipeline(ctx, ctx->curOperator); }
+void _bind_operator_pipeline(VkvgContext ctx, vkvg_operator_t op) {
+    switch (op) {
     case VKVG_OPERATOR_OVER:
         CmdBindPipeline(ctx->cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, ctx->dev->pipe_OVER);
         break;
@@ -618,17 +1061,120 @@ void _bind_draw_pipeline(VkvgContext ctx) {
         CmdBindPipeline(ctx->cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, ctx->dev->pipe_OVER);
         break;
     }
+    // dynamic for the fringes drawn outside of the stencil fill bits.
+    CmdSetStencilReference(ctx->cmd, VK_STENCIL_FRONT_AND_BACK, STENCIL_FILL_BIT);
+}
+// close the pending index range of the current operator before an operator change, return false if it could
+// not be recorded, the caller has then to emit the draw call.
+bool _add_operator_range(VkvgContext ctx) {
+    uint32_t end   = ctx->indCount - ctx->curIndStart;
+    uint32_t start = ctx->opRangeCount > 0 ? ctx->opRanges[ctx->opRangeCount - 1].end : 0;
+    if (end == start)
+        return true; // nothing drawn with the current operator
+    if (ctx->opRangeCount == ctx->sizeOpRanges) {
+        uint32_t         newSize = ctx->sizeOpRanges ? ctx->sizeOpRanges * 2 : 16;
+        vkvg_op_range_t *tmp     = (vkvg_op_range_t *)realloc(ctx->opRanges, newSize * sizeof(vkvg_op_range_t));
+        if (!tmp)
+            return false;
+        ctx->opRanges     = tmp;
+        ctx->sizeOpRanges = newSize;
+    }
+    ctx->opRanges[ctx->opRangeCount++] = (vkvg_op_range_t){end, ctx->curOperator};
+    return true;
+}
+// emit one draw call per operator for the pending indices, ranges of the same operator are made contiguous in the
+// index cache. Relative order is kept inside each operator group. Indices are relative to the current vertex
+// offset, so moving them is safe.
+void _emit_draw_cmds_by_operator(VkvgContext ctx, uint32_t firstIdx, int32_t vxOffset) {
+    VKVG_IBO_INDEX_TYPE *inds   = &ctx->indexCache[ctx->curIndStart];
+    uint32_t             count  = ctx->indCount - ctx->curIndStart;
+    VKVG_IBO_INDEX_TYPE *sorted = NULL;
+    if (_add_operator_range(ctx))
+        sorted = (VKVG_IBO_INDEX_TYPE *)malloc(count * sizeof(VKVG_IBO_INDEX_TYPE));
+
+    if (!sorted) { // keep submission order, one draw call per range.
+        uint32_t start = 0;
+        for (uint32_t r = 0; r < ctx->opRangeCount; r++) {
+            _bind_operator_pipeline(ctx, ctx->opRanges[r].op);
+            CmdDrawIndexed(ctx->cmd, ctx->opRanges[r].end - start, 1, firstIdx + start, vxOffset, 0);
+            start = ctx->opRanges[r].end;
+        }
+        if (start < count) {
+            _bind_draw_pipeline(ctx);
+            CmdDrawIndexed(ctx->cmd, count - start, 1, firstIdx + start, vxOffset, 0);
+        }
+        _bind_draw_pipeline(ctx);
+        return;
+    }
+
+    uint32_t groupStart[VKVG_OPERATOR_MAX] = {0}, groupCount[VKVG_OPERATOR_MAX] = {0};
+    for (uint32_t r = 0, start = 0; r < ctx->opRangeCount; r++) {
+        groupCount[ctx->opRanges[r].op] += ctx->opRanges[r].end - start;
+        start = ctx->opRanges[r].end;
+    }
+    // the current operator group is drawn last, so that its pipeline stays bound.
+    uint32_t offset = 0;
+    for (uint32_t op = 0; op < VKVG_OPERATOR_MAX; op++) {
+        if (op == ctx->curOperator)
+            continue;
+        groupStart[op] = offset;
+        offset += groupCount[op];
+    }
+    groupStart[ctx->curOperator] = offset;
+
+    uint32_t fill[VKVG_OPERATOR_MAX];
+    memcpy(fill, groupStart, sizeof(fill));
+    for (uint32_t r = 0, start = 0; r < ctx->opRangeCount; r++) {
+        uint32_t len = ctx->opRanges[r].end - start;
+        memcpy(&sorted[fill[ctx->opRanges[r].op]], &inds[start], len * sizeof(VKVG_IBO_INDEX_TYPE));
+        fill[ctx->opRanges[r].op] += len;
+        start = ctx->opRanges[r].end;
+    }
+    memcpy(inds, sorted, count * sizeof(VKVG_IBO_INDEX_TYPE));
+    free(sorted);
+
+    for (uint32_t op = 0; op < VKVG_OPERATOR_MAX; op++) {
+        if (op == ctx->curOperator || groupCount[op] == 0)
+            continue;
+        _bind_operator_pipeline(ctx, (vkvg_operator_t)op);
+        CmdDrawIndexed(ctx->cmd, groupCount[op], 1, firstIdx + groupStart[op], vxOffset, 0);
+    }
+    _bind_draw_pipeline(ctx);
+    if (groupCount[ctx->curOperator] > 0)
+        CmdDrawIndexed(ctx->cmd, groupCount[ctx->curOperator], 1, firstIdx + groupStart[ctx->curOperator], vxOffset,
+                       0);
 }
 #if defined(DEBUG) && defined(VKVG_DBG_UTILS)
 const float DBG_LAB_COLOR_RP[4]  = {0, 0, 1, 1};
 const float DBG_LAB_COLOR_FSQ[4] = {1, 0, 0, 1};
 #endif
 
+// sampled surfaces are kept in shader read layout, transitions have to be recorded outside render pass.
+void _transition_source(VkvgContext ctx, VkvgSurface surf) {
+    LOCK_SURFACE(surf)
+    if (surf->img->layout != VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL)
+        vkh_image_set_layout(ctx->cmd, surf->img, VK_IMAGE_ASPECT_COLOR_BIT, surf->img->layout,
+                             VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                             VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+    UNLOCK_SURFACE(surf)
+}
 void _start_cmd_for_render_pass(VkvgContext ctx) {
     LOG(VKVG_LOG_INFO, "START RENDER PASS: ctx = %p\n", ctx);
+    if (!_acquire_vao_segment(ctx))
+        return;
+    if (ctx->secondary) {
+        // sub contexts record inside the render pass of the parent, which is in charge of the transitions.
+        _begin_sub_cmd(ctx);
+        _begin_render_pass(ctx);
+        return;
+    }
     vkh_cmd_begin(ctx->cmd, VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
 
-    if (ctx->pSurf->img->layout != VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL || ctx->dev->threadAware) {
+    // tracked layout is checked and updated under the surface lock, transitions are only recorded when needed.
+    // The layout is tracked on record, contexts starting before the submission of a transition may be submitted
+    // first, so they record it as well.
+    LOCK_SURFACE(ctx->pSurf)
+    if (ctx->pSurf->img->layout != VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL || ctx->pSurf->pendingTransitions > 0) {
         VkhImage imgMs = ctx->pSurf->imgMS;
         if (imgMs != NULL)
             vkh_image_set_layout(ctx->cmd, imgMs, VK_IMAGE_ASPECT_COLOR_BIT, VK_IMAGE_LAYOUT_UNDEFINED,
@@ -639,27 +1185,59 @@ void _start_cmd_for_render_pass(VkvgContext ctx) {
         vkh_image_set_layout(ctx->cmd, ctx->pSurf->img, VK_IMAGE_ASPECT_COLOR_BIT, VK_IMAGE_LAYOUT_UNDEFINED,
                              VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
                              VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
-        vkh_image_set_layout(ctx->cmd, ctx->pSurf->stencil, ctx->dev->stencilAspectFlag,
-                             VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
-                             VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT);
+        if (ctx->pSurf->stencil != NULL)
+            vkh_image_set_layout(ctx->cmd, ctx->pSurf->stencil, ctx->dev->stencilAspectFlag,
+                                 VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+                                 VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT);
+        if (!ctx->pendingTransition) {
+            ctx->pendingTransition = true;
+            ctx->pSurf->pendingTransitions++;
+        }
     }
-
+    UNLOCK_SURFACE(ctx->pSurf)
+    // new scratch stencil, it is cleared by the first render pass of the context.
+    if (ctx->stencil->layout == VK_IMAGE_LAYOUT_UNDEFINED)
+        vkh_image_set_layout(ctx->cmd, ctx->stencil, ctx->dev->stencilAspectFlag, VK_IMAGE_LAYOUT_UNDEFINED,
+                             VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                             VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT);
+    // surface source set while no cmd was started
+    if (ctx->pattern && ctx->pattern->type == VKVG_PATTERN_TYPE_SURFACE && !ctx->srcFallback)
+        _transition_source(ctx, (VkvgSurface)ctx->pattern->data);
+
+    _begin_render_pass(ctx);
+}
+void _begin_sub_cmd(VkvgContext ctx) {
+    VkCommandBufferInheritanceInfo inheritanceInfo = {.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO,
+                                                      .renderPass  = ctx->dev->renderPass,
+                                                      .subpass     = 0,
+                                                      .framebuffer = ctx->renderPassBeginInfo.framebuffer};
+    VkCommandBufferBeginInfo       beginInfo       = {.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+                                                      .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT |
+                                                               VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT,
+                                                      .pInheritanceInfo = &inheritanceInfo};
+    VK_CHECK_RESULT(vkBeginCommandBuffer(ctx->cmd, &beginInfo));
+}
+// begin render pass in an already started cmd and restore its states, sub contexts only restore states.
+void _begin_render_pass(VkvgContext ctx) {
 #if defined(DEBUG) && defined(VKVG_DBG_UTILS)
     vkh_cmd_label_start(ctx->cmd, "ctx render pass", DBG_LAB_COLOR_RP);
 #endif
 
-    CmdBeginRenderPass(ctx->cmd, &ctx->renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+    if (!ctx->secondary)
+        CmdBeginRenderPass(ctx->cmd, &ctx->renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
     VkViewport viewport = {0, 0, (float)ctx->pSurf->width, (float)ctx->pSurf->height, 0, 1.f};
     CmdSetViewport(ctx->cmd, 0, 1, &viewport);
 
     CmdSetScissor(ctx->cmd, 0, 1, &ctx->bounds);
 
-    VkDescriptorSet dss[] = {ctx->dsFont, ctx->dsSrc, ctx->dsGrad};
-    CmdBindDescriptorSets(ctx->cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, ctx->dev->pipelineLayout, 0, 3, dss, 0, NULL);
+    VkDescriptorSet dss[] = {ctx->dsFont, ctx->dsSrcCur, ctx->dsGrad};
+    CmdBindDescriptorSets(ctx->cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, ctx->dev->pipelineLayout, 0, 3, dss, 1,
+                          &ctx->gradOffset);
 
-    VkDeviceSize offsets[1] = {0};
-    CmdBindVertexBuffers(ctx->cmd, 0, 1, &ctx->vertices.buffer, offsets);
-    CmdBindIndexBuffer(ctx->cmd, ctx->indices.buffer, 0, VKVG_VK_INDEX_TYPE);
+    vkvg_vao_segment_t *seg        = &ctx->vaoRing[ctx->vaoRingIdx];
+    VkDeviceSize        offsets[1] = {seg->vertices.offset};
+    CmdBindVertexBuffers(ctx->cmd, 0, 1, &seg->vertices.block->buff.buffer, offsets);
+    CmdBindIndexBuffer(ctx->cmd, seg->indices.block->buff.buffer, seg->indices.offset, VKVG_VK_INDEX_TYPE);
 
     _update_push_constants(ctx);
 
@@ -667,94 +1245,175 @@ void _start_cmd_for_render_pass(VkvgContext ctx) {
     CmdSetStencilCompareMask(ctx->cmd, VK_STENCIL_FRONT_AND_BACK, STENCIL_CLIP_BIT);
     ctx->cmdStarted = true;
 }
+// move vertices emitted since the last matrix change or draw call to device space, vertices below the current
+// vertex offset are either drawn or not part of the next draw call.
+void _transform_pending_vertices(VkvgContext ctx) {
+    uint32_t first = MAX(ctx->xformVertBase, ctx->curVertOffset);
+    if (ctx->transformBatching && first < ctx->vertCount) {
+        const vkvg_matrix_t *m = &ctx->pushConsts.mat;
+        const float          xx = m->xx, yx = m->yx, xy = m->xy, yy = m->yy, x0 = m->x0, y0 = m->y0;
+        Vertex              *v  = &ctx->vertexCache[first];
+        // plain loop with the matrix in locals, vectorized by the compiler.
+        for (uint32_t i = 0; i < ctx->vertCount - first; i++) {
+            float x  = v[i].pos.x;
+            float y  = v[i].pos.y;
+            v[i].pos = (vec2){xx * x + xy * y + x0, yx * x + yy * y + y0};
+        }
+    }
+    ctx->xformVertBase = ctx->vertCount;
+}
+// the push constant matrix is only used by the shader when transform batching is off, the inverse matrix
+// is still needed for surface sources.
+void _prepare_matrix_change(VkvgContext ctx) {
+    if (ctx->transformBatching && (ctx->pushConsts.fsq_patternType & SRCTYPE_MASK) != VKVG_PATTERN_TYPE_SURFACE)
+        _transform_pending_vertices(ctx);
+    else
+        _emit_draw_cmd_undrawn_vertices(ctx);
+}
 // compute inverse mat used in shader when context matrix has changed
 // then trigger push constants command
 void _set_mat_inv_and_vkCmdPush(VkvgContext ctx) {
     ctx->pushConsts.matInv = ctx->pushConsts.mat;
     vkvg_matrix_invert(&ctx->pushConsts.matInv);
     ctx->pushCstDirty = true;
+    ctx->matScale     = 0;
+}
+// greatest scale of the current matrix, used to convert the device space tolerance to user space.
+float _get_matrix_scale(VkvgContext ctx) {
+    if (ctx->matScale == 0) {
+        float sx = 1, sy = 1;
+        vkvg_matrix_get_scale(&ctx->pushConsts.mat, &sx, &sy);
+        ctx->matScale = fabsf(fmaxf(sx, sy));
+    }
+    return ctx->matScale;
 }
 void _update_push_constants(VkvgContext ctx) {
-    CmdPushConstants(ctx->cmd, ctx->dev->pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(push_constants),
-                     &ctx->pushConsts);
+    if (ctx->transformBatching) {
+        push_constants pc = ctx->pushConsts;
+        pc.mat            = VKVG_IDENTITY_MATRIX;
+        CmdPushConstants(ctx->cmd, ctx->dev->pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(push_constants),
+                         &pc);
+    } else
+        CmdPushConstants(ctx->cmd, ctx->dev->pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(push_constants),
+                         &ctx->pushConsts);
     ctx->pushCstDirty = false;
 }
+// single source descriptor path used when no descriptor set could be allocated for the source, dsSrc is
+// rewritten once the context submissions are completed.
+void _set_source_fallback(VkvgContext ctx, VkvgPattern pat) {
+    if (ctx->secondary) {
+        LOG(VKVG_LOG_ERR, "CTX: sub context %p cannot use the single source descriptor path\n", ctx);
+        ctx->status = VKVG_STATUS_INVALID_STATUS;
+        return;
+    }
+    VkvgSurface surf = (VkvgSurface)pat->data;
+
+    // flush ctx in two steps to add the src transitioning in the cmd buff
+    if (ctx->cmdStarted) { // transition of img without appropriate dependencies in subpass must be done outside
+                           // renderpass.
+        _end_render_pass(ctx);
+        _flush_vertices_caches(ctx);
+    } else {
+        vkh_cmd_begin(ctx->cmd, VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+        ctx->cmdStarted = true;
+    }
+
+    // transition source surface for sampling
+    vkh_image_set_layout(ctx->cmd, surf->img, VK_IMAGE_ASPECT_COLOR_BIT, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                         VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+
+    vkh_cmd_end(ctx->cmd);
+    _wait_and_submit_cmd(ctx);
+    if (!_wait_ctx_flush_end(ctx))
+        return;
+
+    VkSamplerAddressMode addrMode = 0;
+    VkFilter             filter   = VK_FILTER_NEAREST;
+    switch (pat->extend) {
+    case VKVG_EXTEND_NONE:
+        addrMode = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_BORDER;
+        break;
+    case VKVG_EXTEND_PAD:
+        addrMode = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        break;
+    case VKVG_EXTEND_REPEAT:
+        addrMode = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+        break;
+    case VKVG_EXTEND_REFLECT:
+        addrMode = VK_SAMPLER_ADDRESS_MODE_MIRRORED_REPEAT;
+        break;
+    }
+    switch (pat->filter) {
+    case VKVG_FILTER_BILINEAR:
+    case VKVG_FILTER_BEST:
+        filter = VK_FILTER_LINEAR;
+        break;
+    default:
+        filter = VK_FILTER_NEAREST;
+        break;
+    }
+    vkh_image_create_sampler(surf->img, filter, filter, VK_SAMPLER_MIPMAP_MODE_NEAREST, addrMode);
+
+    _update_descriptor_set(ctx, surf->img, ctx->dsSrc);
+    ctx->dsSrcCur    = ctx->dsSrc;
+    ctx->srcFallback = true;
+}
 void _update_cur_pattern(VkvgContext ctx, VkvgPattern pat) {
     VkvgPattern lastPat = ctx->pattern;
-    ctx->pattern        = pat;
+
+    if (ctx->srcFallback) {
+        // unbind current source surface by replacing it with empty texture once no more in use, the submission
+        // still synchronizes with the last pattern surface.
+        _flush_cmd_buff(ctx);
+        if (!_wait_ctx_flush_end(ctx)) {
+            ctx->pattern = pat;
+            return;
+        }
+        _update_descriptor_set(ctx, ctx->dev->emptyImg, ctx->dsSrc);
+        ctx->srcFallback = false;
+    }
+    ctx->pattern = pat;
 
     uint32_t newPatternType = VKVG_PATTERN_TYPE_SOLID;
 
     LOG(VKVG_LOG_INFO, "CTX: _update_cur_pattern: %p -> %p\n", lastPat, pat);
 
     if (pat == NULL) {       // solid color
-        if (lastPat == NULL) // solid
-            return;          // solid to solid transition, no extra action requested
+        if (lastPat == NULL) { // solid
+            _update_vertex_color(ctx);
+            return; // solid to solid transition, no extra action requested
+        }
     } else
         newPatternType = pat->type;
 
     switch (newPatternType) {
     case VKVG_PATTERN_TYPE_SOLID:
-        _flush_cmd_buff(ctx);
-        if (!_wait_ctx_flush_end(ctx))
-            return;
-        if (lastPat->type ==
-            VKVG_PATTERN_TYPE_SURFACE) // unbind current source surface by replacing it with empty texture
-            _update_descriptor_set(ctx, ctx->dev->emptyImg, ctx->dsSrc);
+        // only the pattern type push constant and the source binding change.
+        _emit_draw_cmd_undrawn_vertices(ctx);
+        if (lastPat && lastPat->type == VKVG_PATTERN_TYPE_SURFACE)
+            _bind_source_desc_set(ctx, ctx->dsSrc);
         break;
     case VKVG_PATTERN_TYPE_SURFACE: {
         _emit_draw_cmd_undrawn_vertices(ctx);
 
-        VkvgSurface surf = (VkvgSurface)pat->data;
-
-        // flush ctx in two steps to add the src transitioning in the cmd buff
-        if (ctx->cmdStarted) { // transition of img without appropriate dependencies in subpass must be done outside
-                               // renderpass.
-            _end_render_pass(ctx);
-            _flush_vertices_caches(ctx);
-        } else {
-            vkh_cmd_begin(ctx->cmd, VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
-            ctx->cmdStarted = true;
-        }
-
-        // transition source surface for sampling
-        vkh_image_set_layout(ctx->cmd, surf->img, VK_IMAGE_ASPECT_COLOR_BIT, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-                             VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
-                             VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
-
-        vkh_cmd_end(ctx->cmd);
-        _wait_and_submit_cmd(ctx);
-        if (!_wait_ctx_flush_end(ctx))
-            return;
-
-        VkSamplerAddressMode addrMode = 0;
-        VkFilter             filter   = VK_FILTER_NEAREST;
-        switch (pat->extend) {
-        case VKVG_EXTEND_NONE:
-            addrMode = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_BORDER;
-            break;
-        case VKVG_EXTEND_PAD:
-            addrMode = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
-            break;
-        case VKVG_EXTEND_REPEAT:
-            addrMode = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-            break;
-        case VKVG_EXTEND_REFLECT:
-            addrMode = VK_SAMPLER_ADDRESS_MODE_MIRRORED_REPEAT;
-            break;
-        }
-        switch (pat->filter) {
-        case VKVG_FILTER_BILINEAR:
-        case VKVG_FILTER_BEST:
-            filter = VK_FILTER_LINEAR;
-            break;
-        default:
-            filter = VK_FILTER_NEAREST;
-            break;
-        }
-        vkh_image_create_sampler(surf->img, filter, filter, VK_SAMPLER_MIPMAP_MODE_NEAREST, addrMode);
-
-        _update_descriptor_set(ctx, surf->img, ctx->dsSrc);
+        VkvgSurface     surf = (VkvgSurface)pat->data;
+        VkDescriptorSet ds =
+            _get_source_desc_set(ctx, surf, _device_get_source_sampler(ctx->dev, pat->extend, pat->filter));
+
+        if (ds != VK_NULL_HANDLE) {
+            if (ctx->cmdStarted && !ctx->secondary &&
+                surf->img->layout != VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) {
+                // restart the render pass in the same cmd around the transition, no submission is needed.
+                _end_render_pass(ctx);
+                _transition_source(ctx, surf);
+                ctx->dsSrcCur = ds;
+                _begin_render_pass(ctx);
+            } else
+                // transition is done on render pass start if cmd is not started, or by the parent for sub contexts.
+                _bind_source_desc_set(ctx, ds);
+        } else
+            _set_source_fallback(ctx, pat);
 
         ctx->pushConsts.source.width  = (float)surf->width;
         ctx->pushConsts.source.height = (float)surf->height;
@@ -773,12 +1432,17 @@ void _update_cur_pattern(VkvgContext ctx, VkvgPattern pat) {
     }
     case VKVG_PATTERN_TYPE_LINEAR:
     case VKVG_PATTERN_TYPE_RADIAL:
-        _flush_cmd_buff(ctx);
-        if (!_wait_ctx_flush_end(ctx))
-            return;
+        // gradient records already used may still be read by pending commands, wait only when all of them are.
+        if (ctx->gradCount == VKVG_GRADIENT_RECORDS) {
+            _flush_cmd_buff(ctx);
+            if (!_wait_ctx_flush_end(ctx))
+                return;
+            ctx->gradCount = 0;
+        } else
+            _emit_draw_cmd_undrawn_vertices(ctx);
 
         if (lastPat && lastPat->type == VKVG_PATTERN_TYPE_SURFACE)
-            _update_descriptor_set(ctx, ctx->dev->emptyImg, ctx->dsSrc);
+            _bind_source_desc_set(ctx, ctx->dsSrc);
 
         vec4 bounds            = {{(float)ctx->pSurf->width},
                                   {(float)ctx->pSurf->height},
@@ -821,15 +1485,44 @@ void _update_cur_pattern(VkvgContext ctx, VkvgPattern pat) {
             vkvg_matrix_transform_distance(&ctx->pushConsts.mat, &grad.cp[1].z, &grad.cp[0].w);
         }
 
-        memcpy(vkh_buffer_get_mapped_pointer(&ctx->uboGrad), &grad, sizeof(vkvg_gradient_t));
-        vkh_buffer_flush(&ctx->uboGrad);
+        ctx->gradOffset = ctx->gradCount++ * ctx->dev->gradStride;
+        memcpy((char *)_arena_get_mapped_pointer(&ctx->uboGrad) + ctx->gradOffset, &grad, sizeof(vkvg_gradient_t));
+        _arena_flush(&ctx->uboGrad);
+        // following draws of the current cmd read the new record.
+        if (ctx->cmdStarted)
+            CmdBindDescriptorSets(ctx->cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, ctx->dev->pipelineLayout, 2, 1,
+                                  &ctx->dsGrad, 1, &ctx->gradOffset);
         break;
     }
     ctx->pushConsts.fsq_patternType = (ctx->pushConsts.fsq_patternType & FULLSCREEN_BIT) + newPatternType;
     ctx->pushCstDirty               = true;
+    _update_vertex_color(ctx);
     if (lastPat)
         vkvg_pattern_destroy(lastPat);
 }
+// opacity is carried by the vertices so that opacity changes do not end the current draw call: solid colors are
+// faded like the fragment shader did, other sources have the opacity alone in the vertex alpha.
+void _update_vertex_color(VkvgContext ctx) {
+    float opacity = ctx->pushConsts.opacity;
+    if ((ctx->pushConsts.fsq_patternType & SRCTYPE_MASK) != VKVG_PATTERN_TYPE_SOLID) {
+        ctx->vxColor = (uint32_t)(opacity * 255.0f + 0.5f) << 24;
+        return;
+    }
+    ctx->vxColor = opacity >= 1.0f ? ctx->curColor : _fade_vertex_color(ctx->curColor, opacity);
+}
+// premultiplied colors are faded on all channels, straight ones on alpha only.
+uint32_t _fade_vertex_color(uint32_t color, float factor) {
+#ifdef VKVG_PREMULT_ALPHA
+    uint32_t firstChannel = 0;
+#else
+    uint32_t firstChannel = 3;
+#endif
+    for (uint32_t c = firstChannel; c < 4; c++) {
+        uint32_t v = (uint32_t)((float)((color >> (c * 8)) & 0xFF) * factor + 0.5f);
+        color      = (color & ~(0xFFu << (c * 8))) | (v << (c * 8));
+    }
+    return color;
+}
 void _update_descriptor_set(VkvgContext ctx, VkhImage img, VkDescriptorSet ds) {
     VkDescriptorImageInfo descSrcTex         = vkh_image_get_descriptor(img, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
     VkWriteDescriptorSet  writeDescriptorSet = {.sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
@@ -842,15 +1535,194 @@ void _update_descriptor_set(VkvgContext ctx, VkhImage img, VkDescriptorSet ds) {
 }
 
 void _update_gradient_desc_set(VkvgContext ctx) {
-    VkDescriptorBufferInfo dbi                = {ctx->uboGrad.buffer, 0, VK_WHOLE_SIZE};
+    if (!ctx->uboGrad.block)
+        return;
+    VkDescriptorBufferInfo dbi = {ctx->uboGrad.block->buff.buffer, ctx->uboGrad.offset, sizeof(vkvg_gradient_t)};
     VkWriteDescriptorSet   writeDescriptorSet = {.sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
                                                  .dstSet          = ctx->dsGrad,
                                                  .dstBinding      = 0,
                                                  .descriptorCount = 1,
-                                                 .descriptorType  = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+                                                 .descriptorType  = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,
                                                  .pBufferInfo     = &dbi};
     vkUpdateDescriptorSets(ctx->dev->vkDev, 1, &writeDescriptorSet, 0, NULL);
 }
+void _bind_source_desc_set(VkvgContext ctx, VkDescriptorSet ds) {
+    ctx->dsSrcCur = ds;
+    if (ctx->cmdStarted)
+        CmdBindDescriptorSets(ctx->cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, ctx->dev->pipelineLayout, 1, 1, &ds, 0, NULL);
+}
+// get the descriptor set of a surface source, writing a new one if not yet cached. When the cache is full, the
+// context submissions are waited for before reusing its descriptors. Return VK_NULL_HANDLE on failure.
+// Sources are bound per descriptor set rather than indexed in an array: writing a new element of a set bound by
+// a recording or pending cmd requires the update after bind feature of descriptor indexing, which the device is
+// not required to have. Switching between cached sets costs a bind, where an index would cost a push constant.
+VkDescriptorSet _get_source_desc_set(VkvgContext ctx, VkvgSurface surf, VkSampler sampler) {
+    vkvg_source_desc_t *src = NULL;
+    for (uint32_t i = 0; i < ctx->srcCacheCount; i++) {
+        if (ctx->srcCache[i].surf == NULL) {
+            if (src == NULL)
+                src = &ctx->srcCache[i];
+        } else if (ctx->srcCache[i].surf == surf && ctx->srcCache[i].sampler == sampler) {
+            ctx->srcCache[i].inCmd = true;
+            return ctx->srcCache[i].ds;
+        }
+    }
+    if (src == NULL) {
+        if (ctx->srcCacheCount == VKVG_SOURCE_CACHE_SIZE) {
+            _flush_cmd_buff(ctx);
+            if (!_wait_ctx_flush_end(ctx))
+                return VK_NULL_HANDLE;
+            // nothing is recorded or pending anymore, the current source is kept while it is bound.
+            for (uint32_t i = 0; i < ctx->srcCacheCount; i++)
+                ctx->srcCache[i].inCmd = ctx->srcCache[i].ds == ctx->dsSrcCur;
+            _release_completed_sources(ctx, UINT64_MAX);
+            for (uint32_t i = 0; i < ctx->srcCacheCount && src == NULL; i++) {
+                if (ctx->srcCache[i].surf == NULL)
+                    src = &ctx->srcCache[i];
+            }
+        }
+        if (src == NULL)
+            src = &ctx->srcCache[ctx->srcCacheCount];
+    }
+    if (src->ds == VK_NULL_HANDLE) {
+        VkDescriptorSetAllocateInfo descriptorSetAllocateInfo = {.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+                                                                 .descriptorPool     = ctx->descriptorPool,
+                                                                 .descriptorSetCount = 1,
+                                                                 .pSetLayouts        = &ctx->dev->dslSrc};
+        if (vkAllocateDescriptorSets(ctx->dev->vkDev, &descriptorSetAllocateInfo, &src->ds) != VK_SUCCESS) {
+            LOG(VKVG_LOG_ERR, "CTX: source descriptor allocation failed, using single descriptor path\n");
+            src->ds = VK_NULL_HANDLE;
+            return VK_NULL_HANDLE;
+        }
+    }
+    VkDescriptorImageInfo descSrcTex         = {sampler, vkh_image_get_view(surf->img),
+                                                VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL};
+    VkWriteDescriptorSet  writeDescriptorSet = {.sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+                                                .dstSet          = src->ds,
+                                                .dstBinding      = 0,
+                                                .descriptorCount = 1,
+                                                .descriptorType  = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+                                                .pImageInfo      = &descSrcTex};
+    vkUpdateDescriptorSets(ctx->dev->vkDev, 1, &writeDescriptorSet, 0, NULL);
+
+    src->surf    = vkvg_surface_reference(surf);
+    src->sampler = sampler;
+    src->inCmd   = true;
+    src->ticket  = 0;
+    if (src == &ctx->srcCache[ctx->srcCacheCount])
+        ctx->srcCacheCount++;
+    return src->ds;
+}
+// give back the scratch stencil of the context to the device, the context must have no pending submission.
+void _release_scratch_stencil(VkvgContext ctx) {
+    if (ctx->stencil == NULL || ctx->stencil == ctx->pSurf->stencil)
+        return;
+    vkDestroyFramebuffer(ctx->dev->vkDev, ctx->renderPassBeginInfo.framebuffer, NULL);
+    ctx->renderPassBeginInfo.framebuffer = VK_NULL_HANDLE;
+    _device_release_scratch_stencil(ctx->dev, ctx->stencil);
+    ctx->stencil = NULL;
+}
+// release cached sources, their descriptors must not be in use by pending commands.
+void _reset_source_cache(VkvgContext ctx) {
+    for (uint32_t i = 0; i < ctx->srcCacheCount; i++) {
+        if (ctx->srcCache[i].surf == NULL)
+            continue;
+        vkvg_surface_destroy(ctx->srcCache[i].surf);
+        ctx->srcCache[i].surf  = NULL;
+        ctx->srcCache[i].inCmd = false;
+    }
+    ctx->srcCacheCount = 0;
+}
+// release the cached sources whose last submission is done, ticket being the last one known to be completed.
+// Sources bound since the last submission, including the current one, are kept.
+void _release_completed_sources(VkvgContext ctx, uint64_t ticket) {
+    for (uint32_t i = 0; i < ctx->srcCacheCount; i++) {
+        vkvg_source_desc_t *src = &ctx->srcCache[i];
+        if (src->surf == NULL || src->inCmd || src->ticket > ticket)
+            continue;
+        vkvg_surface_destroy(src->surf);
+        src->surf = NULL;
+    }
+    while (ctx->srcCacheCount > 0 && ctx->srcCache[ctx->srcCacheCount - 1].surf == NULL)
+        ctx->srcCacheCount--;
+}
+// execute the segments handed over by sub in recording order in a dedicated render pass of ctx cmd.
+void _execute_sub_context(VkvgContext ctx, VkvgContext sub) {
+    _flush_cmd_buff(sub); // hand over the commands still recorded
+    if (sub->status)
+        return;
+
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < sub->vaoRingDepth; i++) {
+        if (sub->vaoRing[i].subSeq > 0)
+            count++;
+    }
+    if (count == 0)
+        return;
+
+    if (ctx->sizeSubFences < ctx->subFenceCount + count) {
+        VkFence *tmp = (VkFence *)realloc(ctx->subFences, (ctx->subFenceCount + count) * sizeof(VkFence));
+        if (tmp == NULL) {
+            ctx->status = VKVG_STATUS_NO_MEMORY;
+            return;
+        }
+        ctx->subFences     = tmp;
+        ctx->sizeSubFences = ctx->subFenceCount + count;
+    }
+
+    // the sub context sources are held by this context too, so that its submission waits on their timelines.
+    for (uint32_t i = 0; i < sub->srcCacheCount; i++) {
+        if (sub->srcCache[i].surf)
+            _get_source_desc_set(ctx, sub->srcCache[i].surf, sub->srcCache[i].sampler);
+    }
+    if (ctx->status)
+        return;
+
+    _emit_draw_cmd_undrawn_vertices(ctx);
+    if (!ctx->cmdStarted) // start cmd and run pending clear load ops
+        _start_cmd_for_render_pass(ctx);
+    _end_render_pass(ctx);
+
+    for (uint32_t i = 0; i < sub->srcCacheCount; i++) {
+        if (sub->srcCache[i].surf)
+            _transition_source(ctx, sub->srcCache[i].surf);
+    }
+
+    CmdBeginRenderPass(ctx->cmd, &ctx->renderPassBeginInfo, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+    // segments are few, they are selected and executed one by one by increasing recording order.
+    for (uint32_t seq = 0;;) {
+        vkvg_vao_segment_t *next = NULL;
+        for (uint32_t i = 0; i < sub->vaoRingDepth; i++) {
+            vkvg_vao_segment_t *seg = &sub->vaoRing[i];
+            if (seg->subSeq > seq && (next == NULL || seg->subSeq < next->subSeq))
+                next = seg;
+        }
+        if (next == NULL)
+            break;
+        seq          = next->subSeq;
+        next->subSeq = 0;
+        CmdExecuteCommands(ctx->cmd, 1, &next->cmd);
+        ctx->subFences[ctx->subFenceCount++] = next->fence;
+    }
+    CmdEndRenderPass(ctx->cmd);
+
+    _begin_render_pass(ctx);
+}
+// wait for the sub context segments executed by the parent before releasing them, commands never executed are
+// dropped.
+void _wait_sub_ctx_executed(VkvgContext ctx) {
+    bool completed = true;
+    for (uint32_t i = 0; i < ctx->vaoRingDepth; i++) {
+        vkvg_vao_segment_t *seg = &ctx->vaoRing[i];
+        if (seg->subSeq == 0 && completed)
+            completed = WaitForFences(ctx->dev->vkDev, 1, &seg->fence, VK_TRUE, VKVG_FENCE_TIMEOUT) == VK_SUCCESS;
+        seg->subSeq = 0;
+    }
+    if (!completed) {
+        LOG(VKVG_LOG_ERR, "CTX: sub context %p executed commands are not completed\n", ctx);
+        ctx->status = VKVG_STATUS_TIMEOUT;
+    }
+}
 /*
  * Reset currently bound descriptor which image could be destroyed
  */
@@ -868,10 +1740,11 @@ void _update_gradient_desc_set(VkvgContext ctx) {
 
 void _createDescriptorPool(VkvgContext ctx) {
     VkvgDevice                 dev                      = ctx->dev;
-    const VkDescriptorPoolSize descriptorPoolSize[]     = {{VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 2},
-                                                           {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1}};
+    const VkDescriptorPoolSize descriptorPoolSize[]     = {
+        {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 2 + VKVG_SOURCE_CACHE_SIZE},
+        {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1}};
     VkDescriptorPoolCreateInfo descriptorPoolCreateInfo = {.sType   = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
-                                                           .maxSets = 3,
+                                                           .maxSets = 3 + VKVG_SOURCE_CACHE_SIZE,
                                                            .flags   = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT,
                                                            .poolSizeCount = 2,
                                                            .pPoolSizes    = descriptorPoolSize};
@@ -892,24 +1765,27 @@ void _init_descriptor_sets(VkvgContext ctx) {
 void _release_context_ressources(VkvgContext ctx) {
     VkDevice dev = ctx->dev->vkDev;
 
-#ifndef VKVG_ENABLE_VK_TIMELINE_SEMAPHORE
-    vkDestroyFence(dev, ctx->flushFence, NULL);
-#endif
-
-    vkFreeCommandBuffers(dev, ctx->cmdPool, 2, ctx->cmdBuffers);
+    _destroy_vao_ring(ctx);
     vkDestroyCommandPool(dev, ctx->cmdPool, NULL);
 
     VkDescriptorSet dss[] = {ctx->dsFont, ctx->dsSrc, ctx->dsGrad};
     vkFreeDescriptorSets(dev, ctx->descriptorPool, 3, dss);
+    for (uint32_t i = 0; i < VKVG_SOURCE_CACHE_SIZE && ctx->srcCache[i].ds; i++)
+        vkFreeDescriptorSets(dev, ctx->descriptorPool, 1, &ctx->srcCache[i].ds);
 
     vkDestroyDescriptorPool(dev, ctx->descriptorPool, NULL);
 
-    vkh_buffer_reset(&ctx->uboGrad);
-    vkh_buffer_reset(&ctx->indices);
-    vkh_buffer_reset(&ctx->vertices);
+    _arena_free(ctx->dev, &ctx->uboGrad);
+    free(ctx->subFences);
+    free(ctx->opRanges);
 
+#ifdef VKVG_VAO_ZERO_COPY
+    free(ctx->hostVertexCache);
+    free(ctx->hostIndexCache);
+#else
     free(ctx->vertexCache);
     free(ctx->indexCache);
+#endif
 
     vkh_image_destroy(ctx->fontCacheImg);
     // TODO:check this for source counter
@@ -917,12 +1793,74 @@ void _release_context_ressources(VkvgContext ctx) {
 
     free(ctx->pathes);
     free(ctx->points);
+    _tess_arena_release(ctx);
 
     free(ctx);
 }
+// parts of the stroke outline, left is on the side of the perpendicular of the stroke direction.
+enum { OUTLINE_LEFT, OUTLINE_RIGHT, OUTLINE_START_CAP, OUTLINE_END_CAP };
+typedef struct {
+    vec2     pos;
+    uint32_t part;
+} outline_point_t;
+// record stroke outline for the analytic antialiasing fringe, added once the outline is closed.
+static void _add_outline_point(VkvgContext ctx, stroke_context_t *str, uint32_t part, vec2 pos) {
+    if (!ctx->dev->analyticAA)
+        return;
+    outline_point_t *pts =
+        (outline_point_t *)_tess_arena_reserve(ctx, (str->outlineCount + 1) * sizeof(outline_point_t));
+    if (pts)
+        pts[str->outlineCount++] = (outline_point_t){pos, part};
+}
+// closed strokes have an outer and an inner outline, open ones or dashes a single ring going through their caps.
+void _add_stroke_fringe(VkvgContext ctx, stroke_context_t *str, bool closed) {
+    uint32_t count    = str->outlineCount;
+    str->outlineCount = 0;
+    if (count == 0)
+        return;
+    size_t           size = count * (sizeof(outline_point_t) + 2 * sizeof(vec2));
+    outline_point_t *pts  = (outline_point_t *)_tess_arena_reserve(ctx, size);
+    if (!pts)
+        return;
+    vec2    *ring = (vec2 *)(pts + count);
+    uint32_t n    = 0;
+    if (closed) {
+        // the outline enclosing the smallest area is the inner one.
+        vec2    *right = ring + count;
+        uint32_t nr    = 0;
+        float    la = 0, ra = 0;
+        for (uint32_t i = 0; i < count; i++) {
+            if (pts[i].part == OUTLINE_LEFT)
+                ring[n++] = pts[i].pos;
+            else if (pts[i].part == OUTLINE_RIGHT)
+                right[nr++] = pts[i].pos;
+        }
+        for (uint32_t i = 0; i < n; i++)
+            la += vec2_zcross(ring[i], ring[(i + 1) % n]);
+        for (uint32_t i = 0; i < nr; i++)
+            ra += vec2_zcross(right[i], right[(i + 1) % nr]);
+        _add_edge_fringe(ctx, ring, n, fabsf(la) < fabsf(ra));
+        _add_edge_fringe(ctx, right, nr, fabsf(ra) <= fabsf(la));
+        return;
+    }
+    // both caps go from the right side to the left one.
+    for (uint32_t i = 0; i < count; i++)
+        if (pts[i].part == OUTLINE_START_CAP)
+            ring[n++] = pts[i].pos;
+    for (uint32_t i = 0; i < count; i++)
+        if (pts[i].part == OUTLINE_LEFT)
+            ring[n++] = pts[i].pos;
+    for (uint32_t i = count; i-- > 0;)
+        if (pts[i].part == OUTLINE_END_CAP)
+            ring[n++] = pts[i].pos;
+    for (uint32_t i = count; i-- > 0;)
+        if (pts[i].part == OUTLINE_RIGHT)
+            ring[n++] = pts[i].pos;
+    _add_edge_fringe(ctx, ring, n, false);
+}
 // populate vertice buff for stroke
 bool _build_vb_step(VkvgContext ctx, stroke_context_t *str, bool isCurve) {
-    Vertex v         = {{0}, ctx->curColor, {0, 0, -1}};
+    Vertex v         = {{0}, ctx->vxColor, VKVG_VERTEX_NO_UV};
     vec2   p0        = ctx->points[str->cp];
     vec2   v0        = vec2_sub(p0, ctx->points[str->iL]);
     vec2   v1        = vec2_sub(ctx->points[str->iR], p0);
@@ -948,8 +1886,10 @@ bool _build_vb_step(VkvgContext ctx, stroke_context_t *str, bool isCurve) {
 
         v.pos = vec2_add(p0, vPerp);
         _add_vertex(ctx, v);
+        _add_outline_point(ctx, str, OUTLINE_LEFT, v.pos);
         v.pos = vec2_sub(p0, vPerp);
         _add_vertex(ctx, v);
+        _add_outline_point(ctx, str, OUTLINE_RIGHT, v.pos);
 
         _add_triangle_indices(ctx, idx, idx + 1, idx + 2);
         _add_triangle_indices(ctx, idx, idx + 2, idx + 3);
@@ -1022,13 +1962,16 @@ bool _build_vb_step(VkvgContext ctx, stroke_context_t *str, bool isCurve) {
             if (det < 0) {
                 v.pos = rlh_inside_pos;
                 _add_vertex(ctx, v);
+                _add_outline_point(ctx, str, OUTLINE_LEFT, v.pos);
 
                 vec2 p = vec2_sub(p0, bisec);
 
                 v.pos = vec2_sub(p, bisecPerp);
                 _add_vertex(ctx, v);
+                _add_outline_point(ctx, str, OUTLINE_RIGHT, v.pos);
                 v.pos = vec2_add(p, bisecPerp);
                 _add_vertex(ctx, v);
+                _add_outline_point(ctx, str, OUTLINE_RIGHT, v.pos);
 
                 _add_triangle_indices(ctx, idx, idx + 2, idx + 1);
                 _add_triangle_indices(ctx, idx + 2, idx + 4, idx);
@@ -1038,12 +1981,15 @@ bool _build_vb_step(VkvgContext ctx, stroke_context_t *str, bool isCurve) {
                 vec2 p = vec2_add(p0, bisec);
                 v.pos  = vec2_sub(p, bisecPerp);
                 _add_vertex(ctx, v);
+                _add_outline_point(ctx, str, OUTLINE_LEFT, v.pos);
 
                 v.pos = rlh_inside_pos;
                 _add_vertex(ctx, v);
+                _add_outline_point(ctx, str, OUTLINE_RIGHT, v.pos);
 
                 v.pos = vec2_add(p, bisecPerp);
                 _add_vertex(ctx, v);
+                _add_outline_point(ctx, str, OUTLINE_LEFT, v.pos);
 
                 _add_triangle_indices(ctx, idx, idx + 2, idx + 1);
                 _add_triangle_indices(ctx, idx + 2, idx + 3, idx + 1);
@@ -1055,13 +2001,17 @@ bool _build_vb_step(VkvgContext ctx, stroke_context_t *str, bool isCurve) {
             if (det < 0) {
                 v.pos = rlh_inside_pos;
                 _add_vertex(ctx, v);
+                _add_outline_point(ctx, str, OUTLINE_LEFT, v.pos);
                 v.pos = rlh_outside_pos;
                 _add_vertex(ctx, v);
+                _add_outline_point(ctx, str, OUTLINE_RIGHT, v.pos);
             } else {
                 v.pos = rlh_outside_pos;
                 _add_vertex(ctx, v);
+                _add_outline_point(ctx, str, OUTLINE_LEFT, v.pos);
                 v.pos = rlh_inside_pos;
                 _add_vertex(ctx, v);
+                _add_outline_point(ctx, str, OUTLINE_RIGHT, v.pos);
             }
 
             _add_tri_indices_for_rect(ctx, idx);
@@ -1076,16 +2026,19 @@ bool _build_vb_step(VkvgContext ctx, stroke_context_t *str, bool isCurve) {
             else
                 v.pos = vec2_add(p0, bisec);
             _add_vertex(ctx, v);
+            _add_outline_point(ctx, str, OUTLINE_LEFT, v.pos);
             v.pos = vec2_sub(p0, vec2_mult_s(vp, str->hw));
         } else {
             v.pos = vec2_add(p0, vec2_mult_s(vp, str->hw));
             _add_vertex(ctx, v);
+            _add_outline_point(ctx, str, OUTLINE_LEFT, v.pos);
             if (dot < 0 && rlh < lh)
                 v.pos = rlh_inside_pos;
             else
                 v.pos = vec2_sub(p0, bisec);
         }
         _add_vertex(ctx, v);
+        _add_outline_point(ctx, str, OUTLINE_RIGHT, v.pos);
 
         if (join == VKVG_LINE_JOIN_BEVEL) {
             if (det < 0) {
@@ -1109,14 +2062,18 @@ bool _build_vb_step(VkvgContext ctx, stroke_context_t *str, bool isCurve) {
                 float a1 = a + alpha;
                 a -= str->arcStep;
                 while (a > a1) {
-                    _add_vertexf(ctx, cosf(a) * str->hw + p0.x, sinf(a) * str->hw + p0.y);
+                    v.pos = (vec2){cosf(a) * str->hw + p0.x, sinf(a) * str->hw + p0.y};
+                    _add_vertex(ctx, v);
+                    _add_outline_point(ctx, str, OUTLINE_RIGHT, v.pos);
                     a -= str->arcStep;
                 }
             } else {
                 float a1 = a + alpha;
                 a += str->arcStep;
                 while (a < a1) {
-                    _add_vertexf(ctx, cosf(a) * str->hw + p0.x, sinf(a) * str->hw + p0.y);
+                    v.pos = (vec2){cosf(a) * str->hw + p0.x, sinf(a) * str->hw + p0.y};
+                    _add_vertex(ctx, v);
+                    _add_outline_point(ctx, str, OUTLINE_LEFT, v.pos);
                     a += str->arcStep;
                 }
             }
@@ -1141,6 +2098,7 @@ bool _build_vb_step(VkvgContext ctx, stroke_context_t *str, bool isCurve) {
         else
             v.pos = vec2_add(p0, vp);
         _add_vertex(ctx, v);
+        _add_outline_point(ctx, str, det < 0 ? OUTLINE_RIGHT : OUTLINE_LEFT, v.pos);
     }
 
     /*
@@ -1163,12 +2121,13 @@ bool _build_vb_step(VkvgContext ctx, stroke_context_t *str, bool isCurve) {
 }
 
 void _draw_stoke_cap(VkvgContext ctx, stroke_context_t *str, vec2 p0, vec2 n, bool isStart) {
-    Vertex v = {{0}, ctx->curColor, {0, 0, -1}};
+    Vertex v = {{0}, ctx->vxColor, VKVG_VERTEX_NO_UV};
 
     VKVG_IBO_INDEX_TYPE firstIdx = (VKVG_IBO_INDEX_TYPE)(ctx->vertCount - ctx->curVertOffset);
 
     if (isStart) {
-        vec2 vhw = vec2_mult_s(n, str->hw);
+        str->outlineCount = 0;
+        vec2 vhw          = vec2_mult_s(n, str->hw);
 
         if (ctx->lineCap == VKVG_LINE_CAP_SQUARE)
             p0 = vec2_sub(p0, vhw);
@@ -1186,7 +2145,9 @@ void _draw_stoke_cap(VkvgContext ctx, stroke_context_t *str, vec2 p0, vec2 n, bo
 
             a += str->arcStep;
             while (a < a1) {
-                _add_vertexf(ctx, cosf(a) * str->hw + p0.x, sinf(a) * str->hw + p0.y);
+                v.pos = (vec2){cosf(a) * str->hw + p0.x, sinf(a) * str->hw + p0.y};
+                _add_vertex(ctx, v);
+                _add_outline_point(ctx, str, OUTLINE_START_CAP, v.pos);
                 a += str->arcStep;
             }
             VKVG_IBO_INDEX_TYPE p0Idx = (VKVG_IBO_INDEX_TYPE)(ctx->vertCount - ctx->curVertOffset);
@@ -1197,8 +2158,10 @@ void _draw_stoke_cap(VkvgContext ctx, stroke_context_t *str, vec2 p0, vec2 n, bo
 
         v.pos = vec2_add(p0, vhw);
         _add_vertex(ctx, v);
+        _add_outline_point(ctx, str, OUTLINE_LEFT, v.pos);
         v.pos = vec2_sub(p0, vhw);
         _add_vertex(ctx, v);
+        _add_outline_point(ctx, str, OUTLINE_RIGHT, v.pos);
 
         _add_tri_indices_for_rect(ctx, firstIdx);
     } else {
@@ -1211,8 +2174,10 @@ void _draw_stoke_cap(VkvgContext ctx, stroke_context_t *str, vec2 p0, vec2 n, bo
 
         v.pos = vec2_add(p0, vhw);
         _add_vertex(ctx, v);
+        _add_outline_point(ctx, str, OUTLINE_LEFT, v.pos);
         v.pos = vec2_sub(p0, vhw);
         _add_vertex(ctx, v);
+        _add_outline_point(ctx, str, OUTLINE_RIGHT, v.pos);
 
         firstIdx = (VKVG_IBO_INDEX_TYPE)(ctx->vertCount - ctx->curVertOffset);
 
@@ -1227,7 +2192,9 @@ void _draw_stoke_cap(VkvgContext ctx, stroke_context_t *str, vec2 p0, vec2 n, bo
 
             a -= str->arcStep;
             while (a > a1) {
-                _add_vertexf(ctx, cosf(a) * str->hw + p0.x, sinf(a) * str->hw + p0.y);
+                v.pos = (vec2){cosf(a) * str->hw + p0.x, sinf(a) * str->hw + p0.y};
+                _add_vertex(ctx, v);
+                _add_outline_point(ctx, str, OUTLINE_END_CAP, v.pos);
                 a -= str->arcStep;
             }
 
@@ -1235,6 +2202,7 @@ void _draw_stoke_cap(VkvgContext ctx, stroke_context_t *str, vec2 p0, vec2 n, bo
             for (VKVG_IBO_INDEX_TYPE p = firstIdx - 1; p < p0Idx; p++)
                 _add_triangle_indices(ctx, p + 1, p, firstIdx - 2);
         }
+        _add_stroke_fringe(ctx, str, false);
     }
 }
 float _draw_dashed_segment(VkvgContext ctx, stroke_context_t *str, dash_context_t *dc, bool isCurve) {
@@ -1281,19 +2249,6 @@ void _draw_segment(VkvgContext ctx, stroke_context_t *str, dash_context_t *dc, b
     }
 }
 
-bool ptInTriangle(vec2 p, vec2 p0, vec2 p1, vec2 p2) {
-    float dX   = p.x - p2.x;
-    float dY   = p.y - p2.y;
-    float dX21 = p2.x - p1.x;
-    float dY12 = p1.y - p2.y;
-    float D    = dY12 * (p0.x - p2.x) + dX21 * (p0.y - p2.y);
-    float s    = dY12 * dX + dX21 * dY;
-    float t    = (p2.y - p0.y) * dX + (p0.x - p2.x) * dY;
-    if (D < 0)
-        return (s <= 0) && (t <= 0) && (s + t >= D);
-    return (s >= 0) && (t >= 0) && (s + t <= D);
-}
-
 void _free_ctx_save(vkvg_context_save_t *sav) {
     if (sav->dashCount > 0)
         free(sav->dashes);
@@ -1468,7 +2423,6 @@ void _line_to(VkvgContext ctx, float x, float y) {
             return;
     }
     _add_point(ctx, x, y);
-    ctx->simpleConvex = false;
 }
 void _elliptic_arc(VkvgContext ctx, float x1, float y1, float x2, float y2, bool largeArc, bool counterClockWise,
                    float _rx, float _ry, float phi) {
@@ -1544,14 +2498,9 @@ void _elliptic_arc(VkvgContext ctx, float x1, float y1, float x2, float y2, bool
     if (_current_path_is_empty(ctx)) {
         _set_curve_start(ctx);
         _add_point(ctx, xy.x, xy.y);
-        if (!ctx->pathPtr)
-            ctx->simpleConvex = true;
-        else
-            ctx->simpleConvex = false;
     } else {
         _line_to(ctx, xy.x, xy.y);
         _set_curve_start(ctx);
-        ctx->simpleConvex = false;
     }
 
     _set_curve_start(ctx);
@@ -1579,25 +2528,26 @@ void _elliptic_arc(VkvgContext ctx, float x1, float y1, float x2, float y2, bool
     _set_curve_end(ctx);
 }
 
-// Even-Odd inside test with stencil buffer implementation.
+// Stencil then cover: path fans are drawn on the stencil with the inside test of the current fill rule, even-odd
+// inverts the fill bit, non-zero counts windings and fold them in the fill bit afterward. The cover pass is left
+// to the caller.
 void _poly_fill(VkvgContext ctx, vec4 *bounds) {
     // we anticipate the check for vbo buffer size, ibo is not used in poly_fill
     // the polyfill emit a single vertex for each point in the path.
-    if (ctx->sizeVBO - VKVG_ARRAY_THRESHOLD < ctx->vertCount + ctx->pointCount) {
+    if (ctx->sizeVBO - VKVG_ARRAY_THRESHOLD < ctx->vertCount - ctx->vertBase + ctx->pointCount) {
         if (ctx->cmdStarted) {
             _end_render_pass(ctx);
             if (ctx->vertCount > 0)
                 _flush_vertices_caches(ctx);
             vkh_cmd_end(ctx->cmd);
             _wait_and_submit_cmd(ctx);
-            _wait_ctx_flush_end(ctx);
             if (ctx->sizeVBO - VKVG_ARRAY_THRESHOLD < ctx->pointCount) {
                 _resize_vbo(ctx, ctx->pointCount + VKVG_ARRAY_THRESHOLD);
                 _resize_vertex_cache(ctx, ctx->sizeVBO);
             }
         } else {
-            _resize_vbo(ctx, ctx->vertCount + ctx->pointCount + VKVG_ARRAY_THRESHOLD);
-            _resize_vertex_cache(ctx, ctx->sizeVBO);
+            _resize_vbo(ctx, ctx->vertCount - ctx->vertBase + ctx->pointCount + VKVG_ARRAY_THRESHOLD);
+            _resize_vertex_cache(ctx, ctx->vertBase + ctx->sizeVBO);
         }
 
         _start_cmd_for_render_pass(ctx);
@@ -1606,9 +2556,11 @@ void _poly_fill(VkvgContext ctx, vec4 *bounds) {
         _ensure_renderpass_is_started(ctx);
     }
 
-    CmdBindPipeline(ctx->cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, ctx->dev->pipelinePolyFill);
+    bool nonZero = ctx->curFillRule == VKVG_FILL_RULE_NON_ZERO;
+    CmdBindPipeline(ctx->cmd, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                    nonZero ? ctx->dev->pipelineNzStencil : ctx->dev->pipelinePolyFill);
 
-    Vertex   v          = {{0}, ctx->curColor, {0, 0, -1}};
+    Vertex   v          = {{0}, ctx->vxColor, VKVG_VERTEX_NO_UV};
     uint32_t ptrPath    = 0;
     uint32_t firstPtIdx = 0;
 
@@ -1618,13 +2570,16 @@ void _poly_fill(VkvgContext ctx, vec4 *bounds) {
             VKVG_IBO_INDEX_TYPE firstVertIdx = (VKVG_IBO_INDEX_TYPE)ctx->vertCount;
 
             for (uint32_t i = 0; i < pathPointCount; i++) {
-                v.pos                              = ctx->points[i + firstPtIdx];
+                v.pos = ctx->points[i + firstPtIdx];
+                if (ctx->transformBatching)
+                    vkvg_matrix_transform_point(&ctx->pushConsts.mat, &v.pos.x, &v.pos.y);
                 ctx->vertexCache[ctx->vertCount++] = v;
                 if (!bounds)
                     continue;
                 // bounds are computed here to scissor the painting operation
                 // that speed up fill drastically.
-                vkvg_matrix_transform_point(&ctx->pushConsts.mat, &v.pos.x, &v.pos.y);
+                if (!ctx->transformBatching)
+                    vkvg_matrix_transform_point(&ctx->pushConsts.mat, &v.pos.x, &v.pos.y);
 
                 if (v.pos.x < bounds->xMin)
                     bounds->xMin = v.pos.x;
@@ -1638,7 +2593,7 @@ void _poly_fill(VkvgContext ctx, vec4 *bounds) {
 
             LOG(VKVG_LOG_INFO_PATH, "\tpoly fill: point count = %d; 1st vert = %d; vert count = %d\n", pathPointCount,
                 firstVertIdx, ctx->vertCount - firstVertIdx);
-            CmdDraw(ctx->cmd, pathPointCount, 1, firstVertIdx, 0);
+            CmdDraw(ctx->cmd, pathPointCount, 1, firstVertIdx - ctx->vertBase, 0);
         }
         firstPtIdx += pathPointCount;
 
@@ -1652,8 +2607,373 @@ void _poly_fill(VkvgContext ctx, vec4 *bounds) {
             ptrPath++;
     }
     ctx->curVertOffset = ctx->vertCount;
+
+    if (nonZero) {
+        CmdBindPipeline(ctx->cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, ctx->dev->pipelineNzResolve);
+        _draw_full_screen_quad(ctx, bounds);
+    }
 }
-#ifdef VKVG_FILL_NZ_GLUTESS
+// count the direction reversals of a closed ring along one axis, zero length moves are skipped.
+static uint32_t _ring_reversals(const vec2 *pts, uint32_t count, bool alongY) {
+    uint32_t reversals = 0;
+    int      first = 0, last = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        vec2  p0 = pts[i], p1 = pts[(i + 1) % count];
+        float d  = alongY ? p1.y - p0.y : p1.x - p0.x;
+        int   s  = (d > 0) - (d < 0);
+        if (s == 0)
+            continue;
+        if (first == 0)
+            first = s;
+        else if (s != last)
+            reversals++;
+        last = s;
+    }
+    return first != 0 && last != first ? reversals + 1 : reversals;
+}
+typedef struct {
+    float   y0, y1; // top and bottom in sample rows
+    float   x0;     // x at y0 in device pixels
+    float   dxdy;   // x increment per sample row
+    int32_t winding;
+} wrap_edge_t;
+typedef struct {
+    float   x;
+    int32_t winding;
+} wrap_crossing_t;
+
+static int _wrap_cmp_edges(const void *a, const void *b) {
+    float ya = ((const wrap_edge_t *)a)->y0, yb = ((const wrap_edge_t *)b)->y0;
+    return (ya > yb) - (ya < yb);
+}
+static int _wrap_cmp_crossings(const void *a, const void *b) {
+    float xa = ((const wrap_crossing_t *)a)->x, xb = ((const wrap_crossing_t *)b)->x;
+    return (xa > xb) - (xa < xb);
+}
+// Exact test on the rows of stencil samples of the surface: on each row, the windings of the edge crossings sorted
+// by x are summed to find a counter wrapping to 0. Rows are spaced by 1 / samples pixel, on which the standard
+// sample locations lie up to 8 samples. Cost is the count of crossings, only paid when the reversal bound fails.
+static bool _winding_wraps_on_rows(VkvgContext ctx) {
+    float    spl      = (float)ctx->dev->samples;
+    int32_t  rowCount = (int32_t)(ctx->pSurf->height * ctx->dev->samples);
+    uint8_t *arena    = (uint8_t *)_tess_arena_reserve(
+        ctx, ctx->pointCount * (sizeof(wrap_edge_t) + sizeof(uint32_t) + sizeof(wrap_crossing_t)));
+    if (!arena)
+        return true;
+    wrap_edge_t     *edges     = (wrap_edge_t *)arena;
+    uint32_t        *active    = (uint32_t *)(edges + ctx->pointCount);
+    wrap_crossing_t *crossings = (wrap_crossing_t *)(active + ctx->pointCount);
+
+    uint32_t edgeCount = 0, ptrPath = 0, firstPtIdx = 0;
+    while (ptrPath < ctx->pathPtr) {
+        uint32_t pathPointCount = ctx->pathes[ptrPath] & PATH_ELT_MASK;
+        if (pathPointCount > 2) {
+            vec2 a = ctx->points[firstPtIdx + pathPointCount - 1];
+            vkvg_matrix_transform_point(&ctx->pushConsts.mat, &a.x, &a.y);
+            for (uint32_t i = 0; i < pathPointCount; i++) {
+                vec2 b = ctx->points[firstPtIdx + i];
+                vkvg_matrix_transform_point(&ctx->pushConsts.mat, &b.x, &b.y);
+                // row r is at y = (r + 0.5) / samples.
+                float ya = a.y * spl - 0.5f, yb = b.y * spl - 0.5f;
+                if (ya != yb) {
+                    wrap_edge_t *e = &edges[edgeCount++];
+                    e->winding     = ya < yb ? 1 : -1;
+                    e->y0          = ya < yb ? ya : yb;
+                    e->y1          = ya < yb ? yb : ya;
+                    e->x0          = ya < yb ? a.x : b.x;
+                    e->dxdy        = (b.x - a.x) / (yb - ya);
+                }
+                a = b;
+            }
+        }
+        firstPtIdx += pathPointCount;
+        if (_path_has_curves(ctx, ptrPath)) {
+            // skip segments lengths used in stroke
+            ptrPath++;
+            uint32_t totPts = 0;
+            while (totPts < pathPointCount)
+                totPts += (ctx->pathes[ptrPath++] & PATH_ELT_MASK);
+        } else
+            ptrPath++;
+    }
+    qsort(edges, edgeCount, sizeof(wrap_edge_t), _wrap_cmp_edges);
+
+    uint32_t activeCount = 0, ei = 0;
+    int32_t  r           = 0;
+    while (true) {
+        if (activeCount == 0) { // skip the rows without edges
+            if (ei == edgeCount)
+                break;
+            r = MAX(r, (int32_t)ceilf(edges[ei].y0));
+        }
+        if (r >= rowCount)
+            break;
+        for (; ei < edgeCount && edges[ei].y0 <= (float)r; ei++)
+            if (edges[ei].y1 > (float)r)
+                active[activeCount++] = ei;
+        uint32_t kept = 0;
+        for (uint32_t i = 0; i < activeCount; i++) {
+            wrap_edge_t *e = &edges[active[i]];
+            if (e->y1 <= (float)r)
+                continue;
+            crossings[kept] = (wrap_crossing_t){e->x0 + ((float)r - e->y0) * e->dxdy, e->winding};
+            active[kept++]  = active[i];
+        }
+        activeCount = kept;
+        qsort(crossings, kept, sizeof(wrap_crossing_t), _wrap_cmp_crossings);
+        int32_t winding = 0;
+        for (uint32_t i = 0; i < kept; i++) {
+            winding += crossings[i].winding;
+            if (winding != 0 && (winding & STENCIL_WINDING_MASK) == 0)
+                return true;
+        }
+        r++;
+    }
+    return false;
+}
+// A line parallel to an axis crosses a ring at most as many times as the ring reverses its direction along the
+// other one, and a point winding is bounded by the crossings on each side of it, that is half of them. Bounds of
+// the subpathes are summed, when the stencil winding counter could wrap, as with spirals, stars or jagged outlines,
+// the windings are checked on the sample rows.
+static bool _winding_may_wrap(VkvgContext ctx) {
+    uint32_t ptrPath = 0, firstPtIdx = 0, bound = 0;
+    while (ptrPath < ctx->pathPtr) {
+        uint32_t pathPointCount = ctx->pathes[ptrPath] & PATH_ELT_MASK;
+        if (pathPointCount > 2) {
+            const vec2 *pts = &ctx->points[firstPtIdx];
+            bound += MIN(_ring_reversals(pts, pathPointCount, false), _ring_reversals(pts, pathPointCount, true)) / 2;
+            if (bound > STENCIL_WINDING_MASK)
+                return _winding_wraps_on_rows(ctx);
+        }
+        firstPtIdx += pathPointCount;
+        if (_path_has_curves(ctx, ptrPath)) {
+            // skip segments lengths used in stroke
+            ptrPath++;
+            uint32_t totPts = 0;
+            while (totPts < pathPointCount)
+                totPts += (ctx->pathes[ptrPath++] & PATH_ELT_MASK);
+        } else
+            ptrPath++;
+    }
+    return false;
+}
+// Filling on stencil cost O(n) on the cpu whatever the path complexity, but needs two or three passes on the gpu
+// where tesselated paths are drawn in a single batched call. Large concave paths are sent to the stencil.
+bool _fill_with_stencil(VkvgContext ctx) {
+#ifndef VKVG_FILL_NZ_SWEEP
+    if (ctx->curFillRule == VKVG_FILL_RULE_EVEN_ODD)
+        return true;
+#endif
+#ifdef __APPLE__
+    return false; // no triangle fan for the stencil pass
+#else
+    if (ctx->subpathCount == 1 && ctx->pathes[0] & PATH_IS_CONVEX_BIT)
+        return false;
+    if (ctx->pointCount <= ctx->dev->stencilFillThreshold)
+        return false;
+    // the winding counter wraps past STENCIL_WINDING_MASK, pathes that may wind more are tesselated.
+    return ctx->curFillRule != VKVG_FILL_RULE_NON_ZERO || !_winding_may_wrap(ctx);
+#endif
+}
+// reserve size bytes in the tesselator arena, return NULL on allocation failure.
+void *_tess_arena_reserve(VkvgContext ctx, size_t size) {
+    if (ctx->tessArena.size < size) {
+        size_t newSize = MAX(size, (size_t)((double)ctx->tessArena.size * ctx->dev->arrayGrowthFactor));
+        void  *tmp     = realloc(ctx->tessArena.data, newSize);
+        if (tmp == NULL) {
+            ctx->status = VKVG_STATUS_NO_MEMORY;
+            LOG(VKVG_LOG_ERR, "resize tesselator arena failed: new size(byte): %zu\n", newSize);
+            return NULL;
+        }
+        ctx->tessArena.data = tmp;
+        ctx->tessArena.size = newSize;
+    }
+    return ctx->tessArena.data;
+}
+void _tess_arena_release(VkvgContext ctx) {
+    free(ctx->tessArena.data);
+    ctx->tessArena.data = NULL;
+    ctx->tessArena.size = 0;
+}
+// remove repeated points of a ring, closing point included, return the new point count.
+static uint32_t _fringe_ring_dedup(vec2 *ring, uint32_t count) {
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < count; i++)
+        if (n == 0 || !vec2_equ(ring[i], ring[n - 1]))
+            ring[n++] = ring[i];
+    while (n > 1 && vec2_equ(ring[0], ring[n - 1]))
+        n--;
+    return n;
+}
+// emit the fringe of a ring on the right of its edges for a positive w, or on both sides.
+static void _emit_ring_fringe(VkvgContext ctx, const vec2 *ring, uint32_t n, float w, bool bothSides) {
+    uint32_t vxPerPt = bothSides ? 3 : 2;
+    if (ctx->vertCount - ctx->curVertOffset + vxPerPt * n > VKVG_IBO_MAX)
+        _emit_draw_cmd_undrawn_vertices(ctx);
+    _ensure_vertex_cache_size(ctx, vxPerPt * n);
+    _ensure_index_cache_size(ctx, (bothSides ? 12 : 6) * n);
+
+    Vertex vIn  = {{0}, _fade_vertex_color(ctx->vxColor, 0.5f), VKVG_VERTEX_NO_UV};
+    Vertex vOut = {{0}, _fade_vertex_color(ctx->vxColor, 0), VKVG_VERTEX_NO_UV};
+
+    VKVG_IBO_INDEX_TYPE firstIdx = (VKVG_IBO_INDEX_TYPE)(ctx->vertCount - ctx->curVertOffset);
+    vec2                e        = vec2_norm(vec2_sub(ring[0], ring[n - 1]));
+    vec2                n0       = {e.y, -e.x};
+    for (uint32_t i = 0; i < n; i++) {
+        e       = vec2_norm(vec2_sub(ring[(i + 1) % n], ring[i]));
+        vec2 n1 = {e.y, -e.x};
+        // miter of the two edge normals, shortened on sharp corners to avoid spikes.
+        vec2  m  = vec2_mult_s(vec2_add(n0, n1), 0.5f);
+        float m2 = vec2_dot(m, m);
+        if (m2 > 1e-6f)
+            m = vec2_mult_s(m, fminf(1.0f / m2, 4.0f));
+        vIn.pos  = ring[i];
+        vOut.pos = vec2_add(ring[i], vec2_mult_s(m, w));
+        _set_vertex(ctx, ctx->vertCount++, vIn);
+        _set_vertex(ctx, ctx->vertCount++, vOut);
+        if (bothSides) {
+            vOut.pos = vec2_add(ring[i], vec2_mult_s(m, -w));
+            _set_vertex(ctx, ctx->vertCount++, vOut);
+        }
+
+        VKVG_IBO_INDEX_TYPE i0 = firstIdx + (VKVG_IBO_INDEX_TYPE)(vxPerPt * i);
+        VKVG_IBO_INDEX_TYPE i1 = firstIdx + (VKVG_IBO_INDEX_TYPE)(vxPerPt * ((i + 1) % n));
+        _add_triangle_indices_unchecked(ctx, i0, i0 + 1, i1);
+        _add_triangle_indices_unchecked(ctx, i0 + 1, i1 + 1, i1);
+        if (bothSides) {
+            _add_triangle_indices_unchecked(ctx, i0, i1, i0 + 2);
+            _add_triangle_indices_unchecked(ctx, i0 + 2, i1, i1 + 2);
+        }
+        n0 = n1;
+    }
+}
+// Analytic antialiasing of single sampled devices: a feathered fringe is added on the outer side of the filled or
+// stroked outline. Vertices on the outline get half the vertex alpha and the outer ones, half a device pixel away,
+// a null alpha, so pixels centered outside of the shape get the coverage of a pixel wide box filter. Pixels
+// centered inside are drawn by the shape itself. The ring may be modified to remove repeated points. Fringes of
+// inner rings, as the inner outlines of closed strokes, are on the inside.
+void _add_edge_fringe(VkvgContext ctx, vec2 *ring, uint32_t count, bool inner) {
+    uint32_t n = _fringe_ring_dedup(ring, count);
+    if (n < 3)
+        return;
+
+    // outward normals are on the right of the edges for positive areas.
+    float area = 0;
+    for (uint32_t i = 0; i < n; i++)
+        area += vec2_zcross(ring[i], ring[(i + 1) % n]);
+    if (area == 0)
+        return;
+    float w = 0.5f / _get_matrix_scale(ctx);
+    if ((area < 0) != inner)
+        w = -w;
+    _emit_ring_fringe(ctx, ring, n, w, false);
+}
+// The orientation of a subpath only gives the outer side of its edges when it is alone and simple. Fringes of other
+// fills are drawn on both sides of the edges between the stencil and the cover passes, where the stencil fill bit,
+// holding the fill rule result, is not set. Edges inside the fill, as holes wound as their outer ring or seams of
+// overlapping subpathes, get no fringe. Fills whose winding could wrap the stencil counter are tesselated and keep
+// the subpath orientation.
+bool _fill_fringes_on_stencil(VkvgContext ctx) {
+#ifdef __APPLE__
+    return false; // no triangle fan for the stencil pass
+#else
+    if (!ctx->dev->analyticAA || (ctx->subpathCount == 1 && ctx->pathes[0] & PATH_IS_CONVEX_BIT))
+        return false;
+    return ctx->curFillRule != VKVG_FILL_RULE_NON_ZERO || !_winding_may_wrap(ctx);
+#endif
+}
+// draw the fringes of the current fill outside of the stencil fill bits, before the cover pass clears them.
+void _add_stencil_fringes(VkvgContext ctx) {
+    float    w          = 0.5f / _get_matrix_scale(ctx);
+    uint32_t ptrPath    = 0;
+    uint32_t firstPtIdx = 0;
+    while (ptrPath < ctx->pathPtr) {
+        uint32_t pathPointCount = ctx->pathes[ptrPath] & PATH_ELT_MASK;
+        if (pathPointCount > 2) {
+            vec2 *ring = (vec2 *)_tess_arena_reserve(ctx, pathPointCount * sizeof(vec2));
+            if (!ring)
+                return;
+            memcpy(ring, &ctx->points[firstPtIdx], pathPointCount * sizeof(vec2));
+            uint32_t n = _fringe_ring_dedup(ring, pathPointCount);
+            if (n > 2)
+                _emit_ring_fringe(ctx, ring, n, w, true);
+        }
+        firstPtIdx += pathPointCount;
+
+        if (_path_has_curves(ctx, ptrPath)) {
+            // skip segments lengths used in stroke
+            ptrPath++;
+            uint32_t totPts = 0;
+            while (totPts < pathPointCount)
+                totPts += (ctx->pathes[ptrPath++] & PATH_ELT_MASK);
+        } else
+            ptrPath++;
+    }
+    if (ctx->indCount == ctx->curIndStart)
+        return;
+    // a flush restarting the render pass would reset the stencil test, it is done before.
+    _check_vao_size(ctx);
+    _ensure_renderpass_is_started(ctx);
+    _bind_draw_pipeline(ctx);
+    CmdSetStencilReference(ctx->cmd, VK_STENCIL_FRONT_AND_BACK, 0);
+    CmdSetStencilCompareMask(ctx->cmd, VK_STENCIL_FRONT_AND_BACK, STENCIL_FILL_BIT | STENCIL_CLIP_BIT);
+    _emit_draw_cmd_undrawn_vertices(ctx);
+    CmdSetStencilReference(ctx->cmd, VK_STENCIL_FRONT_AND_BACK, STENCIL_FILL_BIT);
+}
+// add the fringes of all the subpathes of the current fill, their points are copied in the tesselator arena.
+void _add_fill_fringes(VkvgContext ctx) {
+    uint32_t ptrPath    = 0;
+    uint32_t firstPtIdx = 0;
+    while (ptrPath < ctx->pathPtr) {
+        uint32_t pathPointCount = ctx->pathes[ptrPath] & PATH_ELT_MASK;
+        if (pathPointCount > 2) {
+            vec2 *ring = (vec2 *)_tess_arena_reserve(ctx, pathPointCount * sizeof(vec2));
+            if (!ring)
+                return;
+            memcpy(ring, &ctx->points[firstPtIdx], pathPointCount * sizeof(vec2));
+            _add_edge_fringe(ctx, ring, pathPointCount, false);
+        }
+        firstPtIdx += pathPointCount;
+
+        if (_path_has_curves(ctx, ptrPath)) {
+            // skip segments lengths used in stroke
+            ptrPath++;
+            uint32_t totPts = 0;
+            while (totPts < pathPointCount)
+                totPts += (ctx->pathes[ptrPath++] & PATH_ELT_MASK);
+        } else
+            ptrPath++;
+    }
+}
+// simple concave rectangle or circle, filled with a triangle fan
+static void _fill_convex_path(VkvgContext ctx) {
+    Vertex              v              = {{0}, ctx->vxColor, VKVG_VERTEX_NO_UV};
+    VKVG_IBO_INDEX_TYPE firstVertIdx   = (VKVG_IBO_INDEX_TYPE)(ctx->vertCount - ctx->curVertOffset);
+    uint32_t            pathPointCount = ctx->pathes[0] & PATH_ELT_MASK;
+
+    _ensure_vertex_cache_size(ctx, pathPointCount);
+    _ensure_index_cache_size(ctx, (pathPointCount - 2) * 3);
+
+    VKVG_IBO_INDEX_TYPE i = 0;
+    while (i < 2) {
+        v.pos = ctx->points[i++];
+        _set_vertex(ctx, ctx->vertCount++, v);
+    }
+    while (i < pathPointCount) {
+        v.pos = ctx->points[i];
+        _set_vertex(ctx, ctx->vertCount++, v);
+        _add_triangle_indices_unchecked(ctx, firstVertIdx, firstVertIdx + i - 1, firstVertIdx + i);
+        i++;
+    }
+}
+#ifdef VKVG_FILL_NZ_SWEEP
+void _fill_non_zero(VkvgContext ctx) {
+    if (ctx->subpathCount == 1 && ctx->pathes[0] & PATH_IS_CONVEX_BIT)
+        _fill_convex_path(ctx);
+    else
+        _tess_fill(ctx, VKVG_FILL_RULE_NON_ZERO);
+}
+#elif defined(VKVG_FILL_NZ_GLUTESS)
 void fan_vertex2(VKVG_IBO_INDEX_TYPE v, VkvgContext ctx) {
     VKVG_IBO_INDEX_TYPE i = (VKVG_IBO_INDEX_TYPE)v;
     switch (ctx->tesselator_idx_counter) {
@@ -1708,7 +3028,7 @@ void begin2(GLenum which, void *poly_data) {
 void combine2(const GLdouble newVertex[3], const void *neighborVertex_s[4], const GLfloat neighborWeight[4],
               void **outData, void *poly_data) {
     VkvgContext ctx = (VkvgContext)poly_data;
-    Vertex      v   = {{newVertex[0], newVertex[1]}, ctx->curColor, {0, 0, -1}};
+    Vertex      v   = {{newVertex[0], newVertex[1]}, ctx->vxColor, VKVG_VERTEX_NO_UV};
     *outData        = (void *)((unsigned long)(ctx->vertCount - ctx->curVertOffset));
     _add_vertex(ctx, v);
 }
@@ -1718,30 +3038,13 @@ void vertex2(void *vertex_data, void *poly_data) {
     ctx->vertex_cb(i, ctx);
 }
 void _fill_non_zero(VkvgContext ctx) {
-    Vertex v = {{0}, ctx->curColor, {0, 0, -1}};
+    Vertex v = {{0}, ctx->vxColor, VKVG_VERTEX_NO_UV};
 
     uint32_t ptrPath    = 0;
     uint32_t firstPtIdx = 0;
 
-    if (ctx->pathPtr == 1 && ctx->pathes[0] & PATH_IS_CONVEX_BIT) {
-        // simple concave rectangle or circle
-        VKVG_IBO_INDEX_TYPE firstVertIdx   = (VKVG_IBO_INDEX_TYPE)(ctx->vertCount - ctx->curVertOffset);
-        uint32_t            pathPointCount = ctx->pathes[ptrPath] & PATH_ELT_MASK;
-
-        _ensure_vertex_cache_size(ctx, pathPointCount);
-        _ensure_index_cache_size(ctx, (pathPointCount - 2) * 3);
-
-        VKVG_IBO_INDEX_TYPE i = 0;
-        while (i < 2) {
-            v.pos = ctx->points[i++];
-            _set_vertex(ctx, ctx->vertCount++, v);
-        }
-        while (i < pathPointCount) {
-            v.pos = ctx->points[i];
-            _set_vertex(ctx, ctx->vertCount++, v);
-            _add_triangle_indices_unchecked(ctx, firstVertIdx, firstVertIdx + i - 1, firstVertIdx + i);
-            i++;
-        }
+    if (ctx->subpathCount == 1 && ctx->pathes[0] & PATH_IS_CONVEX_BIT) {
+        _fill_convex_path(ctx);
         return;
     }
 
@@ -1794,85 +3097,10 @@ void _fill_non_zero(VkvgContext ctx) {
 #else
 // create fill from current path with ear clipping technic
 void _fill_non_zero(VkvgContext ctx) {
-    Vertex v = {{0}, ctx->curColor, {0, 0, -1}};
-
-    uint32_t ptrPath    = 0;
-    uint32_t firstPtIdx = 0;
-
-    while (ptrPath < ctx->pathPtr) {
-        uint32_t pathPointCount = ctx->pathes[ptrPath] & PATH_ELT_MASK;
-
-        if (pathPointCount > 2) {
-            VKVG_IBO_INDEX_TYPE firstVertIdx = (VKVG_IBO_INDEX_TYPE)(ctx->vertCount - ctx->curVertOffset);
-            // ear_clip_point* ecps = (ear_clip_point*)malloc(pathPointCount*sizeof(ear_clip_point));
-            ear_clip_point      ecps[pathPointCount];
-            uint32_t            ecps_count = pathPointCount;
-            VKVG_IBO_INDEX_TYPE i          = 0;
-
-            // init points link list
-            while (i < pathPointCount - 1) {
-                v.pos              = ctx->points[i + firstPtIdx];
-                ear_clip_point ecp = {v.pos, firstVertIdx + i, &ecps[i + 1]};
-                ecps[i]            = ecp;
-                _add_vertex(ctx, v);
-                i++;
-            }
-
-            v.pos              = ctx->points[i + firstPtIdx];
-            ear_clip_point ecp = {v.pos, firstVertIdx + i, ecps};
-            ecps[i]            = ecp;
-            _add_vertex(ctx, v);
-
-            ear_clip_point *ecp_current = ecps;
-            uint32_t        tries       = 0;
-
-            while (ecps_count > 3) {
-                if (tries > ecps_count) {
-                    break;
-                }
-                ear_clip_point *v0 = ecp_current->next, *v1 = ecp_current, *v2 = ecp_current->next->next;
-                if (ecp_zcross(v0, v2, v1) < 0) {
-                    ecp_current = ecp_current->next;
-                    tries++;
-                    continue;
-                }
-                ear_clip_point *vP    = v2->next;
-                bool            isEar = true;
-                while (vP != v1) {
-                    if (ptInTriangle(vP->pos, v0->pos, v2->pos, v1->pos)) {
-                        isEar = false;
-                        break;
-                    }
-                    vP = vP->next;
-                }
-                if (isEar) {
-                    _add_triangle_indices(ctx, v0->idx, v1->idx, v2->idx);
-                    v1->next = v2;
-                    ecps_count--;
-                    tries = 0;
-                } else {
-                    ecp_current = ecp_current->next;
-                    tries++;
-                }
-            }
-            if (ecps_count == 3)
-                _add_triangle_indices(ctx, ecp_current->next->idx, ecp_current->idx, ecp_current->next->next->idx);
-
-            // limit batch size here to 1/3 of the ibo index type ability
-            if (ctx->vertCount - ctx->curVertOffset > VKVG_IBO_MAX / 3)
-                _emit_draw_cmd_undrawn_vertices(ctx);
-        }
-
-        firstPtIdx += pathPointCount;
-        if (_path_has_curves(ctx, ptrPath)) {
-            // skip segments lengths used in stroke
-            ptrPath++;
-            uint32_t totPts = 0;
-            while (totPts < pathPointCount)
-                totPts += (ctx->pathes[ptrPath++] & PATH_ELT_MASK);
-        } else
-            ptrPath++;
-    }
+    if (ctx->subpathCount == 1 && ctx->pathes[0] & PATH_IS_CONVEX_BIT)
+        _fill_convex_path(ctx);
+    else
+        _earcut_fill(ctx);
 }
 #endif
 
@@ -1939,7 +3167,7 @@ void _draw_full_screen_quad(VkvgContext ctx, vec4 *scissor) {
     ctx->pushConsts.fsq_patternType |= FULLSCREEN_BIT;
     CmdPushConstants(ctx->cmd, ctx->dev->pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 24, 4,
                      &ctx->pushConsts.fsq_patternType);
-    CmdDraw(ctx->cmd, 3, 1, firstVertIdx, 0);
+    CmdDraw(ctx->cmd, 3, 1, firstVertIdx - ctx->vertBase, 0);
     ctx->pushConsts.fsq_patternType &= ~FULLSCREEN_BIT;
     CmdPushConstants(ctx->cmd, ctx->dev->pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 24, 4,
                      &ctx->pushConsts.fsq_patternType);
@@ -24,6 +24,7 @@
 
 #include "vkvg_internal.h"
 #include "vkvg_fonts.h"
+#include "vkvg_buffer_arena.h"
 
 #if VKVG_RECORDING
 #include "recording/vkvg_record_internal.h"
@@ -37,6 +38,14 @@
 #define VKVG_IBO_SIZE        (VKVG_VBO_SIZE * 6)
 #define VKVG_PATHES_SIZE     16
 #define VKVG_ARRAY_THRESHOLD 8
+#define VKVG_SOURCE_CACHE_SIZE 64 // surface sources descriptors kept by a context before waiting for reuse
+#define VKVG_SUBMIT_TIMELINES  (VKVG_SOURCE_CACHE_SIZE + 2) // target surface, cached sources and fallback source
+#define VKVG_CURVE_TOLERANCE     0.25f // default maximum distance in pixels between a curve and its flattened polyline
+#define VKVG_MIN_TOLERANCE       0.01f
+#define VKVG_BEZIER_MAX_SEGMENTS 1024
+#ifndef VKVG_STENCIL_FILL_THRESHOLD
+#define VKVG_STENCIL_FILL_THRESHOLD 512 // default point count above which concave paths are filled on stencil
+#endif
 
 #define VKVG_IBO_16          0
 #define VKVG_IBO_32          1
@@ -65,21 +74,44 @@
     (((int)(a * 255.0f) << 24) | ((int)(b * 255.0f) << 16) | ((int)(g * 255.0f) << 8) | (int)(r * 255.0f))
 #endif
 
+#ifdef VKVG_COMPACT_VERTEX
+// compact vertex, font cache coordinates are packed in a single uint: u and v in texels on 12 bits each,
+// and the font cache layer on the 8 high bits, a layer of 0xFF meaning no texture.
+typedef struct {
+    vec2     pos;
+    uint32_t color;
+    uint32_t uv;
+} Vertex;
+#define VKVG_VERTEX_NO_UV            0xFF000000
+#define VKVG_PACK_UV(u, v, layer)    ((((uint32_t)(layer)&0xFF) << 24) | (((uint32_t)(v)&0xFFF) << 12) | ((uint32_t)(u)&0xFFF))
+#define VKVG_UV_LOG_FMT              "uv:0x%.8x"
+#define VKVG_UV_LOG_ARGS(vx)         (vx).uv
+#else
 typedef struct {
     vec2     pos;
     uint32_t color;
     vec3     uv;
 } Vertex;
+#define VKVG_VERTEX_NO_UV            {0, 0, -1}
+#define VKVG_UV_LOG_FMT              "uv:(%10.4f,%10.4f,%10.4f)"
+#define VKVG_UV_LOG_ARGS(vx)         (vx).uv.x, (vx).uv.y, (vx).uv.z
+#endif
 
 typedef struct {
     vec4          source;
     vec2          size;
     uint32_t      fsq_patternType;
-    float         opacity;
+    float         opacity; // applied to the vertex colors, not read by the shaders
     vkvg_matrix_t mat;
     vkvg_matrix_t matInv;
 } push_constants;
 
+// pending indices drawn with an operator, ranges are consecutive and relative to the current index start.
+typedef struct {
+    uint32_t        end; // end of the range, the start being the end of the previous one
+    vkvg_operator_t op;
+} vkvg_op_range_t;
+
 /* context.curClipState may be one of the following, it's set
  * with check of the previous saved state:
  * - none: no clipping operation since the previous state
@@ -103,6 +135,7 @@ typedef struct _vkvg_context_save_t {
 
     float    lineWidth;
     float    miterLimit;
+    float    tolerance;  // curves and arcs flattening tolerance in device pixels.
     uint32_t dashCount;  // value count in dash array, 0 if dash not set.
     float    dashOffset; // an offset for dash
     float   *dashes;     // an array of alternate lengths of on and off stroke.
@@ -124,26 +157,94 @@ typedef struct _vkvg_context_save_t {
 
 } vkvg_context_save_t;
 
+/* Draw commands are recorded and submitted through a ring of vao segments, each one having its own command buffer
+ * and persistently mapped vertex and index buffers guarded by a fence or a timeline value. While the gpu process
+ * the submission of a segment, the next one may be recorded and filled without waiting.
+ */
+typedef struct {
+    VkCommandBuffer     cmd;      // command buffer recording draw commands using this segment buffers
+    vkvg_buffer_range_t vertices; // vertex buffer range in the device arena, with persistent mapped memory
+    vkvg_buffer_range_t indices;  // index buffer range in the device arena, with persistent mapped memory
+    uint32_t            sizeVBO;  // allocated size of vertices
+    uint32_t            sizeIBO;  // allocated size of indices
+#ifdef VKVG_ENABLE_VK_TIMELINE_SEMAPHORE
+    uint64_t timelineStep; // surface timeline value reached when the last submission of this segment is done.
+    // timelines waited and signaled by the last submission, the target surface one first, then the sampled sources.
+    // They are kept here until the segment is reused, batches only point to them.
+    uint32_t             semaphoreCount;
+    VkSemaphore          semaphores[VKVG_SUBMIT_TIMELINES];
+    uint64_t             waitValues[VKVG_SUBMIT_TIMELINES];
+    uint64_t             signalValues[VKVG_SUBMIT_TIMELINES];
+    VkPipelineStageFlags waitStages[VKVG_SUBMIT_TIMELINES];
+#else
+    uint64_t ticket; // submission counter value of the last submission of this segment.
+#endif
+    // signaled when the last submission of this segment is done. With timeline semaphores, only sub contexts use it,
+    // their segment fences being signaled after the submission of the parent.
+    VkFence  fence;
+    uint32_t subSeq; // sub contexts: recording order of a segment awaiting execution by the parent, 0 if none.
+    uint64_t batch;  // device batch of the last submission of this segment, 0 if submitted alone.
+} vkvg_vao_segment_t;
+
+// descriptor of a surface used as source, written once and kept until the last submission using it is done.
+typedef struct {
+    VkvgSurface     surf;    // referenced source surface, NULL if free
+    VkSampler       sampler; // device source sampler for the pattern extend and filter modes
+    VkDescriptorSet ds;      // allocated on first use, reused once free
+    bool            inCmd;   // bound since the last submission, or still the current source
+    uint64_t        ticket;  // flush ticket of the last submission sampling this source
+} vkvg_source_desc_t;
+
+// incremental convexity test of the current subpath
+typedef struct {
+    vec2    firstEdge;
+    vec2    refEdge;   // last edge with a significant turn, small turns add up against it
+    int8_t  turn;      // sign of the turns, 0 until the first one
+    int8_t  lastDx;    // sign of the last significant x of the edges
+    int8_t  lastDy;
+    uint8_t dxChanges; // count of sign changes of edges x
+    uint8_t dyChanges;
+    bool    concave;
+} vkvg_convexity_t;
+
+// transient memory of the sweep-line tesselator and of the ear clipper, kept between fills.
+typedef struct {
+    void  *data;
+    size_t size;
+} vkvg_tess_arena_t;
+
 typedef struct _vkvg_context_t {
     vkvg_status_t status;
     uint32_t      references; // reference count
 
     VkvgDevice  dev;
-    VkvgSurface pSurf; // surface bound to context, set on creation of ctx
+    VkvgSurface pSurf;   // surface bound to context, set on creation of ctx
+    VkhImage    stencil; // stencil attachment, the surface one or a scratch one shared by the surfaces of same size
 #ifdef VKVG_ENABLE_VK_TIMELINE_SEMAPHORE
     uint64_t timelineStep; // context cmd last submission timeline id.
 #else
-    VkFence flushFence; // context fence
+    uint64_t submitCount; // context cmd submission counter, used as flush ticket.
 #endif
     // VkDescriptorImageInfo sourceDescriptor;	//Store view/sampler in context
 
-    VkCommandPool    cmdPool;        // local pools ensure thread safety
-    VkCommandBuffer  cmdBuffers[2];  // double cmd buff for context operations
-    VkCommandBuffer  cmd;            // current recording buffer
-    VkDescriptorPool descriptorPool; // one pool per thread
-    VkDescriptorSet  dsFont;         // fonts glyphs texture atlas descriptor (local for thread safety)
-    VkDescriptorSet  dsSrc;          // source ds
-    VkDescriptorSet  dsGrad;         // gradient uniform buffer
+    VkCommandPool       cmdPool;      // local pools ensure thread safety
+    vkvg_vao_segment_t *vaoRing;      // ring of cmd buffers and vk buffers used for successive submissions
+    uint32_t            vaoRingDepth; // segment count in the ring
+    uint32_t            vaoRingIdx;   // index of the segment currently recorded
+    VkCommandBuffer     cmd;          // current recording buffer, the one of the current vao segment
+    bool                secondary;    // sub context, cmds are secondary buffers executed by the parent context
+    uint32_t            subSeqCount;  // sub contexts: counter of the segments handed over to the parent
+    VkFence            *subFences;    // fences of executed sub contexts segments, signaled after the next submission
+    uint32_t            subFenceCount;
+    uint32_t            sizeSubFences;
+    VkDescriptorPool    descriptorPool; // one pool per thread
+    VkDescriptorSet     dsFont;         // fonts glyphs texture atlas descriptor (local for thread safety)
+    VkDescriptorSet     dsSrc;          // source ds
+    VkDescriptorSet     dsGrad;         // gradient uniform buffer
+    VkDescriptorSet     dsSrcCur;       // source descriptor to bind, dsSrc or one of the source cache
+    bool                srcFallback;    // current surface source is written in dsSrc, rewriting it requires a wait
+    vkvg_source_desc_t  srcCache[VKVG_SOURCE_CACHE_SIZE]; // surface sources descriptors
+    uint32_t            srcCacheCount;  // source cache entries in use, released ones below it are free
 
     VkhImage fontCacheImg; // current font cache, may not be the last one, updated only if new glyphs are
                            // uploaded by the current context
@@ -151,7 +252,16 @@ typedef struct _vkvg_context_t {
     VkRect2D bounds;
 
     uint32_t curColor;
+    uint32_t vxColor; // color of emitted vertices, current color with opacity applied or opacity alone in alpha
 
+    // with draw reordering, operator changes do not end the current draw call, pending indices are grouped by
+    // operator when the draw calls are emitted.
+    bool             reorderDraws;
+    vkvg_op_range_t *opRanges;     // ends of the pending index ranges with a previous operator
+    uint32_t         opRangeCount; // count of ranges in opRanges
+    uint32_t         sizeOpRanges; // allocated count of opRanges
+
+    vkvg_tess_arena_t tessArena;
 #if VKVG_FILL_NZ_GLUTESS
     void (*vertex_cb)(VKVG_IBO_INDEX_TYPE, VkvgContext); // tesselator vertex callback
     VKVG_IBO_INDEX_TYPE tesselator_fan_start;
@@ -162,24 +272,41 @@ typedef struct _vkvg_context_t {
     vkvg_recording_t *recording;
 #endif
 
-    vkh_buffer_t uboGrad; // uniform buff obj holdings gradient infos
+    vkvg_buffer_range_t uboGrad;    // device arena range holding VKVG_GRADIENT_RECORDS gradients of dev->gradStride
+    uint32_t            gradCount;  // gradient records written since the last wait on the context submissions
+    uint32_t            gradOffset; // dynamic offset of the current gradient record in uboGrad
 
-    // vk buffers, holds data until flush
-    vkh_buffer_t indices;     // index buffer with persistent map memory
+    // vk buffers sizes are shared by all the vao segments, smaller ones are grown on reuse.
     uint32_t     sizeIBO;     // size of vk ibo
     uint32_t     sizeIndices; // reserved size
     uint32_t     indCount;    // current indice count
 
     uint32_t            curIndStart;   // last index recorded in cmd buff
     VKVG_IBO_INDEX_TYPE curVertOffset; // vertex offset in draw indexed command
+    // vbo and ibo content is a window in the caches starting at those offsets, cache beginnings are already flushed.
+    uint32_t indBase;  // first cached index of the ibo window
+    uint32_t vertBase; // first cached vertex of the vbo window
 
-    vkh_buffer_t vertices;     // vertex buffer with persistent mapped memory
     uint32_t     sizeVBO;      // size of vk vbo size
     uint32_t     sizeVertices; // reserved size
     uint32_t     vertCount;    // effective vertices count
 
+    // with transform batching, vertices are moved to device space on the cpu and pushed matrix is the identity,
+    // so that matrix changes do not split draw calls.
+    bool     transformBatching;
+    uint32_t xformVertBase; // first cached vertex that may still be in user space
+
     Vertex              *vertexCache;
     VKVG_IBO_INDEX_TYPE *indexCache;
+#ifdef VKVG_VAO_ZERO_COPY
+    // vertex and index caches point to the mapped buffers of the current vao segment when vaoMapped is true,
+    // host caches are only used when vk buffers have to be resized while recording.
+    bool                 vaoMapped;
+    Vertex              *hostVertexCache;
+    VKVG_IBO_INDEX_TYPE *hostIndexCache;
+    uint32_t             sizeHostVertices;
+    uint32_t             sizeHostIndices;
+#endif
 
     // pathes, exists until stroke of fill
     vec2    *points;     // points array
@@ -191,15 +318,28 @@ typedef struct _vkvg_context_t {
     uint32_t *pathes;
     uint32_t  sizePathes;
 
-    uint32_t segmentPtr;   // current segment count in current path having curves
-    uint32_t subpathCount; // store count of subpath, not straight forward to retrieve from segmented path array
-    bool     simpleConvex; // true if path is single rect or concave closed curve.
+    // high-water marks of the host arrays use since creation or reuse from the cache, grown arrays are shrunk to
+    // them when the context is cached.
+    uint32_t hwmPoints;
+    uint32_t hwmPathes;
+    uint32_t hwmVertices;
+    uint32_t hwmIndices;
+#if VKVG_DBG_STATS
+    uint32_t curvePoints; // points emitted by curve flattening, added to the device statistics on destroy
+#endif
+
+    uint32_t         segmentPtr;   // current segment count in current path having curves
+    uint32_t         subpathCount; // store count of subpath, not straight forward to retrieve from segmented path array
+    vkvg_convexity_t convexity;    // convexity test of the current subpath, PATH_IS_CONVEX_BIT is set on finish
 
-    bool     cmdStarted;     // prevent flushing empty renderpass
-    bool     pushCstDirty;   // prevent pushing to gpu if not requested
+    bool     cmdStarted;        // prevent flushing empty renderpass
+    bool     pendingTransition; // render pass transitions of the surface are recorded in the current cmd
+    bool     pushCstDirty;      // prevent pushing to gpu if not requested
+    float    matScale;          // cached greatest scale of the current matrix, 0 when the matrix changed.
 
     float    lineWidth;
     float    miterLimit;
+    float    tolerance;  // curves and arcs flattening tolerance in device pixels.
     uint32_t dashCount;  // value count in dash array, 0 if dash not set.
     float    dashOffset; // an offset for dash
     float   *dashes;     // an array of alternate lengths of on and off stroke.
@@ -220,21 +360,15 @@ typedef struct _vkvg_context_t {
     VkvgPattern    pattern;
 
     vkvg_context_save_t *pSavedCtxs;   // last ctx saved ptr
-    uint8_t              curSavBit;    // current stencil bit used to save context, 6 bits used by stencil for save/restore
-    VkhImage            *savedStencils;// additional image for saving contexes once more than 6 save/restore are reached
+    uint8_t              curSavBit;    // current stencil bit used to save context, STENCIL_SAVE_BIT_COUNT per stencil image
+    VkhImage            *savedStencils;// additional images saving contexes past STENCIL_SAVE_BIT_COUNT saves
     vkvg_clip_state_t    curClipState; // current clipping status relative to the previous saved one or clear state if
                                        // none.
 
     VkClearRect           clearRect;
-    VkRenderPassBeginInfo renderPassBeginInfo;
+    VkRenderPassBeginInfo renderPassBeginInfo; // framebuffer is owned by the context if stencil is a scratch one
 } vkvg_context;
 
-typedef struct _ear_clip_point {
-    vec2                    pos;
-    VKVG_IBO_INDEX_TYPE     idx;
-    struct _ear_clip_point *next;
-} ear_clip_point;
-
 typedef struct {
     bool     dashOn;
     uint32_t curDash;       // current dash index
@@ -252,10 +386,15 @@ typedef struct {
     float               hw;       // stroke half width, computed once.
     float               lhMax;    // miter limit * line width
     float arcStep; // cached arcStep, prevent compute multiple times for same stroke, 0 if not yet computed
+    uint32_t outlineCount; // outline points recorded in the tesselator arena for the analytic antialiasing
 } stroke_context_t;
 
+uint32_t _next_array_size(VkvgContext ctx, uint32_t size, uint32_t minSize, uint32_t granularity);
+void     _shrink_host_arrays(VkvgContext ctx);
+
 void _check_vertex_cache_size(VkvgContext ctx);
 void _ensure_vertex_cache_size(VkvgContext ctx, uint32_t addedVerticesCount);
+bool _ensure_point_array(VkvgContext ctx, uint32_t addedPoints);
 void _resize_vertex_cache(VkvgContext ctx, uint32_t newSize);
 
 void _check_index_cache_size(VkvgContext ctx);
@@ -268,6 +407,8 @@ bool _current_path_is_empty(VkvgContext ctx);
 void _finish_path(VkvgContext ctx);
 void _clear_path(VkvgContext ctx);
 void _remove_last_point(VkvgContext ctx);
+void _update_convexity(VkvgContext ctx, vec2 edge);
+bool _close_convexity(VkvgContext ctx, vec2 closingEdge);
 bool _path_is_closed(VkvgContext ctx, uint32_t ptrPath);
 void _set_curve_start(VkvgContext ctx);
 void _set_curve_end(VkvgContext ctx);
@@ -285,49 +426,97 @@ void  _draw_stoke_cap(VkvgContext ctx, stroke_context_t *str, vec2 p0, vec2 n, b
 void  _draw_segment(VkvgContext ctx, stroke_context_t *str, dash_context_t *dc, bool isCurve);
 float _draw_dashed_segment(VkvgContext ctx, stroke_context_t *str, dash_context_t *dc, bool isCurve);
 bool  _build_vb_step(VkvgContext ctx, stroke_context_t *str, bool isCurve);
+void  _add_stroke_fringe(VkvgContext ctx, stroke_context_t *str, bool closed);
 
 void _poly_fill(VkvgContext ctx, vec4 *bounds);
+bool _fill_with_stencil(VkvgContext ctx);
 void _fill_non_zero(VkvgContext ctx);
+#ifdef VKVG_FILL_NZ_SWEEP
+void _tess_fill(VkvgContext ctx, vkvg_fill_rule_t fillRule);
+#elif !defined(VKVG_FILL_NZ_GLUTESS)
+void _earcut_fill(VkvgContext ctx);
+#endif
+void *_tess_arena_reserve(VkvgContext ctx, size_t size);
+void  _tess_arena_release(VkvgContext ctx);
 void _draw_full_screen_quad(VkvgContext ctx, vec4 *scissor);
+void _add_edge_fringe(VkvgContext ctx, vec2 *ring, uint32_t count, bool inner);
+void _add_fill_fringes(VkvgContext ctx);
+bool _fill_fringes_on_stencil(VkvgContext ctx);
+void _add_stencil_fringes(VkvgContext ctx);
 
 void _create_gradient_buff(VkvgContext ctx);
-void _create_vertices_buff(VkvgContext ctx);
+void _create_vao_ring(VkvgContext ctx);
+void _destroy_vao_ring(VkvgContext ctx);
 void _add_vertex(VkvgContext ctx, Vertex v);
 void _add_vertexf(VkvgContext ctx, float x, float y);
 void _set_vertex(VkvgContext ctx, uint32_t idx, Vertex v);
 void _add_triangle_indices(VkvgContext ctx, VKVG_IBO_INDEX_TYPE i0, VKVG_IBO_INDEX_TYPE i1, VKVG_IBO_INDEX_TYPE i2);
+void _add_triangle_indices_unchecked(VkvgContext ctx, VKVG_IBO_INDEX_TYPE i0, VKVG_IBO_INDEX_TYPE i1,
+                                     VKVG_IBO_INDEX_TYPE i2);
 void _add_tri_indices_for_rect(VkvgContext ctx, VKVG_IBO_INDEX_TYPE i);
 
 void _vao_add_rectangle(VkvgContext ctx, float x, float y, float width, float height);
 
 void _bind_draw_pipeline(VkvgContext ctx);
-void _create_cmd_buff(VkvgContext ctx);
+void _bind_operator_pipeline(VkvgContext ctx, vkvg_operator_t op);
+bool _add_operator_range(VkvgContext ctx);
+void _emit_draw_cmds_by_operator(VkvgContext ctx, uint32_t firstIdx, int32_t vxOffset);
+bool _acquire_vao_segment(VkvgContext ctx);
+#ifdef VKVG_VAO_ZERO_COPY
+void _map_vao_segment(VkvgContext ctx);
+void _ensure_vao_mapped(VkvgContext ctx);
+void _unmap_vao_segment(VkvgContext ctx, uint32_t vxBase, uint32_t idxBase);
+#endif
 void _check_vao_size(VkvgContext ctx);
 void _flush_cmd_buff(VkvgContext ctx);
 void _ensure_renderpass_is_started(VkvgContext ctx);
 void _emit_draw_cmd_undrawn_vertices(VkvgContext ctx);
+void _transform_pending_vertices(VkvgContext ctx);
+void _prepare_matrix_change(VkvgContext ctx);
 void _flush_cmd_until_vx_base(VkvgContext ctx);
 bool _wait_ctx_flush_end(VkvgContext ctx);
 bool _wait_and_submit_cmd(VkvgContext ctx);
+uint64_t _get_flush_ticket(VkvgContext ctx);
+VkResult _wait_flush_ticket(VkvgContext ctx, uint64_t ticket, uint64_t timeout);
 void _update_push_constants(VkvgContext ctx);
 void _update_cur_pattern(VkvgContext ctx, VkvgPattern pat);
+void _update_vertex_color(VkvgContext ctx);
+uint32_t _fade_vertex_color(uint32_t color, float factor);
 void _set_mat_inv_and_vkCmdPush(VkvgContext ctx);
+float _get_matrix_scale(VkvgContext ctx);
 void _start_cmd_for_render_pass(VkvgContext ctx);
+void _begin_render_pass(VkvgContext ctx);
+void _execute_sub_context(VkvgContext ctx, VkvgContext sub);
+void _begin_sub_cmd(VkvgContext ctx);
+void _hand_over_sub_segment(VkvgContext ctx);
+void _release_pending_transition(VkvgContext ctx);
+void _submit_ctx_cmd(VkvgContext ctx);
+bool _insert_vao_segment(VkvgContext ctx);
+void _transition_source(VkvgContext ctx, VkvgSurface surf);
+VkResult _wait_vao_segment(VkvgContext ctx, vkvg_vao_segment_t *seg, uint64_t timeout);
+void _wait_sub_ctx_executed(VkvgContext ctx);
+void _bind_source_desc_set(VkvgContext ctx, VkDescriptorSet ds);
+VkDescriptorSet _get_source_desc_set(VkvgContext ctx, VkvgSurface surf, VkSampler sampler);
+void _reset_source_cache(VkvgContext ctx);
+void _release_completed_sources(VkvgContext ctx, uint64_t ticket);
+void _release_scratch_stencil(VkvgContext ctx);
 
 void _createDescriptorPool(VkvgContext ctx);
 void _init_descriptor_sets(VkvgContext ctx);
 void _update_descriptor_set(VkvgContext ctx, VkhImage img, VkDescriptorSet ds);
 void _update_gradient_desc_set(VkvgContext ctx);
 void _free_ctx_save(vkvg_context_save_t *sav);
+VkvgContext _alloc_context(VkvgDevice dev, bool secondary, uint32_t sizeHint);
 void _release_context_ressources(VkvgContext ctx);
 
 static inline float vec2_zcross(vec2 v1, vec2 v2) { return v1.x * v2.y - v1.y * v2.x; }
-static inline float ecp_zcross(ear_clip_point *p0, ear_clip_point *p1, ear_clip_point *p2) {
-    return vec2_zcross(vec2_sub(p1->pos, p0->pos), vec2_sub(p2->pos, p0->pos));
-}
 void _recursive_bezier(VkvgContext ctx, float distanceTolerance, float x1, float y1, float x2, float y2, float x3,
                        float y3, float x4, float y4, unsigned level);
 void _bezier(VkvgContext ctx, float x1, float y1, float x2, float y2, float x3, float y3, float x4, float y4);
+uint32_t _bezier_segment_count(float tolerance, const vec2 p[4]);
+void     _bezier_forward_diff(const vec2 p[4], uint32_t segments, vec2 *out);
+void _flatten_bezier(VkvgContext ctx, float tolerance, float x1, float y1, float x2, float y2, float x3, float y3,
+                     float x4, float y4);
 void _line_to(VkvgContext ctx, float x, float y);
 void _elliptic_arc(VkvgContext ctx, float x1, float y1, float x2, float y2, bool largeArc, bool counterClockWise,
                    float _rx, float _ry, float phi);
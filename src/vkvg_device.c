@@ -22,6 +22,7 @@
 
 #include "vkvg_device_internal.h"
 #include "vkvg_context_internal.h"
+#include "vkvg_pattern.h"
 #include "vkh_queue.h"
 #include "vkh_phyinfo.h"
 #include "vk_mem_alloc.h"
@@ -53,16 +54,84 @@ void vkvg_device_set_context_cache_size(VkvgDevice dev, uint32_t maxCount) {
         return;
 
     dev->cachedContextMaxCount = maxCount;
-
-    _cached_ctx *cur = dev->cachedContextLast;
-    while (cur && dev->cachedContextCount > dev->cachedContextMaxCount) {
-        _release_context_ressources(cur->ctx);
-        _cached_ctx *prev = cur;
-        cur               = cur->pNext;
-        free(prev);
-        dev->cachedContextCount--;
+    _device_trim_context_cache(dev, maxCount);
+}
+void vkvg_device_prewarm_contexts(VkvgDevice dev, uint32_t count, uint32_t vertexCount) {
+    if (vkvg_device_status(dev))
+        return;
+    for (uint32_t i = 0; i < count; i++) {
+        VkvgContext ctx = _alloc_context(dev, false, vertexCount);
+        if (ctx->status)
+            return;
+        if (!_device_store_context(ctx)) { // cache of this thread is full
+            _release_context_ressources(ctx);
+            return;
+        }
+        ctx->status = VKVG_STATUS_IN_CACHE;
     }
-    dev->cachedContextLast = cur;
+}
+void vkvg_device_set_shared_stencil(VkvgDevice dev, bool shared) {
+    if (vkvg_device_status(dev))
+        return;
+    dev->sharedStencil = shared;
+    if (!shared)
+        _device_destroy_scratch_stencils(dev);
+}
+void vkvg_device_set_surface_pool_size(VkvgDevice dev, uint32_t maxCount) {
+    if (vkvg_device_status(dev) || maxCount == dev->surfPoolMaxCount)
+        return;
+    _device_trim_surface_pool(dev, maxCount);
+}
+vkvg_surface_pool_stats_t vkvg_device_get_surface_pool_stats(VkvgDevice dev) {
+    if (vkvg_device_status(dev))
+        return (vkvg_surface_pool_stats_t){0};
+    LOCK_DEVICE
+    vkvg_surface_pool_stats_t stats = {dev->surfPoolCount, dev->surfPoolMaxCount, dev->surfPoolHits,
+                                       dev->surfPoolMisses};
+    UNLOCK_DEVICE
+    return stats;
+}
+vkvg_buffer_arena_stats_t vkvg_device_get_buffer_arena_stats(VkvgDevice dev) {
+    if (vkvg_device_status(dev))
+        return (vkvg_buffer_arena_stats_t){0};
+    if (dev->threadAware)
+        mtx_lock(&dev->arena.mutex);
+    vkvg_buffer_arena_stats_t stats = {dev->arena.blockCount, dev->arena.allocationCount, dev->arena.reservedBytes,
+                                       dev->arena.usedBytes};
+    if (dev->threadAware)
+        mtx_unlock(&dev->arena.mutex);
+    return stats;
+}
+void vkvg_device_set_buffer_ring_depth(VkvgDevice dev, uint32_t depth) {
+    if (vkvg_device_status(dev))
+        return;
+    dev->vaoRingDepth = MAX(1, depth);
+}
+void vkvg_device_set_array_growth_factor(VkvgDevice dev, float factor) {
+    if (vkvg_device_status(dev))
+        return;
+    dev->arrayGrowthFactor = MAX(1.0f, factor);
+}
+void vkvg_device_set_stencil_fill_threshold(VkvgDevice dev, uint32_t pointCount) {
+    if (vkvg_device_status(dev))
+        return;
+    dev->stencilFillThreshold = pointCount;
+}
+void vkvg_device_set_submit_batching(VkvgDevice dev, uint32_t threshold) {
+    if (vkvg_device_status(dev))
+        return;
+    LOCK_DEVICE
+    dev->batchThreshold = threshold;
+    if (dev->batchCount >= threshold)
+        _device_flush_batch(dev);
+    UNLOCK_DEVICE
+}
+void vkvg_device_submit_pending(VkvgDevice dev) {
+    if (vkvg_device_status(dev))
+        return;
+    LOCK_DEVICE
+    _device_flush_batch(dev);
+    UNLOCK_DEVICE
 }
 void _device_init(VkvgDevice dev, const vkvg_device_create_info_t *info) {
     dev->vkDev    = info->vkdev;
@@ -75,8 +144,13 @@ void _device_init(VkvgDevice dev, const vkvg_device_create_info_t *info) {
         dev->deferredResolve = false;
     else
         dev->deferredResolve = info->deferredResolve;
+    dev->analyticAA = info->analyticAA && dev->samples == VK_SAMPLE_COUNT_1_BIT;
 
     dev->cachedContextMaxCount = VKVG_MAX_CACHED_CONTEXT_COUNT;
+    dev->vaoRingDepth          = VKVG_VAO_RING_DEPTH;
+    dev->arrayGrowthFactor     = VKVG_ARRAY_GROWTH_FACTOR;
+    dev->stencilFillThreshold  = VKVG_STENCIL_FILL_THRESHOLD;
+    dev->batchId               = 1;
 
 #if VKVG_DBG_STATS
     dev->debug_stats = (vkvg_debug_stats_t){0};
@@ -98,7 +172,29 @@ void _device_init(VkvgDevice dev, const vkvg_device_create_info_t *info) {
     VkhPhyInfo phyInfos = vkh_phyinfo_create(dev->phy, NULL);
 
     dev->phyMemProps = phyInfos->memProps;
-    dev->gQueue      = vkh_queue_create(vkhd, info->qFamIdx, info->qIndex);
+    VkDeviceSize uboAlign = phyInfos->properties.limits.minUniformBufferOffsetAlignment;
+    if (uboAlign == 0)
+        uboAlign = 1;
+    dev->gradStride = (uint32_t)(((sizeof(vkvg_gradient_t) + uboAlign - 1) / uboAlign) * uboAlign);
+#ifdef VKVG_ENABLE_VK_TIMELINE_SEMAPHORE
+    // without thread awareness, a single queue is used. Requested queues are clamped to the ones of the family.
+    dev->queueCount = info->threadAware ? MIN(MAX(info->qCount, 1), VKVG_MAX_QUEUES) : 1;
+#else
+    // fences do not order the submissions of different queues, a context could sample a source surface still being
+    // drawn on another queue. Only timeline semaphores synchronize surfaces across the queue pool.
+    dev->queueCount = 1;
+#endif
+    if (info->qFamIdx < phyInfos->queueCount) {
+        uint32_t famQueueCount = phyInfos->queues[info->qFamIdx].queueCount;
+        if (info->qIndex + dev->queueCount > famQueueCount)
+            dev->queueCount = famQueueCount > info->qIndex ? famQueueCount - info->qIndex : 1;
+    }
+    for (uint32_t i = 0; i < dev->queueCount; i++) {
+        dev->queues[i] = vkh_queue_create(vkhd, info->qFamIdx, info->qIndex + i);
+        if (i > 0)
+            mtx_init(&dev->queueMutexes[i], mtx_plain);
+    }
+    dev->gQueue = dev->queues[0];
     // mtx_init (&dev->gQMutex, mtx_plain);
 
     vkh_phyinfo_destroy(phyInfos);
@@ -111,6 +207,10 @@ void _device_init(VkvgDevice dev, const vkvg_device_create_info_t *info) {
     dev->cmdPool = vkh_cmd_pool_create(vkhd, dev->gQueue->familyIndex, VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT);
     dev->cmd     = vkh_cmd_buff_create(vkhd, dev->cmdPool, VK_COMMAND_BUFFER_LEVEL_PRIMARY);
     dev->fence   = vkh_fence_create_signaled(vkhd);
+#ifndef VKVG_ENABLE_VK_TIMELINE_SEMAPHORE
+    for (uint32_t i = 0; i < VKVG_BATCH_FENCES; i++)
+        dev->batchFences[i] = vkh_fence_create_signaled(vkhd);
+#endif
 
     _device_create_pipeline_cache(dev);
     _fonts_cache_create(dev);
@@ -132,6 +232,7 @@ void _device_init(VkvgDevice dev, const vkvg_device_create_info_t *info) {
     _device_setupPipelines(dev);
 
     _device_create_empty_texture(dev, format, dev->supportedTiling);
+    _device_create_source_samplers(dev);
 
 #ifdef DEBUG
 #if defined(__linux__) && defined(__GLIBC__)
@@ -153,6 +254,8 @@ void _device_init(VkvgDevice dev, const vkvg_device_create_info_t *info) {
 
 #ifndef __APPLE__
     vkh_device_set_object_name(vkhd, VK_OBJECT_TYPE_PIPELINE, (uint64_t)dev->pipelinePolyFill, "PL Poly fill");
+    vkh_device_set_object_name(vkhd, VK_OBJECT_TYPE_PIPELINE, (uint64_t)dev->pipelineNzStencil, "PL NZ stencil");
+    vkh_device_set_object_name(vkhd, VK_OBJECT_TYPE_PIPELINE, (uint64_t)dev->pipelineNzResolve, "PL NZ resolve");
 #endif
     vkh_device_set_object_name(vkhd, VK_OBJECT_TYPE_PIPELINE, (uint64_t)dev->pipelineClipping, "PL Clipping");
     vkh_device_set_object_name(vkhd, VK_OBJECT_TYPE_PIPELINE, (uint64_t)dev->pipe_OVER, "PL draw Over");
@@ -300,7 +403,10 @@ VkvgDevice vkvg_device_create(vkvg_device_create_info_t *info) {
     dev->threadAware = info->threadAware;
     if (dev->threadAware) {
         mtx_init(&dev->mutex, mtx_plain);
+        for (uint32_t i = 0; i < VKVG_CTX_CACHE_BUCKETS; i++)
+            mtx_init(&dev->ctxCache[i].mutex, mtx_plain);
         mtx_init(&dev->fontCache->mutex, mtx_plain);
+        mtx_init(&dev->arena.mutex, mtx_plain);
         dev->threadAware = true;
     }
 
@@ -358,11 +464,17 @@ VkvgDevice vkvg_device_create(vkvg_device_create_info_t *info) {
             return dev;
         }
 
-        uint32_t                qCount        = 0;
-        float                   qPriorities[] = {0.0};
-        VkDeviceQueueCreateInfo pQueueInfos[] = {{0}, {0}, {0}};
+        uint32_t                qCount                       = 0;
+        float                   qPriorities[VKVG_MAX_QUEUES] = {0.0};
+        VkDeviceQueueCreateInfo pQueueInfos[]                = {{0}, {0}, {0}};
+#ifdef VKVG_ENABLE_VK_TIMELINE_SEMAPHORE
+        // thread aware devices use as many graphic queues as available to lower submission contention.
+        uint32_t gQueueCount = info->threadAware ? MIN(pi->queues[pi->gQueue].queueCount, VKVG_MAX_QUEUES) : 1;
+#else
+        uint32_t gQueueCount = 1;
+#endif
 
-        if (vkh_phyinfo_create_queues(pi, pi->gQueue, 1, qPriorities, &pQueueInfos[qCount]))
+        if (vkh_phyinfo_create_queues(pi, pi->gQueue, gQueueCount, qPriorities, &pQueueInfos[qCount]))
             qCount++;
 
         enabledExtsCount = 0;
@@ -393,6 +505,7 @@ VkvgDevice vkvg_device_create(vkvg_device_create_info_t *info) {
         info->vkdev   = vkh_device_get_vkdev(dev->vkhDev);
         info->qFamIdx = pi->gQueue;
         info->qIndex  = 0;
+        info->qCount  = gQueueCount;
     }
 
     _device_init(dev, info);
@@ -405,37 +518,29 @@ void vkvg_device_destroy(VkvgDevice dev) {
         LOG(VKVG_LOG_ERR, "DESTROY Device failed, see Status for info");
         return;
     }
-    LOCK_DEVICE
-    dev->references--;
-    if (dev->references > 0) {
-        UNLOCK_DEVICE
+    if (ATOMIC_DEC(dev->references) > 0)
         return;
-    }
-    UNLOCK_DEVICE
 
     LOG(VKVG_LOG_INFO, "DESTROY Device\n");
 
-    if (dev->cachedContextCount > 0) {
-        _cached_ctx *cur = dev->cachedContextLast;
-        while (cur) {
-            assert(cur->ctx->status == VKVG_STATUS_IN_CACHE);
-            cur->ctx->status = VKVG_STATUS_SUCCESS;
-            _release_context_ressources(cur->ctx);
-            _cached_ctx *prev = cur;
-            cur               = cur->pNext;
-            free(prev);
-        }
-    }
+    _device_trim_context_cache(dev, 0);
 
+    _device_flush_batch(dev);
     vkDeviceWaitIdle(dev->vkDev);
+    _device_trim_surface_pool(dev, 0);
+    _device_destroy_scratch_stencils(dev);
+    _arena_destroy(dev);
 
     vkh_image_destroy(dev->emptyImg);
+    _device_destroy_source_samplers(dev);
 
     vkDestroyDescriptorSetLayout(dev->vkDev, dev->dslGrad, NULL);
     vkDestroyDescriptorSetLayout(dev->vkDev, dev->dslFont, NULL);
     vkDestroyDescriptorSetLayout(dev->vkDev, dev->dslSrc, NULL);
 #ifndef __APPLE__
     vkDestroyPipeline(dev->vkDev, dev->pipelinePolyFill, NULL);
+    vkDestroyPipeline(dev->vkDev, dev->pipelineNzStencil, NULL);
+    vkDestroyPipeline(dev->vkDev, dev->pipelineNzResolve, NULL);
 #endif
     vkDestroyPipeline(dev->vkDev, dev->pipelineClipping, NULL);
 
@@ -456,11 +561,24 @@ void vkvg_device_destroy(VkvgDevice dev) {
 
     vkWaitForFences(dev->vkDev, 1, &dev->fence, VK_TRUE, UINT64_MAX);
     vkDestroyFence(dev->vkDev, dev->fence, NULL);
+#ifndef VKVG_ENABLE_VK_TIMELINE_SEMAPHORE
+    for (uint32_t i = 0; i < VKVG_BATCH_FENCES; i++)
+        vkDestroyFence(dev->vkDev, dev->batchFences[i], NULL);
+#endif
+    free(dev->batch);
+    free(dev->batchSubmitInfos);
+#ifdef VKVG_ENABLE_VK_TIMELINE_SEMAPHORE
+    free(dev->batchTimelineInfos);
+#endif
 
     vkFreeCommandBuffers(dev->vkDev, dev->cmdPool, 1, &dev->cmd);
     vkDestroyCommandPool(dev->vkDev, dev->cmdPool, NULL);
 
-    vkh_queue_destroy(dev->gQueue);
+    for (uint32_t i = 0; i < dev->queueCount; i++) {
+        vkh_queue_destroy(dev->queues[i]);
+        if (i > 0)
+            mtx_destroy(&dev->queueMutexes[i]);
+    }
 
     _font_cache_destroy(dev);
 
@@ -469,8 +587,11 @@ void vkvg_device_destroy(VkvgDevice dev) {
 #endif
 
     if (dev->threadAware) {
+        for (uint32_t i = 0; i < VKVG_CTX_CACHE_BUCKETS; i++)
+            mtx_destroy(&dev->ctxCache[i].mutex);
         mtx_destroy(&dev->mutex);
         mtx_destroy(&dev->fontCache->mutex);
+        mtx_destroy(&dev->arena.mutex);
     }
 
     if (dev->vkhDev) {
@@ -485,11 +606,8 @@ void vkvg_device_destroy(VkvgDevice dev) {
 
 vkvg_status_t vkvg_device_status(VkvgDevice dev) { return !dev ? VKVG_STATUS_NULL_POINTER : dev->status; }
 VkvgDevice    vkvg_device_reference(VkvgDevice dev) {
-    if (!vkvg_device_status(dev)) {
-        LOCK_DEVICE
-        dev->references++;
-        UNLOCK_DEVICE
-    }
+    if (!vkvg_device_status(dev))
+        ATOMIC_INC(dev->references);
     return dev;
 }
 uint32_t vkvg_device_get_reference_count(VkvgDevice dev) { return vkvg_device_status(dev) ? 0 : dev->references; }
@@ -28,6 +28,7 @@
 
 #include "vkvg_device_internal.h"
 #include "vkvg_context_internal.h"
+#include "vkvg_surface_internal.h"
 #include "shaders.h"
 
 uint32_t vkvg_log_level = VKVG_LOG_DEBUG;
@@ -48,6 +49,7 @@ PFN_vkCmdSetStencilReference   CmdSetStencilReference;
 PFN_vkCmdSetStencilWriteMask   CmdSetStencilWriteMask;
 PFN_vkCmdBeginRenderPass       CmdBeginRenderPass;
 PFN_vkCmdEndRenderPass         CmdEndRenderPass;
+PFN_vkCmdExecuteCommands       CmdExecuteCommands;
 PFN_vkCmdSetViewport           CmdSetViewport;
 PFN_vkCmdSetScissor            CmdSetScissor;
 
@@ -108,6 +110,15 @@ VkRenderPass _device_createRenderPassNoResolve(VkvgDevice dev, VkAttachmentLoadO
         {0, VK_SUBPASS_EXTERNAL, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
          VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, VK_ACCESS_MEMORY_READ_BIT,
          VK_DEPENDENCY_BY_REGION_BIT},
+        // successive context submissions are no longer cpu synchronized, previous attachments writes have to be
+        // completed before the next render pass on the same surface.
+        {VK_SUBPASS_EXTERNAL, 0,
+         VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+         VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT,
+         VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+         VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
+             VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+         VK_DEPENDENCY_BY_REGION_BIT},
     };
 
     VkRenderPassCreateInfo renderPassInfo = {.sType           = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO,
@@ -115,7 +126,7 @@ VkRenderPass _device_createRenderPassNoResolve(VkvgDevice dev, VkAttachmentLoadO
                                              .pAttachments    = attachments,
                                              .subpassCount    = 1,
                                              .pSubpasses      = &subpassDescription,
-                                             .dependencyCount = 2,
+                                             .dependencyCount = 3,
                                              .pDependencies   = dependencies};
     VkRenderPass           rp;
     VK_CHECK_RESULT(vkCreateRenderPass(dev->vkDev, &renderPassInfo, NULL, &rp));
@@ -165,6 +176,15 @@ VkRenderPass _device_createRenderPassMS(VkvgDevice dev, VkAttachmentLoadOp loadO
         {0, VK_SUBPASS_EXTERNAL, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
          VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, VK_ACCESS_MEMORY_READ_BIT,
          VK_DEPENDENCY_BY_REGION_BIT},
+        // successive context submissions are no longer cpu synchronized, previous attachments writes have to be
+        // completed before the next render pass on the same surface.
+        {VK_SUBPASS_EXTERNAL, 0,
+         VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+         VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT,
+         VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+         VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
+             VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+         VK_DEPENDENCY_BY_REGION_BIT},
     };
 
     VkRenderPassCreateInfo renderPassInfo = {.sType           = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO,
@@ -172,7 +192,7 @@ VkRenderPass _device_createRenderPassMS(VkvgDevice dev, VkAttachmentLoadOp loadO
                                              .pAttachments    = attachments,
                                              .subpassCount    = 1,
                                              .pSubpasses      = &subpassDescription,
-                                             .dependencyCount = 2,
+                                             .dependencyCount = 3,
                                              .pDependencies   = dependencies};
     VkRenderPass           rp;
     VK_CHECK_RESULT(vkCreateRenderPass(dev->vkDev, &renderPassInfo, NULL, &rp));
@@ -236,14 +256,37 @@ void _device_setupPipelines(VkvgDevice dev) {
                                         VK_COMPARE_OP_EQUAL,
                                         STENCIL_FILL_BIT,
                                         STENCIL_ALL_BIT,
-                                        0x2};
+                                        STENCIL_CLIP_BIT};
     VkStencilOpState stencilOpState  = {VK_STENCIL_OP_KEEP,
                                         VK_STENCIL_OP_ZERO,
                                         VK_STENCIL_OP_KEEP,
                                         VK_COMPARE_OP_EQUAL,
                                         STENCIL_FILL_BIT,
                                         STENCIL_FILL_BIT,
-                                        0x1};
+                                        STENCIL_FILL_BIT};
+    // non-zero: front faces increment and back faces decrement the winding counter of unclipped pixels.
+    VkStencilOpState nzFrontOpState  = {VK_STENCIL_OP_KEEP,
+                                        VK_STENCIL_OP_INCREMENT_AND_WRAP,
+                                        VK_STENCIL_OP_KEEP,
+                                        VK_COMPARE_OP_EQUAL,
+                                        STENCIL_CLIP_BIT,
+                                        STENCIL_WINDING_MASK,
+                                        0};
+    VkStencilOpState nzBackOpState   = {VK_STENCIL_OP_KEEP,
+                                        VK_STENCIL_OP_DECREMENT_AND_WRAP,
+                                        VK_STENCIL_OP_KEEP,
+                                        VK_COMPARE_OP_EQUAL,
+                                        STENCIL_CLIP_BIT,
+                                        STENCIL_WINDING_MASK,
+                                        0};
+    // non null counters are replaced by the fill bit, leaving the counter cleared for the next fill.
+    VkStencilOpState resolveOpState  = {VK_STENCIL_OP_KEEP,
+                                        VK_STENCIL_OP_REPLACE,
+                                        VK_STENCIL_OP_KEEP,
+                                        VK_COMPARE_OP_NOT_EQUAL,
+                                        STENCIL_WINDING_MASK,
+                                        STENCIL_WINDING_MASK | STENCIL_FILL_BIT,
+                                        STENCIL_FILL_BIT};
 
     VkPipelineDepthStencilStateCreateInfo dsStateCreateInfo = {
         .sType             = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO,
@@ -279,7 +322,11 @@ void _device_setupPipelines(VkvgDevice dev) {
 
     VkVertexInputAttributeDescription vertexInputAttributs[3] = {{0, 0, VK_FORMAT_R32G32_SFLOAT, 0},
                                                                  {1, 0, VK_FORMAT_R8G8B8A8_UNORM, 8},
+#ifdef VKVG_COMPACT_VERTEX
+                                                                 {2, 0, VK_FORMAT_R32_UINT, 12}};
+#else
                                                                  {2, 0, VK_FORMAT_R32G32B32_SFLOAT, 12}};
+#endif
 
     VkPipelineVertexInputStateCreateInfo vertexInputState = {
         .sType                           = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
@@ -347,17 +394,28 @@ void _device_setupPipelines(VkvgDevice dev) {
 #ifndef __APPLE__
     VK_CHECK_RESULT(vkCreateGraphicsPipelines(dev->vkDev, dev->pipelineCache, 1, &pipelineCreateInfo, NULL,
                                               &dev->pipelinePolyFill));
+
+    dsStateCreateInfo.front = nzFrontOpState;
+    dsStateCreateInfo.back  = nzBackOpState;
+    VK_CHECK_RESULT(vkCreateGraphicsPipelines(dev->vkDev, dev->pipelineCache, 1, &pipelineCreateInfo, NULL,
+                                              &dev->pipelineNzStencil));
 #endif
 
     inputAssemblyState.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+#ifndef __APPLE__
+    dsStateCreateInfo.back = dsStateCreateInfo.front = resolveOpState;
+    VK_CHECK_RESULT(vkCreateGraphicsPipelines(dev->vkDev, dev->pipelineCache, 1, &pipelineCreateInfo, NULL,
+                                              &dev->pipelineNzResolve));
+#endif
     dsStateCreateInfo.back = dsStateCreateInfo.front = clipingOpState;
     dynamicState.dynamicStateCount                   = 5;
     VK_CHECK_RESULT(vkCreateGraphicsPipelines(dev->vkDev, dev->pipelineCache, 1, &pipelineCreateInfo, NULL,
                                               &dev->pipelineClipping));
 
+    // draw pipelines stencil reference is dynamic for the fill fringes drawn outside of the stencil fill bits.
     dsStateCreateInfo.back = dsStateCreateInfo.front = stencilOpState;
     blendAttachmentState.colorWriteMask              = 0xf;
-    dynamicState.dynamicStateCount                   = 3;
+    dynamicState.dynamicStateCount                   = 4;
     pipelineCreateInfo.stageCount                    = 2;
     VK_CHECK_RESULT(
         vkCreateGraphicsPipelines(dev->vkDev, dev->pipelineCache, 1, &pipelineCreateInfo, NULL, &dev->pipe_OVER));
@@ -408,7 +466,7 @@ void _device_createDescriptorSetLayout(VkvgDevice dev) {
         .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO, .bindingCount = 1, .pBindings = &dsLayoutBinding};
     VK_CHECK_RESULT(vkCreateDescriptorSetLayout(dev->vkDev, &dsLayoutCreateInfo, NULL, &dev->dslFont));
     VK_CHECK_RESULT(vkCreateDescriptorSetLayout(dev->vkDev, &dsLayoutCreateInfo, NULL, &dev->dslSrc));
-    dsLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    dsLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
     VK_CHECK_RESULT(vkCreateDescriptorSetLayout(dev->vkDev, &dsLayoutCreateInfo, NULL, &dev->dslGrad));
 
     VkPushConstantRange pushConstantRange[] = {
@@ -426,68 +484,429 @@ void _device_createDescriptorSetLayout(VkvgDevice dev) {
     VK_CHECK_RESULT(vkCreatePipelineLayout(dev->vkDev, &pipelineLayoutCreateInfo, NULL, &dev->pipelineLayout));
 }
 
-void _device_wait_idle(VkvgDevice dev) { vkDeviceWaitIdle(dev->vkDev); }
+void _device_wait_idle(VkvgDevice dev) {
+    LOCK_DEVICE
+    _device_flush_batch(dev);
+    UNLOCK_DEVICE
+    vkDeviceWaitIdle(dev->vkDev);
+}
 void _device_wait_and_reset_device_fence(VkvgDevice dev) {
     vkWaitForFences(dev->vkDev, 1, &dev->fence, VK_TRUE, UINT64_MAX);
     ResetFences(dev->vkDev, 1, &dev->fence);
 }
 
-bool _device_try_get_cached_context(VkvgDevice dev, VkvgContext *pCtx) {
-    LOCK_DEVICE
+// contexts are cached per thread, the bucket of the calling thread is selected by hashing its id.
+static _ctx_cache_bucket *_device_get_cache_bucket(VkvgDevice dev, thrd_t thread) {
+    const uint8_t *bytes = (const uint8_t *)&thread;
+    uint32_t       hash  = 2166136261u;
+    for (uint32_t i = 0; i < sizeof(thrd_t); i++)
+        hash = (hash ^ bytes[i]) * 16777619u;
+    return &dev->ctxCache[hash % VKVG_CTX_CACHE_BUCKETS];
+}
+// select a cached context of the calling thread, its buffer capacity is the closest one above sizeHint if any,
+// else the biggest one.
+bool _device_try_get_cached_context(VkvgDevice dev, uint32_t sizeHint, VkvgContext *pCtx) {
+    *pCtx = NULL;
+    if (dev->cachedContextCount == 0)
+        return false;
+
+    thrd_t             curThread = thrd_current();
+    _ctx_cache_bucket *bucket    = _device_get_cache_bucket(dev, curThread);
+    if (dev->threadAware)
+        mtx_lock(&bucket->mutex);
+
+    _cached_ctx **pBest = NULL;
+    for (_cached_ctx **pCur = &bucket->last; *pCur; pCur = &(*pCur)->pNext) {
+        if (!thrd_equal((*pCur)->thread, curThread))
+            continue;
+        if (pBest == NULL) {
+            pBest = pCur;
+            continue;
+        }
+        uint32_t size = (*pCur)->ctx->sizeVBO, bestSize = (*pBest)->ctx->sizeVBO;
+        if (bestSize < sizeHint ? size > bestSize : size >= sizeHint && size < bestSize)
+            pBest = pCur;
+    }
+    _cached_ctx *cur = NULL;
+    if (pBest) {
+        cur    = *pBest;
+        *pBest = cur->pNext;
+    }
+    if (dev->threadAware)
+        mtx_unlock(&bucket->mutex);
+    if (cur == NULL)
+        return false;
+
+    uint32_t count = ATOMIC_DEC(dev->cachedContextCount);
+    LOG(VKVG_LOG_THREAD, "get cached context: %p, thd:%lu cached ctx: %d\n", cur->ctx, cur->thread, count);
+    *pCtx = cur->ctx;
+    free(cur);
+    return true;
+}
+// store a released context in the cache of the calling thread, return false if this cache is full.
+bool _device_store_context(VkvgContext ctx) {
+    VkvgDevice dev       = ctx->dev;
+    thrd_t     curThread = thrd_current();
+
+    _ctx_cache_bucket *bucket = _device_get_cache_bucket(dev, curThread);
+    if (dev->threadAware)
+        mtx_lock(&bucket->mutex);
+
+    int32_t threadCount = 0;
+    for (_cached_ctx *cur = bucket->last; cur; cur = cur->pNext) {
+        if (thrd_equal(cur->thread, curThread))
+            threadCount++;
+    }
+    _cached_ctx *cur = NULL;
+    if (threadCount < dev->cachedContextMaxCount)
+        cur = (_cached_ctx *)calloc(1, sizeof(_cached_ctx));
+    if (cur) {
+        cur->ctx     = ctx;
+        cur->thread  = curThread;
+        cur->pNext   = bucket->last;
+        bucket->last = cur;
+    }
+    if (dev->threadAware)
+        mtx_unlock(&bucket->mutex);
+    if (cur == NULL)
+        return false;
 
-    if (dev->cachedContextCount) {
-        thrd_t       curThread = thrd_current();
-        _cached_ctx *prev      = NULL;
-        _cached_ctx *cur       = dev->cachedContextLast;
-        while (cur) {
-            if (thrd_equal(cur->thread, curThread)) {
-                if (prev)
-                    prev->pNext = cur->pNext;
-                else
-                    dev->cachedContextLast = cur->pNext;
-
-                dev->cachedContextCount--;
-
-                LOG(VKVG_LOG_THREAD, "get cached context: %p, thd:%lu cached ctx: %d\n", cur->ctx, cur->thread,
-                    dev->cachedContextCount);
-
-                *pCtx = cur->ctx;
-                free(cur);
-                UNLOCK_DEVICE
-                return true;
+    uint32_t count = ATOMIC_INC(dev->cachedContextCount);
+    LOG(VKVG_LOG_THREAD, "store context: %p, thd:%lu cached ctx: %d\n", cur->ctx, cur->thread, count);
+
+    ctx->references++;
+    return true;
+}
+// release cached contexts until at most maxCount remain per thread.
+void _device_trim_context_cache(VkvgDevice dev, uint32_t maxCount) {
+    for (uint32_t i = 0; i < VKVG_CTX_CACHE_BUCKETS && dev->cachedContextCount > 0; i++) {
+        _ctx_cache_bucket *bucket = &dev->ctxCache[i];
+        if (dev->threadAware)
+            mtx_lock(&bucket->mutex);
+        _cached_ctx **pCur = &bucket->last;
+        while (*pCur) {
+            _cached_ctx *cur = *pCur;
+            // newest contexts are first, count the ones of the same thread kept before this one.
+            uint32_t threadCount = 0;
+            for (_cached_ctx *prev = bucket->last; prev != cur; prev = prev->pNext) {
+                if (thrd_equal(prev->thread, cur->thread))
+                    threadCount++;
             }
-            prev = cur;
-            cur  = cur->pNext;
+            if (threadCount < maxCount) {
+                pCur = &cur->pNext;
+                continue;
+            }
+            *pCur = cur->pNext;
+            ATOMIC_DEC(dev->cachedContextCount);
+            cur->ctx->status = VKVG_STATUS_SUCCESS;
+            _release_context_ressources(cur->ctx);
+            free(cur);
         }
+        if (dev->threadAware)
+            mtx_unlock(&bucket->mutex);
+    }
+}
+// Scratch stencils are used by one context at a time, from its creation to its destruction. Stencil content is
+// only relevant during the life of a context, it is cleared by the first render pass.
+VkhImage _device_acquire_scratch_stencil(VkvgDevice dev, uint32_t width, uint32_t height) {
+    VkhImage stencil = NULL;
+    LOCK_DEVICE
+    for (uint32_t i = 0; i < dev->scratchStencilCount; i++) {
+        VkhImage cur = dev->scratchStencils[i];
+        if (cur->infos.extent.width != width || cur->infos.extent.height != height)
+            continue;
+        stencil                   = cur;
+        dev->scratchStencils[i] = dev->scratchStencils[--dev->scratchStencilCount];
+        break;
     }
-    *pCtx = NULL;
     UNLOCK_DEVICE
-    return false;
+    if (!stencil)
+        stencil = _create_stencil_image(dev, width, height);
+    return stencil;
 }
-void _device_store_context(VkvgContext ctx) {
-    VkvgDevice dev = ctx->dev;
-
+// the context using the stencil must have no pending submission.
+void _device_release_scratch_stencil(VkvgDevice dev, VkhImage stencil) {
+    LOCK_DEVICE
+    if (dev->scratchStencilCount == dev->sizeScratchStencils) {
+        uint32_t  newSize = dev->sizeScratchStencils + 4;
+        VkhImage *tmp     = (VkhImage *)realloc(dev->scratchStencils, newSize * sizeof(VkhImage));
+        if (!tmp) {
+            UNLOCK_DEVICE
+            vkh_image_destroy(stencil);
+            return;
+        }
+        dev->scratchStencils     = tmp;
+        dev->sizeScratchStencils = newSize;
+    }
+    dev->scratchStencils[dev->scratchStencilCount++] = stencil;
+    UNLOCK_DEVICE
+}
+void _device_destroy_scratch_stencils(VkvgDevice dev) {
     LOCK_DEVICE
+    for (uint32_t i = 0; i < dev->scratchStencilCount; i++)
+        vkh_image_destroy(dev->scratchStencils[i]);
+    free(dev->scratchStencils);
+    dev->scratchStencils     = NULL;
+    dev->scratchStencilCount = dev->sizeScratchStencils = 0;
+    UNLOCK_DEVICE
+}
+// wait for the submissions made on a pooled surface before its destruction.
+static void _device_wait_pooled_surface(VkvgSurface surf) {
+#ifdef VKVG_ENABLE_VK_TIMELINE_SEMAPHORE
+    vkh_timeline_wait((VkhDevice)&surf->dev->vkDev, surf->timeline, surf->timelineStep);
+#else
+    WaitForFences(surf->dev->vkDev, 1, &surf->flushFence, VK_TRUE, VKVG_FENCE_TIMEOUT);
+    ResetFences(surf->dev->vkDev, 1, &surf->flushFence);
+#endif
+}
+// Surfaces are pooled per size, the sample count being common to all the surfaces of the device.
+// The newest matching surface is reused, once its last submission is complete.
+VkvgSurface _device_try_get_pooled_surface(VkvgDevice dev, uint32_t width, uint32_t height) {
+    if (vkvg_device_status(dev) || dev->surfPoolMaxCount == 0)
+        return NULL;
 
-    _cached_ctx *cur = (_cached_ctx *)calloc(1, sizeof(_cached_ctx));
-    cur->ctx         = ctx;
-    cur->thread      = thrd_current();
-    cur->pNext       = dev->cachedContextLast;
+    VkvgSurface surf = NULL;
+    LOCK_DEVICE
+    for (uint32_t i = dev->surfPoolCount; i > 0; i--) {
+        VkvgSurface cur = dev->surfPool[i - 1];
+        if (cur->width != width || cur->height != height)
+            continue;
+        surf = cur;
+        memmove(&dev->surfPool[i - 1], &dev->surfPool[i], (dev->surfPoolCount - i) * sizeof(VkvgSurface));
+        dev->surfPoolCount--;
+        break;
+    }
+    if (surf)
+        dev->surfPoolHits++;
+    else
+        dev->surfPoolMisses++;
+    UNLOCK_DEVICE
 
-    dev->cachedContextLast = cur;
-    dev->cachedContextCount++;
+    if (surf)
+        _device_wait_pooled_surface(surf);
+    return surf;
+}
+// Keep a surface whose last reference is released, the oldest pooled surface is destroyed if the pool is full.
+bool _device_store_surface(VkvgSurface surf) {
+    VkvgDevice dev = surf->dev;
+    if (dev->surfPoolMaxCount == 0 || surf->status || surf->format != FB_COLOR_FORMAT || surf->img->imported)
+        return false;
 
-    LOG(VKVG_LOG_THREAD, "store context: %p, thd:%lu cached ctx: %d\n", cur->ctx, cur->thread, dev->cachedContextCount);
+    // track the completion of all the work previously submitted on this surface.
+#ifdef VKVG_ENABLE_VK_TIMELINE_SEMAPHORE
+    _device_lock_queue(dev, surf->queueIdx); // submit queued batches for the surface timeline to reach its last step.
+    _device_unlock_queue(dev, surf->queueIdx);
+#else
+    _device_signal_fence(dev, surf->queueIdx, surf->flushFence);
+#endif
 
-    ctx->references++;
+    VkvgSurface evicted = NULL;
+    LOCK_DEVICE
+    if (dev->surfPoolMaxCount == 0) { // pooling disabled meanwhile
+        UNLOCK_DEVICE
+        return false;
+    }
+    if (dev->surfPoolCount == dev->surfPoolMaxCount) {
+        evicted = dev->surfPool[0];
+        memmove(&dev->surfPool[0], &dev->surfPool[1], (dev->surfPoolCount - 1) * sizeof(VkvgSurface));
+        dev->surfPoolCount--;
+    }
+    surf->status                         = VKVG_STATUS_IN_CACHE;
+    dev->surfPool[dev->surfPoolCount++] = surf;
+    UNLOCK_DEVICE
 
+    if (evicted) {
+        _device_wait_pooled_surface(evicted);
+        _release_surface_ressources(evicted);
+    }
+    return true;
+}
+// resize the pool to maxCount entries, releasing the oldest surfaces in excess.
+void _device_trim_surface_pool(VkvgDevice dev, uint32_t maxCount) {
+    LOCK_DEVICE
+    while (dev->surfPoolCount > maxCount) {
+        VkvgSurface surf = dev->surfPool[0];
+        memmove(&dev->surfPool[0], &dev->surfPool[1], (dev->surfPoolCount - 1) * sizeof(VkvgSurface));
+        dev->surfPoolCount--;
+        _device_wait_pooled_surface(surf);
+        _release_surface_ressources(surf);
+    }
+    if (maxCount == 0) {
+        free(dev->surfPool);
+        dev->surfPool = NULL;
+    } else {
+        VkvgSurface *tmp = (VkvgSurface *)realloc(dev->surfPool, maxCount * sizeof(VkvgSurface));
+        if (tmp)
+            dev->surfPool = tmp;
+        else
+            maxCount = dev->surfPoolMaxCount; // keep the previous pool size
+    }
+    dev->surfPoolMaxCount = maxCount;
     UNLOCK_DEVICE
 }
 void _device_submit_cmd(VkvgDevice dev, VkCommandBuffer *cmd, VkFence fence) {
+    _device_submit_cmd_to_queue(dev, 0, cmd, fence);
+}
+void _device_submit_cmd_to_queue(VkvgDevice dev, uint32_t queueIdx, VkCommandBuffer *cmd, VkFence fence) {
+    VkhQueue queue = _device_lock_queue(dev, queueIdx);
+    vkh_cmd_submit(queue, cmd, fence);
+    _device_unlock_queue(dev, queueIdx);
+}
+// empty submission, fence is signaled when all the work previously submitted to the queue is done.
+void _device_signal_fence(VkvgDevice dev, uint32_t queueIdx, VkFence fence) {
+    VkhQueue queue = _device_lock_queue(dev, queueIdx);
+    VK_CHECK_RESULT(vkQueueSubmit(queue->queue, 0, NULL, fence));
+    _device_unlock_queue(dev, queueIdx);
+}
+// queue index of a new surface, contexts submit to the queue of their surface so that its drawings stay ordered.
+uint32_t _device_next_queue(VkvgDevice dev) {
+    if (dev->queueCount < 2)
+        return 0;
     LOCK_DEVICE
-    vkh_cmd_submit(dev->gQueue, cmd, fence);
+    uint32_t queueIdx = dev->nextQueue;
+    dev->nextQueue    = (dev->nextQueue + 1) % dev->queueCount;
     UNLOCK_DEVICE
+    return queueIdx;
 }
+// lock a queue of the pool for submission. The first queue is guarded by the device mutex, and queued batches
+// are submitted first to keep submission order.
+VkhQueue _device_lock_queue(VkvgDevice dev, uint32_t queueIdx) {
+    if (queueIdx == 0) {
+        LOCK_DEVICE
+        _device_flush_batch(dev);
+        return dev->gQueue;
+    }
+    if (dev->threadAware)
+        mtx_lock(&dev->queueMutexes[queueIdx]);
+    return dev->queues[queueIdx];
+}
+void _device_unlock_queue(VkvgDevice dev, uint32_t queueIdx) {
+    if (queueIdx == 0) {
+        UNLOCK_DEVICE
+    } else if (dev->threadAware)
+        mtx_unlock(&dev->queueMutexes[queueIdx]);
+}
+// submit infos are grown with the queued submissions, so that flushing a batch needs no allocation.
+static bool _device_grow_batch(VkvgDevice dev) {
+    uint32_t               newSize = MAX(dev->batchThreshold, dev->sizeBatch * 2);
+    vkvg_batched_submit_t *batch =
+        (vkvg_batched_submit_t *)realloc(dev->batch, newSize * sizeof(vkvg_batched_submit_t));
+    if (batch == NULL)
+        return false;
+    dev->batch          = batch;
+    VkSubmitInfo *infos = (VkSubmitInfo *)realloc(dev->batchSubmitInfos, newSize * sizeof(VkSubmitInfo));
+    if (infos == NULL)
+        return false;
+    dev->batchSubmitInfos = infos;
+#ifdef VKVG_ENABLE_VK_TIMELINE_SEMAPHORE
+    VkTimelineSemaphoreSubmitInfo *timelineInfos = (VkTimelineSemaphoreSubmitInfo *)realloc(
+        dev->batchTimelineInfos, newSize * sizeof(VkTimelineSemaphoreSubmitInfo));
+    if (timelineInfos == NULL)
+        return false;
+    dev->batchTimelineInfos = timelineInfos;
+#endif
+    dev->sizeBatch = newSize;
+    return true;
+}
+// queue a context submission in the current batch and return the batch id, or 0 if the submission has not been
+// queued and has to be submitted by the caller. The batch is submitted when the threshold is reached, on explicit
+// request, or when a submission of the batch has to be waited for.
+uint64_t _device_queue_submit(VkvgDevice dev, vkvg_batched_submit_t *submit) {
+    uint64_t batchId = 0;
+    LOCK_DEVICE
+    if (dev->batchThreshold == 0) {
+        UNLOCK_DEVICE
+        return 0;
+    }
+    if (dev->batchCount == dev->sizeBatch && !_device_grow_batch(dev))
+        _device_flush_batch(dev); // make room
+    if (dev->batchCount < dev->sizeBatch) {
+        batchId                       = dev->batchId;
+        dev->batch[dev->batchCount++] = *submit;
+        if (dev->batchCount >= dev->batchThreshold)
+            _device_flush_batch(dev);
+    }
+    UNLOCK_DEVICE
+    return batchId;
+}
+#ifdef VKVG_ENABLE_VK_TIMELINE_SEMAPHORE
+static void _device_fill_submit_info(vkvg_batched_submit_t *submit, VkSubmitInfo *submitInfo,
+                                     VkTimelineSemaphoreSubmitInfo *timelineInfo) {
+    *timelineInfo = (VkTimelineSemaphoreSubmitInfo){.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO,
+                                                    .waitSemaphoreValueCount   = submit->semaphoreCount,
+                                                    .pWaitSemaphoreValues      = submit->waitValues,
+                                                    .signalSemaphoreValueCount = submit->semaphoreCount,
+                                                    .pSignalSemaphoreValues    = submit->signalValues};
+    *submitInfo   = (VkSubmitInfo){.sType                = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+                                   .pNext                = timelineInfo,
+                                   .waitSemaphoreCount   = submit->semaphoreCount,
+                                   .pWaitSemaphores      = submit->semaphores,
+                                   .pWaitDstStageMask    = submit->waitStages,
+                                   .commandBufferCount   = 1,
+                                   .pCommandBuffers      = &submit->cmd,
+                                   .signalSemaphoreCount = submit->semaphoreCount,
+                                   .pSignalSemaphores    = submit->semaphores};
+}
+// submit a context cmd alone to one of the queues of the pool.
+void _device_submit_timelined(VkvgDevice dev, uint32_t queueIdx, vkvg_batched_submit_t *submit) {
+    VkSubmitInfo                  submitInfo;
+    VkTimelineSemaphoreSubmitInfo timelineInfo;
+    _device_fill_submit_info(submit, &submitInfo, &timelineInfo);
+    VkhQueue queue = _device_lock_queue(dev, queueIdx);
+    VK_CHECK_RESULT(vkQueueSubmit(queue->queue, 1, &submitInfo, VK_NULL_HANDLE));
+    _device_unlock_queue(dev, queueIdx);
+}
+#endif
+// submit all the queued context submissions in a single vkQueueSubmit, device mutex must be locked.
+void _device_flush_batch(VkvgDevice dev) {
+    if (dev->batchCount == 0)
+        return;
+    uint32_t      count       = dev->batchCount;
+    VkSubmitInfo *submitInfos = dev->batchSubmitInfos;
+    for (uint32_t i = 0; i < count; i++) {
+#ifdef VKVG_ENABLE_VK_TIMELINE_SEMAPHORE
+        _device_fill_submit_info(&dev->batch[i], &submitInfos[i], &dev->batchTimelineInfos[i]);
+#else
+        submitInfos[i] = (VkSubmitInfo){
+            .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO, .commandBufferCount = 1, .pCommandBuffers = &dev->batch[i].cmd};
+#endif
+    }
+#ifdef VKVG_ENABLE_VK_TIMELINE_SEMAPHORE
+    VK_CHECK_RESULT(vkQueueSubmit(dev->gQueue->queue, count, submitInfos, VK_NULL_HANDLE));
+#else
+    // the fence was last used by the batch submitted VKVG_BATCH_FENCES submits ago.
+    VkFence fence = dev->batchFences[dev->batchId % VKVG_BATCH_FENCES];
+    WaitForFences(dev->vkDev, 1, &fence, VK_TRUE, UINT64_MAX);
+    ResetFences(dev->vkDev, 1, &fence);
+    VK_CHECK_RESULT(vkQueueSubmit(dev->gQueue->queue, count, submitInfos, fence));
+#endif
+    dev->batchCount = 0;
+    dev->batchId++;
+}
+// ensure the batch identified by batchId is submitted.
+void _device_submit_batch(VkvgDevice dev, uint64_t batchId) {
+    LOCK_DEVICE
+    if (batchId == dev->batchId)
+        _device_flush_batch(dev);
+    UNLOCK_DEVICE
+}
+#ifndef VKVG_ENABLE_VK_TIMELINE_SEMAPHORE
+// wait for the completion of the batch identified by batchId, submitting it if still queued.
+VkResult _device_wait_batch(VkvgDevice dev, uint64_t batchId, uint64_t timeout) {
+    LOCK_DEVICE
+    if (batchId == dev->batchId)
+        _device_flush_batch(dev);
+    // fences are waited for before being reused, so older batches are completed.
+    bool    done  = dev->batchId - batchId > VKVG_BATCH_FENCES;
+    VkFence fence = dev->batchFences[batchId % VKVG_BATCH_FENCES];
+    UNLOCK_DEVICE
+    if (done)
+        return VK_SUCCESS;
+    if (timeout == 0)
+        return vkGetFenceStatus(dev->vkDev, fence) == VK_SUCCESS ? VK_SUCCESS : VK_TIMEOUT;
+    return WaitForFences(dev->vkDev, 1, &fence, VK_TRUE, timeout);
+}
+#endif
 
 bool _device_init_function_pointers(VkvgDevice dev) {
 #if defined(DEBUG) && defined(VKVG_DBG_UTILS)
@@ -508,6 +927,7 @@ bool _device_init_function_pointers(VkvgDevice dev) {
     CmdSetStencilWriteMask   = GetVkProcAddress(dev->vkDev, dev->instance, vkCmdSetStencilWriteMask);
     CmdBeginRenderPass       = GetVkProcAddress(dev->vkDev, dev->instance, vkCmdBeginRenderPass);
     CmdEndRenderPass         = GetVkProcAddress(dev->vkDev, dev->instance, vkCmdEndRenderPass);
+    CmdExecuteCommands       = GetVkProcAddress(dev->vkDev, dev->instance, vkCmdExecuteCommands);
     CmdSetViewport           = GetVkProcAddress(dev->vkDev, dev->instance, vkCmdSetViewport);
     CmdSetScissor            = GetVkProcAddress(dev->vkDev, dev->instance, vkCmdSetScissor);
     CmdPushConstants         = GetVkProcAddress(dev->vkDev, dev->instance, vkCmdPushConstants);
@@ -534,6 +954,34 @@ void _device_create_empty_texture(VkvgDevice dev, VkFormat format, VkImageTiling
     vkh_cmd_end(dev->cmd);
     _device_submit_cmd(dev, &dev->cmd, dev->fence);
 }
+// surface sources descriptors use those samplers instead of the one of their image, so that a source may be
+// sampled with different modes by pending commands.
+void _device_create_source_samplers(VkvgDevice dev) {
+    const VkSamplerAddressMode addrModes[] = {
+        VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_BORDER, // VKVG_EXTEND_NONE
+        VK_SAMPLER_ADDRESS_MODE_REPEAT,          // VKVG_EXTEND_REPEAT
+        VK_SAMPLER_ADDRESS_MODE_MIRRORED_REPEAT, // VKVG_EXTEND_REFLECT
+        VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE    // VKVG_EXTEND_PAD
+    };
+    VkSamplerCreateInfo samplerCreateInfo = {.sType         = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO,
+                                             .mipmapMode    = VK_SAMPLER_MIPMAP_MODE_NEAREST,
+                                             .borderColor   = VK_BORDER_COLOR_FLOAT_TRANSPARENT_BLACK,
+                                             .maxAnisotropy = 1.0f};
+    for (uint32_t i = 0; i < VKVG_SOURCE_SAMPLER_COUNT; i++) {
+        samplerCreateInfo.magFilter = samplerCreateInfo.minFilter = (i & 1) ? VK_FILTER_LINEAR : VK_FILTER_NEAREST;
+        samplerCreateInfo.addressModeU = samplerCreateInfo.addressModeV = samplerCreateInfo.addressModeW =
+            addrModes[i >> 1];
+        VK_CHECK_RESULT(vkCreateSampler(dev->vkDev, &samplerCreateInfo, NULL, &dev->sourceSamplers[i]));
+    }
+}
+void _device_destroy_source_samplers(VkvgDevice dev) {
+    for (uint32_t i = 0; i < VKVG_SOURCE_SAMPLER_COUNT; i++)
+        vkDestroySampler(dev->vkDev, dev->sourceSamplers[i], NULL);
+}
+VkSampler _device_get_source_sampler(VkvgDevice dev, vkvg_extend_t extend, vkvg_filter_t filter) {
+    uint32_t linear = (filter == VKVG_FILTER_BILINEAR || filter == VKVG_FILTER_BEST) ? 1 : 0;
+    return dev->sourceSamplers[(extend << 1) + linear];
+}
 void _device_check_best_image_tiling(VkvgDevice dev, VkFormat format) {
     VkFlags            stencilFormats[] = {VK_FORMAT_S8_UINT, VK_FORMAT_D16_UNORM_S8_UINT, VK_FORMAT_D24_UNORM_S8_UINT,
                                            VK_FORMAT_D32_SFLOAT_S8_UINT};
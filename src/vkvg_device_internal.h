@@ -24,12 +24,25 @@
 
 #include "vkvg_internal.h"
 #include "vkvg_fonts.h"
+#include "vkvg_buffer_arena.h"
 
-#define STENCIL_FILL_BIT              0x1
-#define STENCIL_CLIP_BIT              0x2
-#define STENCIL_ALL_BIT               0x3
+// stencil layout: non-zero winding counter in the low bits (increments have to wrap inside it),
+// then the fill and clip bits, the remaining high bits save clipping states.
+#define STENCIL_WINDING_MASK          0x07
+#define STENCIL_FILL_BIT              0x08
+#define STENCIL_CLIP_BIT              0x10
+#define STENCIL_ALL_BIT               0x1F
+#define STENCIL_SAVE_BIT_SHIFT        5
+#define STENCIL_SAVE_BIT_COUNT        3 // clipping saves per stencil image
 
 #define VKVG_MAX_CACHED_CONTEXT_COUNT 2
+#define VKVG_VAO_RING_DEPTH           2 // default count of vertex/index buffer segments per context
+#define VKVG_ARRAY_GROWTH_FACTOR      2.0f // default growth factor of the context arrays
+#define VKVG_GRADIENT_RECORDS         64 // gradients a context may set between two waits on its submissions
+#define VKVG_SOURCE_SAMPLER_COUNT     8  // surface source samplers, one per extend mode and filtering
+#define VKVG_BATCH_FENCES             4  // device batches in flight tracked with their own fence
+#define VKVG_MAX_QUEUES               4  // graphic queues shared round-robin by the surfaces of a thread aware device
+#define VKVG_CTX_CACHE_BUCKETS        8  // context cache lists, threads are dispatched by a hash of their id
 
 extern PFN_vkCmdBindPipeline       CmdBindPipeline;
 extern PFN_vkCmdBindDescriptorSets CmdBindDescriptorSets;
@@ -44,6 +57,7 @@ extern PFN_vkCmdSetStencilReference   CmdSetStencilReference;
 extern PFN_vkCmdSetStencilWriteMask   CmdSetStencilWriteMask;
 extern PFN_vkCmdBeginRenderPass       CmdBeginRenderPass;
 extern PFN_vkCmdEndRenderPass         CmdEndRenderPass;
+extern PFN_vkCmdExecuteCommands       CmdExecuteCommands;
 extern PFN_vkCmdSetViewport           CmdSetViewport;
 extern PFN_vkCmdSetScissor            CmdSetScissor;
 
@@ -52,12 +66,30 @@ extern PFN_vkWaitForFences      WaitForFences;
 extern PFN_vkResetFences        ResetFences;
 extern PFN_vkResetCommandBuffer ResetCommandBuffer;
 
+// context submission queued in a device batch.
+typedef struct {
+    VkCommandBuffer cmd;
+#ifdef VKVG_ENABLE_VK_TIMELINE_SEMAPHORE
+    // target surface timeline, then the sampled sources ones. Arrays are owned by the vao segment of the submission.
+    uint32_t                    semaphoreCount;
+    const VkSemaphore          *semaphores;
+    const uint64_t             *waitValues;
+    const uint64_t             *signalValues;
+    const VkPipelineStageFlags *waitStages;
+#endif
+} vkvg_batched_submit_t;
+
 typedef struct _cached_ctx {
     thrd_t              thread;
     VkvgContext         ctx;
     struct _cached_ctx *pNext;
 } _cached_ctx;
 
+typedef struct {
+    mtx_t        mutex; // guard the list in thread aware mode, only threads sharing the bucket contend on it
+    _cached_ctx *last;  // last element of single linked list of saved contexts
+} _ctx_cache_bucket;
+
 typedef struct _vkvg_device_t {
     vkvg_status_t                    status;      /**< Current status of device, affected by last operation */
     VkDevice                         vkDev;       /**< Vulkan Logical Device */
@@ -77,7 +109,11 @@ typedef struct _vkvg_device_t {
 
     mtx_t    mutex;       /**< protect device access (queue, cahes, ...)from ctxs in separate threads */
     bool     threadAware; /**< if true, mutex is created and guard device queue and caches access */
-    VkhQueue gQueue;      /**< Vulkan Queue with Graphic flag */
+    VkhQueue gQueue;      /**< Vulkan Queue with Graphic flag, first queue of the pool guarded by the device mutex */
+    VkhQueue queues[VKVG_MAX_QUEUES];      /**< Queue pool, surfaces and their contexts submit to one of them */
+    mtx_t    queueMutexes[VKVG_MAX_QUEUES]; /**< guard the queues of the pool other than gQueue */
+    uint32_t queueCount;                   /**< Count of queues in the pool, 1 if gQueue is the only queue */
+    uint32_t nextQueue;                    /**< Round-robin index of the queue of the next surface */
 
     VkRenderPass renderPass; /**< Vulkan render pass, common for all surfaces */
     VkRenderPass
@@ -93,7 +129,11 @@ typedef struct _vkvg_device_t {
     VkPipeline pipe_SUB;
     VkPipeline pipe_CLEAR; /**< clear operator */
 
-    VkPipeline pipelinePolyFill; /**< even-odd polygon filling first step */
+    VkSampler sourceSamplers[VKVG_SOURCE_SAMPLER_COUNT]; /**< Samplers shared by surface sources descriptors */
+
+    VkPipeline pipelinePolyFill;   /**< even-odd polygon filling first step */
+    VkPipeline pipelineNzStencil;  /**< non-zero winding count on stencil, first step */
+    VkPipeline pipelineNzResolve;  /**< fold non-zero winding counts into the fill bit */
     VkPipeline pipelineClipping; /**< draw on stencil to update clipping regions */
 
     VkPipelineCache       pipelineCache;  /**< speed up startup by caching configured pipelines on disk */
@@ -110,15 +150,43 @@ typedef struct _vkvg_device_t {
     VkhImage           emptyImg;        /**< prevent unbound descriptor to trigger Validation error 61 */
     VkSampleCountFlags samples;         /**< samples count common to all surfaces */
     bool               deferredResolve; /**< if true, resolve only on context destruction and set as source */
+    bool               analyticAA;      /**< single sampled device feathering fill and stroke edges */
 
     _font_cache_t *fontCache; /**< Store everything relative to common font caching system */
 
     VkvgContext lastCtx; /**< last element of double linked list of context, used to trigger font caching system update
                             on all contexts*/
 
-    int32_t      cachedContextMaxCount; /**< Maximum context cache element count.*/
-    int32_t      cachedContextCount;    /**< Current context cache element count.*/
-    _cached_ctx *cachedContextLast;     /**< Last element of single linked list of saved context for fast reuse.*/
+    int32_t           cachedContextMaxCount; /**< Maximum context cache element count per thread.*/
+    uint32_t          cachedContextCount;    /**< Current context cache element count, atomically updated.*/
+    _ctx_cache_bucket ctxCache[VKVG_CTX_CACHE_BUCKETS]; /**< Saved contexts for fast reuse, per thread id hash.*/
+    bool      sharedStencil;        /**< if true, new surfaces have no stencil, contexts use a scratch one.*/
+    VkhImage *scratchStencils;      /**< Scratch stencils not used by a context, reused by size.*/
+    uint32_t  scratchStencilCount;  /**< Current count of unused scratch stencils.*/
+    uint32_t  sizeScratchStencils;  /**< Allocated count of the unused scratch stencils array.*/
+    VkvgSurface *surfPool;         /**< Destroyed surfaces kept for reuse by vkvg_surface_create, oldest first.*/
+    uint32_t     surfPoolCount;    /**< Current count of pooled surfaces.*/
+    uint32_t     surfPoolMaxCount; /**< Maximum count of pooled surfaces, 0 if pooling is disabled.*/
+    uint32_t     surfPoolHits;     /**< Surface creations served by the pool.*/
+    uint32_t     surfPoolMisses;   /**< Surface creations that allocated new ressources while pooling is enabled.*/
+    uint32_t     vaoRingDepth;          /**< Vertex and index buffer ring depth of newly created contexts.*/
+    float        arrayGrowthFactor;     /**< Size factor applied when context arrays and buffers have to grow.*/
+    uint32_t     stencilFillThreshold;  /**< Point count above which concave pathes are filled on the stencil.*/
+    uint32_t     gradStride; /**< Size of a gradient record in context uniform buffers, aligned for dynamic offsets.*/
+    vkvg_buffer_arena_t arena; /**< Sub allocator of the context vertex, index and gradient buffers.*/
+
+    uint32_t               batchThreshold; /**< Queued submissions triggering a batch submit, 0 if batching is disabled.*/
+    vkvg_batched_submit_t *batch;          /**< Context submissions queued for the next batch submit.*/
+    uint32_t               batchCount;     /**< Current count of queued submissions.*/
+    uint32_t               sizeBatch;      /**< Allocated count of queued submissions.*/
+    VkSubmitInfo          *batchSubmitInfos; /**< Submit infos of the queued submissions, sized as the batch.*/
+#ifdef VKVG_ENABLE_VK_TIMELINE_SEMAPHORE
+    VkTimelineSemaphoreSubmitInfo *batchTimelineInfos; /**< Timeline values of the queued submissions.*/
+#endif
+    uint64_t               batchId;        /**< Id of the batch being queued, submitted batches have lower ids.*/
+#ifndef VKVG_ENABLE_VK_TIMELINE_SEMAPHORE
+    VkFence batchFences[VKVG_BATCH_FENCES]; /**< Batch completion fences, batch id modulo fence count.*/
+#endif
 
 #ifdef VKVG_WIRED_DEBUG
     VkPipeline pipelineWired;
@@ -139,6 +207,9 @@ typedef struct _vkvg_device_t {
 bool _device_try_get_phyinfo(VkhPhyInfo *phys, uint32_t phyCount, VkPhysicalDeviceType gpuType, VkhPhyInfo *phy);
 bool _device_init_function_pointers(VkvgDevice dev);
 void _device_create_empty_texture(VkvgDevice dev, VkFormat format, VkImageTiling tiling);
+void _device_create_source_samplers(VkvgDevice dev);
+void _device_destroy_source_samplers(VkvgDevice dev);
+VkSampler _device_get_source_sampler(VkvgDevice dev, vkvg_extend_t extend, vkvg_filter_t filter);
 void _device_get_best_image_tiling(VkvgDevice dev, VkFormat format, VkImageTiling *pTiling);
 void _device_check_best_image_tiling(VkvgDevice dev, VkFormat format);
 void _device_create_pipeline_cache(VkvgDevice dev);
@@ -150,7 +221,30 @@ void         _device_createDescriptorSetLayout(VkvgDevice dev);
 void         _device_wait_idle(VkvgDevice dev);
 void         _device_wait_and_reset_device_fence(VkvgDevice dev);
 void         _device_submit_cmd(VkvgDevice dev, VkCommandBuffer *cmd, VkFence fence);
+void         _device_submit_cmd_to_queue(VkvgDevice dev, uint32_t queueIdx, VkCommandBuffer *cmd, VkFence fence);
+void         _device_signal_fence(VkvgDevice dev, uint32_t queueIdx, VkFence fence);
+uint32_t     _device_next_queue(VkvgDevice dev);
+VkhQueue     _device_lock_queue(VkvgDevice dev, uint32_t queueIdx);
+void         _device_unlock_queue(VkvgDevice dev, uint32_t queueIdx);
+uint64_t     _device_queue_submit(VkvgDevice dev, vkvg_batched_submit_t *submit);
+#ifdef VKVG_ENABLE_VK_TIMELINE_SEMAPHORE
+void         _device_submit_timelined(VkvgDevice dev, uint32_t queueIdx, vkvg_batched_submit_t *submit);
+#endif
+void         _device_submit_batch(VkvgDevice dev, uint64_t batchId);
+void         _device_flush_batch(VkvgDevice dev);
+#ifndef VKVG_ENABLE_VK_TIMELINE_SEMAPHORE
+VkResult _device_wait_batch(VkvgDevice dev, uint64_t batchId, uint64_t timeout);
+#endif
+
+bool _device_try_get_cached_context(VkvgDevice dev, uint32_t sizeHint, VkvgContext *pCtx);
+bool _device_store_context(VkvgContext ctx);
+void _device_trim_context_cache(VkvgDevice dev, uint32_t maxCount);
+
+VkhImage _device_acquire_scratch_stencil(VkvgDevice dev, uint32_t width, uint32_t height);
+void     _device_release_scratch_stencil(VkvgDevice dev, VkhImage stencil);
+void     _device_destroy_scratch_stencils(VkvgDevice dev);
 
-bool _device_try_get_cached_context(VkvgDevice dev, VkvgContext *pCtx);
-void _device_store_context(VkvgContext ctx);
+VkvgSurface _device_try_get_pooled_surface(VkvgDevice dev, uint32_t width, uint32_t height);
+bool        _device_store_surface(VkvgSurface surf);
+void        _device_trim_surface_pool(VkvgDevice dev, uint32_t maxCount);
 #endif
@@ -0,0 +1,628 @@
+/*
+ * Copyright (c) 2018-2022 Jean-Philippe Bruyère <jp_bruyere@hotmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the
+ * Software, and to permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+// Ear clipper for the non-zero fill when no tesselator is enabled, after mapbox earcut. Rings are kept in circular
+// linked lists, candidate ears are only tested against the points whose z-order hash falls inside the ear bounds,
+// which keeps the clipping near linear on large polygons. Holes are bridged to their outer ring before clipping,
+// and polygons the clipper cannot reduce are cured from local self-intersections, then split in two.
+
+#include "vkvg_context_internal.h"
+#include "vkvg_device_internal.h"
+
+#if !defined(VKVG_FILL_NZ_SWEEP) && !defined(VKVG_FILL_NZ_GLUTESS)
+
+#define EARCUT_HASH_THRESHOLD 80  // point count above which ears are searched with the z-order hash
+#define EARCUT_BLOCK_SIZE     256 // nodes per overflow block, when splits exhaust the arena
+
+typedef struct _earcut_node_t {
+    float                  x, y;
+    VKVG_IBO_INDEX_TYPE    i;            // vertex index
+    uint32_t               z;            // z-order curve value
+    struct _earcut_node_t *prev, *next;  // ring
+    struct _earcut_node_t *prevZ, *nextZ; // ring nodes sorted by z-order
+} earcut_node_t;
+
+typedef struct _earcut_block_t {
+    struct _earcut_block_t *next;
+    uint32_t                count;
+    earcut_node_t           nodes[EARCUT_BLOCK_SIZE];
+} earcut_block_t;
+
+typedef struct {
+    uint32_t first;     // first point of the ring in the context points
+    uint32_t count;     // point count
+    float    area;      // signed area, in the earcut convention
+    vec4     bounds;
+    bool     hole;      // true if bridged in a larger ring
+    int32_t  firstHole; // first ring bridged in this one, -1 if none
+    int32_t  nextHole;  // next hole of the same outer ring
+} earcut_ring_t;
+
+typedef struct {
+    VkvgContext         ctx;
+    VKVG_IBO_INDEX_TYPE firstVertIdx;
+    earcut_node_t      *nodes; // nodes in the arena
+    uint32_t            nodeCount;
+    uint32_t            nodeCapacity;
+    earcut_block_t     *blocks;    // overflow nodes, allocated only by polygon splits
+    earcut_block_t     *curBlock;  // block in use
+    float               minX, minY;
+    float               invSize;   // z-order scale, 0 when the polygon is too small to be hashed
+} earcut_t;
+
+static inline float _earcut_area(const earcut_node_t *p, const earcut_node_t *q, const earcut_node_t *r) {
+    return (q->y - p->y) * (r->x - q->x) - (q->x - p->x) * (r->y - q->y);
+}
+static inline bool _earcut_equals(const earcut_node_t *a, const earcut_node_t *b) {
+    return a->x == b->x && a->y == b->y;
+}
+static inline int _earcut_sign(float v) { return (v > 0) - (v < 0); }
+
+static inline bool _earcut_pt_in_triangle(float ax, float ay, float bx, float by, float cx, float cy, float px,
+                                          float py) {
+    return (cx - px) * (ay - py) >= (ax - px) * (cy - py) && (ax - px) * (by - py) >= (bx - px) * (ay - py) &&
+           (bx - px) * (cy - py) >= (cx - px) * (by - py);
+}
+// interleave the bits of the coordinates scaled to 16 bits.
+static uint32_t _earcut_z_order(const earcut_t *ec, float x, float y) {
+    uint32_t ix = (uint32_t)((x - ec->minX) * ec->invSize), iy = (uint32_t)((y - ec->minY) * ec->invSize);
+    ix          = (ix | (ix << 8)) & 0x00FF00FF;
+    ix          = (ix | (ix << 4)) & 0x0F0F0F0F;
+    ix          = (ix | (ix << 2)) & 0x33333333;
+    ix          = (ix | (ix << 1)) & 0x55555555;
+    iy          = (iy | (iy << 8)) & 0x00FF00FF;
+    iy          = (iy | (iy << 4)) & 0x0F0F0F0F;
+    iy          = (iy | (iy << 2)) & 0x33333333;
+    iy          = (iy | (iy << 1)) & 0x55555555;
+    return ix | (iy << 1);
+}
+
+// make sure count nodes may be created, the arena is sized for rings and bridges, splits may need more.
+static bool _earcut_reserve(earcut_t *ec, uint32_t count) {
+    if (ec->nodeCapacity - ec->nodeCount >= count)
+        return true;
+    if (ec->curBlock && EARCUT_BLOCK_SIZE - ec->curBlock->count >= count)
+        return true;
+    earcut_block_t *b = ec->curBlock ? ec->curBlock->next : ec->blocks;
+    if (!b) {
+        b = (earcut_block_t *)malloc(sizeof(earcut_block_t));
+        if (!b) {
+            ec->ctx->status = VKVG_STATUS_NO_MEMORY;
+            return false;
+        }
+        b->next = NULL;
+        if (ec->curBlock)
+            ec->curBlock->next = b;
+        else
+            ec->blocks = b;
+    }
+    b->count     = 0;
+    ec->curBlock = b;
+    return true;
+}
+static earcut_node_t *_earcut_new_node(earcut_t *ec, VKVG_IBO_INDEX_TYPE i, float x, float y) {
+    earcut_node_t *p;
+    if (ec->nodeCount < ec->nodeCapacity)
+        p = &ec->nodes[ec->nodeCount++];
+    else
+        p = &ec->curBlock->nodes[ec->curBlock->count++];
+    p->x = x;
+    p->y = y;
+    p->i = i;
+    p->z = 0;
+    p->prev = p->next = p->prevZ = p->nextZ = NULL;
+    return p;
+}
+static earcut_node_t *_earcut_insert_node(earcut_t *ec, VKVG_IBO_INDEX_TYPE i, vec2 pos, earcut_node_t *last) {
+    earcut_node_t *p = _earcut_new_node(ec, i, pos.x, pos.y);
+    if (!last) {
+        p->prev = p;
+        p->next = p;
+    } else {
+        p->next          = last->next;
+        p->prev          = last;
+        last->next->prev = p;
+        last->next       = p;
+    }
+    return p;
+}
+static void _earcut_remove_node(earcut_node_t *p) {
+    p->next->prev = p->prev;
+    p->prev->next = p->next;
+    if (p->prevZ)
+        p->prevZ->nextZ = p->nextZ;
+    if (p->nextZ)
+        p->nextZ->prevZ = p->prevZ;
+}
+// link the ring points with the requested orientation, outer rings and holes are linked in opposite orientations.
+static earcut_node_t *_earcut_linked_list(earcut_t *ec, const earcut_ring_t *r, bool clockwise) {
+    const vec2    *pts  = &ec->ctx->points[r->first];
+    earcut_node_t *last = NULL;
+    if (clockwise == (r->area > 0)) {
+        for (uint32_t i = 0; i < r->count; i++)
+            last = _earcut_insert_node(ec, ec->firstVertIdx + r->first + i, pts[i], last);
+    } else {
+        for (uint32_t i = r->count; i > 0; i--)
+            last = _earcut_insert_node(ec, ec->firstVertIdx + r->first + i - 1, pts[i - 1], last);
+    }
+    if (last && _earcut_equals(last, last->next)) {
+        _earcut_remove_node(last);
+        last = last->next;
+    }
+    return last;
+}
+// remove duplicated and collinear points.
+static earcut_node_t *_earcut_filter_points(earcut_node_t *start, earcut_node_t *end) {
+    if (!start)
+        return start;
+    if (!end)
+        end = start;
+    earcut_node_t *p = start;
+    bool           again;
+    do {
+        again = false;
+        if (_earcut_equals(p, p->next) || _earcut_area(p->prev, p, p->next) == 0) {
+            _earcut_remove_node(p);
+            p = end = p->prev;
+            if (p == p->next)
+                break;
+            again = true;
+        } else
+            p = p->next;
+    } while (again || p != end);
+    return end;
+}
+
+static bool _earcut_on_segment(const earcut_node_t *p, const earcut_node_t *q, const earcut_node_t *r) {
+    return q->x <= fmaxf(p->x, r->x) && q->x >= fminf(p->x, r->x) && q->y <= fmaxf(p->y, r->y) &&
+           q->y >= fminf(p->y, r->y);
+}
+static bool _earcut_intersects(const earcut_node_t *p1, const earcut_node_t *q1, const earcut_node_t *p2,
+                               const earcut_node_t *q2) {
+    int o1 = _earcut_sign(_earcut_area(p1, q1, p2));
+    int o2 = _earcut_sign(_earcut_area(p1, q1, q2));
+    int o3 = _earcut_sign(_earcut_area(p2, q2, p1));
+    int o4 = _earcut_sign(_earcut_area(p2, q2, q1));
+    if (o1 != o2 && o3 != o4)
+        return true;
+    return (o1 == 0 && _earcut_on_segment(p1, p2, q1)) || (o2 == 0 && _earcut_on_segment(p1, q2, q1)) ||
+           (o3 == 0 && _earcut_on_segment(p2, p1, q2)) || (o4 == 0 && _earcut_on_segment(p2, q1, q2));
+}
+static bool _earcut_intersects_polygon(const earcut_node_t *a, const earcut_node_t *b) {
+    const earcut_node_t *p = a;
+    do {
+        if (p->i != a->i && p->next->i != a->i && p->i != b->i && p->next->i != b->i &&
+            _earcut_intersects(p, p->next, a, b))
+            return true;
+        p = p->next;
+    } while (p != a);
+    return false;
+}
+static bool _earcut_locally_inside(const earcut_node_t *a, const earcut_node_t *b) {
+    return _earcut_area(a->prev, a, a->next) < 0
+               ? _earcut_area(a, b, a->next) >= 0 && _earcut_area(a, a->prev, b) >= 0
+               : _earcut_area(a, b, a->prev) < 0 || _earcut_area(a, a->next, b) < 0;
+}
+static bool _earcut_middle_inside(const earcut_node_t *a, const earcut_node_t *b) {
+    const earcut_node_t *p      = a;
+    bool                 inside = false;
+    float                px = (a->x + b->x) / 2, py = (a->y + b->y) / 2;
+    do {
+        if (((p->y > py) != (p->next->y > py)) && p->next->y != p->y &&
+            (px < (p->next->x - p->x) * (py - p->y) / (p->next->y - p->y) + p->x))
+            inside = !inside;
+        p = p->next;
+    } while (p != a);
+    return inside;
+}
+static bool _earcut_valid_diagonal(const earcut_node_t *a, const earcut_node_t *b) {
+    return a->next->i != b->i && a->prev->i != b->i && !_earcut_intersects_polygon(a, b) &&
+           ((_earcut_locally_inside(a, b) && _earcut_locally_inside(b, a) && _earcut_middle_inside(a, b) &&
+             (_earcut_area(a->prev, a, b->prev) != 0 || _earcut_area(a, b->prev, b) != 0)) ||
+            (_earcut_equals(a, b) && _earcut_area(a->prev, a, a->next) > 0 && _earcut_area(b->prev, b, b->next) > 0));
+}
+// link a and b with a bridge, the ring is split in two, return the second one.
+static earcut_node_t *_earcut_split_polygon(earcut_t *ec, earcut_node_t *a, earcut_node_t *b) {
+    earcut_node_t *a2 = _earcut_new_node(ec, a->i, a->x, a->y);
+    earcut_node_t *b2 = _earcut_new_node(ec, b->i, b->x, b->y);
+    earcut_node_t *an = a->next, *bp = b->prev;
+    a->next  = b;
+    b->prev  = a;
+    a2->next = an;
+    an->prev = a2;
+    b2->next = a2;
+    a2->prev = b2;
+    bp->next = b2;
+    b2->prev = bp;
+    return b2;
+}
+
+static bool _earcut_is_ear(const earcut_node_t *ear) {
+    const earcut_node_t *a = ear->prev, *b = ear, *c = ear->next;
+    if (_earcut_area(a, b, c) >= 0)
+        return false; // reflex
+    float x0 = fminf(a->x, fminf(b->x, c->x)), y0 = fminf(a->y, fminf(b->y, c->y));
+    float x1 = fmaxf(a->x, fmaxf(b->x, c->x)), y1 = fmaxf(a->y, fmaxf(b->y, c->y));
+    for (const earcut_node_t *p = c->next; p != a; p = p->next) {
+        if (p->x >= x0 && p->x <= x1 && p->y >= y0 && p->y <= y1 &&
+            _earcut_pt_in_triangle(a->x, a->y, b->x, b->y, c->x, c->y, p->x, p->y) &&
+            _earcut_area(p->prev, p, p->next) >= 0)
+            return false;
+    }
+    return true;
+}
+static inline bool _earcut_blocks_ear(const earcut_node_t *p, const earcut_node_t *a, const earcut_node_t *b,
+                                      const earcut_node_t *c, const vec4 *bounds) {
+    return p->x >= bounds->xMin && p->x <= bounds->xMax && p->y >= bounds->yMin && p->y <= bounds->yMax &&
+           p != a && p != c && _earcut_pt_in_triangle(a->x, a->y, b->x, b->y, c->x, c->y, p->x, p->y) &&
+           _earcut_area(p->prev, p, p->next) >= 0;
+}
+// same as _earcut_is_ear, only the nodes whose z-order is in the ear bounds range are tested.
+static bool _earcut_is_ear_hashed(const earcut_t *ec, const earcut_node_t *ear) {
+    const earcut_node_t *a = ear->prev, *b = ear, *c = ear->next;
+    if (_earcut_area(a, b, c) >= 0)
+        return false;
+    vec4     bounds = {fminf(a->x, fminf(b->x, c->x)), fminf(a->y, fminf(b->y, c->y)), fmaxf(a->x, fmaxf(b->x, c->x)),
+                       fmaxf(a->y, fmaxf(b->y, c->y))};
+    uint32_t minZ   = _earcut_z_order(ec, bounds.xMin, bounds.yMin);
+    uint32_t maxZ   = _earcut_z_order(ec, bounds.xMax, bounds.yMax);
+
+    const earcut_node_t *p = ear->prevZ, *n = ear->nextZ;
+    while (p && p->z >= minZ && n && n->z <= maxZ) {
+        if (_earcut_blocks_ear(p, a, b, c, &bounds))
+            return false;
+        p = p->prevZ;
+        if (_earcut_blocks_ear(n, a, b, c, &bounds))
+            return false;
+        n = n->nextZ;
+    }
+    for (; p && p->z >= minZ; p = p->prevZ)
+        if (_earcut_blocks_ear(p, a, b, c, &bounds))
+            return false;
+    for (; n && n->z <= maxZ; n = n->nextZ)
+        if (_earcut_blocks_ear(n, a, b, c, &bounds))
+            return false;
+    return true;
+}
+// bottom-up merge sort of the z-order list.
+static void _earcut_sort_linked(earcut_node_t *list) {
+    uint32_t inSize = 1, numMerges;
+    do {
+        earcut_node_t *p = list, *tail = NULL;
+        list             = NULL;
+        numMerges        = 0;
+        while (p) {
+            numMerges++;
+            earcut_node_t *q     = p;
+            uint32_t       pSize = 0;
+            for (uint32_t i = 0; i < inSize && q; i++) {
+                pSize++;
+                q = q->nextZ;
+            }
+            uint32_t qSize = inSize;
+            while (pSize > 0 || (qSize > 0 && q)) {
+                earcut_node_t *e;
+                if (pSize != 0 && (qSize == 0 || !q || p->z <= q->z)) {
+                    e = p;
+                    p = p->nextZ;
+                    pSize--;
+                } else {
+                    e = q;
+                    q = q->nextZ;
+                    qSize--;
+                }
+                if (tail)
+                    tail->nextZ = e;
+                else
+                    list = e;
+                e->prevZ = tail;
+                tail     = e;
+            }
+            p = q;
+        }
+        tail->nextZ = NULL;
+        inSize *= 2;
+    } while (numMerges > 1);
+}
+static void _earcut_index_curve(const earcut_t *ec, earcut_node_t *start) {
+    earcut_node_t *p = start;
+    do {
+        if (p->z == 0)
+            p->z = _earcut_z_order(ec, p->x, p->y);
+        p->prevZ = p->prev;
+        p->nextZ = p->next;
+        p        = p->next;
+    } while (p != start);
+    p->prevZ->nextZ = NULL;
+    p->prevZ        = NULL;
+    _earcut_sort_linked(p);
+}
+
+// clip the two edges crossing at a local self-intersection.
+static earcut_node_t *_earcut_cure_local_intersections(earcut_t *ec, earcut_node_t *start) {
+    earcut_node_t *p = start;
+    do {
+        earcut_node_t *a = p->prev, *b = p->next->next;
+        if (!_earcut_equals(a, b) && _earcut_intersects(a, p, p->next, b) && _earcut_locally_inside(a, b) &&
+            _earcut_locally_inside(b, a)) {
+            _add_triangle_indices_unchecked(ec->ctx, a->i, p->i, b->i);
+            _earcut_remove_node(p);
+            _earcut_remove_node(p->next);
+            p = start = b;
+        }
+        p = p->next;
+    } while (p != start);
+    return _earcut_filter_points(p, NULL);
+}
+
+static void _earcut_linked(earcut_t *ec, earcut_node_t *ear, int pass);
+
+// try splitting the polygon along a valid diagonal and clip both halves.
+static void _earcut_split(earcut_t *ec, earcut_node_t *start) {
+    earcut_node_t *a = start;
+    do {
+        for (earcut_node_t *b = a->next->next; b != a->prev; b = b->next) {
+            if (a->i != b->i && _earcut_valid_diagonal(a, b)) {
+                if (!_earcut_reserve(ec, 2))
+                    return;
+                earcut_node_t *c = _earcut_split_polygon(ec, a, b);
+                a                = _earcut_filter_points(a, a->next);
+                c                = _earcut_filter_points(c, c->next);
+                _earcut_linked(ec, a, 0);
+                _earcut_linked(ec, c, 0);
+                return;
+            }
+        }
+        a = a->next;
+    } while (a != start);
+}
+static void _earcut_linked(earcut_t *ec, earcut_node_t *ear, int pass) {
+    if (!ear)
+        return;
+    if (!pass && ec->invSize > 0)
+        _earcut_index_curve(ec, ear);
+
+    earcut_node_t *stop = ear;
+    while (ear->prev != ear->next) {
+        earcut_node_t *prev = ear->prev, *next = ear->next;
+        if (ec->invSize > 0 ? _earcut_is_ear_hashed(ec, ear) : _earcut_is_ear(ear)) {
+            _add_triangle_indices_unchecked(ec->ctx, prev->i, ear->i, next->i);
+            _earcut_remove_node(ear);
+            ear = stop = next->next;
+            continue;
+        }
+        ear = next;
+        if (ear == stop) {
+            // no ear found in a full turn: remove degenerated points, then cure self-intersections, then split.
+            if (pass == 0)
+                _earcut_linked(ec, _earcut_filter_points(ear, NULL), 1);
+            else if (pass == 1)
+                _earcut_linked(ec, _earcut_cure_local_intersections(ec, _earcut_filter_points(ear, NULL)), 2);
+            else
+                _earcut_split(ec, ear);
+            break;
+        }
+    }
+}
+
+static earcut_node_t *_earcut_leftmost(earcut_node_t *start) {
+    earcut_node_t *p = start, *leftmost = start;
+    do {
+        if (p->x < leftmost->x || (p->x == leftmost->x && p->y < leftmost->y))
+            leftmost = p;
+        p = p->next;
+    } while (p != start);
+    return leftmost;
+}
+static bool _earcut_sector_contains_sector(const earcut_node_t *m, const earcut_node_t *p) {
+    return _earcut_area(m->prev, m, p->prev) < 0 && _earcut_area(p->next, m, m->next) < 0;
+}
+// find the outer ring node visible from the leftmost point of the hole.
+static earcut_node_t *_earcut_hole_bridge(earcut_node_t *hole, earcut_node_t *outerNode) {
+    earcut_node_t *p = outerNode, *m = NULL;
+    float          hx = hole->x, hy = hole->y, qx = -FLT_MAX;
+    // ray cast to the left of the hole to find the nearest segment intersection
+    do {
+        if (hy <= p->y && hy >= p->next->y && p->next->y != p->y) {
+            float x = p->x + (hy - p->y) * (p->next->x - p->x) / (p->next->y - p->y);
+            if (x <= hx && x > qx) {
+                qx = x;
+                m  = p->x < p->next->x ? p : p->next;
+                if (x == hx)
+                    return m; // hole touches the outer segment
+            }
+        }
+        p = p->next;
+    } while (p != outerNode);
+    if (!m)
+        return NULL;
+
+    // points inside the triangle of the hole point, the intersection and the segment end may hide it,
+    // the one with the smallest angle to the ray is kept.
+    earcut_node_t *stop = m;
+    float          mx = m->x, my = m->y, tanMin = FLT_MAX;
+    p = m;
+    do {
+        if (hx >= p->x && p->x >= mx && hx != p->x &&
+            _earcut_pt_in_triangle(hy < my ? hx : qx, hy, mx, my, hy < my ? qx : hx, hy, p->x, p->y)) {
+            float tan = fabsf(hy - p->y) / (hx - p->x);
+            if (_earcut_locally_inside(p, hole) &&
+                (tan < tanMin ||
+                 (tan == tanMin && (p->x > m->x || (p->x == m->x && _earcut_sector_contains_sector(m, p)))))) {
+                m      = p;
+                tanMin = tan;
+            }
+        }
+        p = p->next;
+    } while (p != stop);
+    return m;
+}
+static uint32_t _earcut_next_path(VkvgContext ctx, uint32_t ptrPath) {
+    uint32_t pathPointCount = ctx->pathes[ptrPath] & PATH_ELT_MASK;
+    if (!_path_has_curves(ctx, ptrPath))
+        return ptrPath + 1;
+    // skip segments lengths used in stroke
+    ptrPath++;
+    uint32_t totPts = 0;
+    while (totPts < pathPointCount)
+        totPts += (ctx->pathes[ptrPath++] & PATH_ELT_MASK);
+    return ptrPath;
+}
+static int _earcut_cmp_x(const void *a, const void *b) {
+    float xa = (*(earcut_node_t *const *)a)->x, xb = (*(earcut_node_t *const *)b)->x;
+    return (xa > xb) - (xa < xb);
+}
+static int _earcut_cmp_rings(const void *a, const void *b) {
+    float aa = fabsf(((const earcut_ring_t *)a)->area), ab = fabsf(((const earcut_ring_t *)b)->area);
+    return (aa < ab) - (aa > ab);
+}
+static bool _earcut_ring_contains(const vec2 *pts, const earcut_ring_t *r, vec2 p) {
+    if (p.x < r->bounds.xMin || p.x > r->bounds.xMax || p.y < r->bounds.yMin || p.y > r->bounds.yMax)
+        return false;
+    bool inside = false;
+    for (uint32_t i = 0, j = r->count - 1; i < r->count; j = i++) {
+        vec2 a = pts[r->first + i], b = pts[r->first + j];
+        if ((a.y > p.y) != (b.y > p.y) && p.x < (b.x - a.x) * (p.y - a.y) / (b.y - a.y) + a.x)
+            inside = !inside;
+    }
+    return inside;
+}
+
+// triangulate the current path with the non-zero rule. Subpaths are sorted by decreasing area, a subpath inside a
+// larger one of opposite orientation is a hole bridged to it, other subpaths are clipped on their own.
+void _earcut_fill(VkvgContext ctx) {
+    uint32_t ringCount = 0;
+    for (uint32_t ptrPath = 0; ptrPath < ctx->pathPtr; ptrPath = _earcut_next_path(ctx, ptrPath))
+        ringCount++;
+
+    size_t   ringsSize = (ringCount * sizeof(earcut_ring_t) + 15) & ~(size_t)15;
+    uint32_t nodeCount = ctx->pointCount + 2 * ringCount;
+    uint8_t *arena     = (uint8_t *)_tess_arena_reserve(ctx, ringsSize + ringCount * sizeof(earcut_node_t *) +
+                                                                 nodeCount * sizeof(earcut_node_t));
+    if (!arena)
+        return;
+    earcut_ring_t  *rings = (earcut_ring_t *)arena;
+    earcut_node_t **queue = (earcut_node_t **)(arena + ringsSize);
+    earcut_t        ec    = {ctx, (VKVG_IBO_INDEX_TYPE)(ctx->vertCount - ctx->curVertOffset),
+                             (earcut_node_t *)(queue + ringCount), 0, nodeCount};
+
+    // degenerated rings, without area or with non finite coordinates, are skipped.
+    uint32_t validRings = 0, firstPtIdx = 0;
+    for (uint32_t ptrPath = 0; ptrPath < ctx->pathPtr; ptrPath = _earcut_next_path(ctx, ptrPath)) {
+        earcut_ring_t *r = &rings[validRings];
+        r->first         = firstPtIdx;
+        r->count         = ctx->pathes[ptrPath] & PATH_ELT_MASK;
+        r->area          = 0;
+        r->bounds        = (vec4){FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX};
+        r->firstHole     = -1;
+        r->hole          = false;
+        firstPtIdx += r->count;
+        if (r->count < 3)
+            continue;
+        for (uint32_t i = 0, j = r->count - 1; i < r->count; j = i++) {
+            vec2 a = ctx->points[r->first + i], b = ctx->points[r->first + j];
+            r->area += (b.x - a.x) * (a.y + b.y);
+            r->bounds.xMin = fminf(r->bounds.xMin, a.x);
+            r->bounds.yMin = fminf(r->bounds.yMin, a.y);
+            r->bounds.xMax = fmaxf(r->bounds.xMax, a.x);
+            r->bounds.yMax = fmaxf(r->bounds.yMax, a.y);
+        }
+        if (r->area != 0 && isfinite(r->area) && isfinite(r->bounds.xMax - r->bounds.xMin) &&
+            isfinite(r->bounds.yMax - r->bounds.yMin))
+            validRings++;
+    }
+    if (!validRings)
+        return;
+
+    qsort(rings, validRings, sizeof(earcut_ring_t), _earcut_cmp_rings);
+    for (uint32_t i = 1; i < validRings; i++) {
+        earcut_ring_t *r = &rings[i];
+        for (int32_t o = (int32_t)i - 1; o >= 0; o--) {
+            earcut_ring_t *outer = &rings[o];
+            if (outer->hole || (outer->area > 0) == (r->area > 0) ||
+                !_earcut_ring_contains(ctx->points, outer, ctx->points[r->first]))
+                continue;
+            r->hole          = true;
+            r->nextHole      = outer->firstHole;
+            outer->firstHole = (int32_t)i;
+            break;
+        }
+    }
+
+    _ensure_vertex_cache_size(ctx, ctx->pointCount);
+    _ensure_index_cache_size(ctx, 3 * nodeCount);
+    Vertex v = {{0}, ctx->vxColor, VKVG_VERTEX_NO_UV};
+    for (uint32_t i = 0; i < ctx->pointCount; i++) {
+        v.pos = ctx->points[i];
+        _set_vertex(ctx, ctx->vertCount++, v);
+    }
+
+    for (uint32_t o = 0; o < validRings; o++) {
+        earcut_ring_t *outer = &rings[o];
+        if (outer->hole)
+            continue;
+        ec.nodeCount = 0;
+        ec.curBlock  = NULL;
+
+        earcut_node_t *outerNode = _earcut_linked_list(&ec, outer, true);
+        if (!outerNode || outerNode->next == outerNode->prev)
+            continue;
+
+        vec4     bounds    = outer->bounds;
+        uint32_t holeCount = 0;
+        for (int32_t h = outer->firstHole; h >= 0; h = rings[h].nextHole) {
+            // holes are found by their first point, they may still cross the outer ring.
+            bounds.xMin         = fminf(bounds.xMin, rings[h].bounds.xMin);
+            bounds.yMin         = fminf(bounds.yMin, rings[h].bounds.yMin);
+            bounds.xMax         = fmaxf(bounds.xMax, rings[h].bounds.xMax);
+            bounds.yMax         = fmaxf(bounds.yMax, rings[h].bounds.yMax);
+            earcut_node_t *list = _earcut_linked_list(&ec, &rings[h], false);
+            if (list && list->next != list->prev)
+                queue[holeCount++] = _earcut_leftmost(list);
+        }
+        qsort(queue, holeCount, sizeof(earcut_node_t *), _earcut_cmp_x);
+        for (uint32_t h = 0; h < holeCount; h++) {
+            earcut_node_t *bridge = _earcut_hole_bridge(queue[h], outerNode);
+            if (!bridge)
+                continue;
+            earcut_node_t *bridgeReverse = _earcut_split_polygon(&ec, bridge, queue[h]);
+            _earcut_filter_points(bridgeReverse, bridgeReverse->next);
+            outerNode = _earcut_filter_points(bridge, bridge->next);
+        }
+
+        ec.invSize = 0;
+        if (ec.nodeCount > EARCUT_HASH_THRESHOLD) {
+            float size = fmaxf(bounds.xMax - bounds.xMin, bounds.yMax - bounds.yMin);
+            ec.minX    = bounds.xMin;
+            ec.minY    = bounds.yMin;
+            ec.invSize = size > 0 ? 65535.0f / size : 0;
+        }
+        _earcut_linked(&ec, outerNode, 0);
+    }
+
+    while (ec.blocks) {
+        earcut_block_t *next = ec.blocks->next;
+        free(ec.blocks);
+        ec.blocks = next;
+    }
+}
+#endif
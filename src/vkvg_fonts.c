@@ -200,6 +200,8 @@ void _flush_chars_to_tex(VkvgDevice dev, _vkvg_font_t *f) {
     VK_CHECK_RESULT(vkEndCommandBuffer(cache->cmd));
 
     _device_submit_cmd(dev, &cache->cmd, cache->uploadFence);
+    if (dev->queueCount > 1) // contexts submitting to other queues are not ordered after the upload.
+        vkWaitForFences(dev->vkDev, 1, &cache->uploadFence, VK_TRUE, UINT64_MAX);
 
     f->curLine.penX += cache->stagingX;
     cache->stagingX = 0;
@@ -686,10 +688,17 @@ void _font_cache_destroy_text_run(VkvgText textRun) {
 }
 #ifdef DEBUG
 void _show_texture(vkvg_context *ctx) {
+#ifdef VKVG_COMPACT_VERTEX
+    Vertex vs[] = {{{0, 0}, 0, VKVG_PACK_UV(0, 0, 0)},
+                   {{0, FONT_PAGE_SIZE}, 0, VKVG_PACK_UV(0, FONT_PAGE_SIZE, 0)},
+                   {{FONT_PAGE_SIZE, 0}, 0, VKVG_PACK_UV(FONT_PAGE_SIZE, 0, 0)},
+                   {{FONT_PAGE_SIZE, FONT_PAGE_SIZE}, 0, VKVG_PACK_UV(FONT_PAGE_SIZE, FONT_PAGE_SIZE, 0)}};
+#else
     Vertex vs[] = {{{0, 0}, 0, {0, 0, 0}},
                    {{0, FONT_PAGE_SIZE}, 0, {0, 1, 0}},
                    {{FONT_PAGE_SIZE, 0}, 0, {1, 0, 0}},
                    {{FONT_PAGE_SIZE, FONT_PAGE_SIZE}, 0, {1, 1, 0}}};
+#endif
 
     VKVG_IBO_INDEX_TYPE firstIdx = (VKVG_IBO_INDEX_TYPE)(ctx->vertCount - ctx->curVertOffset);
     Vertex             *pVert    = &ctx->vertexCache[ctx->vertCount];
@@ -710,12 +719,15 @@ void _font_cache_show_text_run(VkvgContext ctx, VkvgText tr) {
     glyph_count                   = tr->glyph_count;
 #endif
 
-    Vertex v   = {{0}, ctx->curColor, {0, 0, -1}};
+    Vertex v   = {{0}, ctx->vxColor, VKVG_VERTEX_NO_UV};
     vec2   pen = {0, 0};
 
     if (!_current_path_is_empty(ctx))
         pen = _get_current_position(ctx);
 
+#ifdef VKVG_VAO_ZERO_COPY
+    _ensure_vao_mapped(ctx);
+#endif
     LOCK_FONTCACHE(ctx->dev)
 
     for (uint32_t i = 0; i < glyph_count; ++i) {
@@ -726,14 +738,38 @@ void _font_cache_show_text_run(VkvgContext ctx, VkvgText tr) {
             cr = _prepare_char(tr->dev, tr, glyph_info[i].codepoint);
 #endif
 
-        float uvWidth  = cr->bounds.width / (float)FONT_PAGE_SIZE;
-        float uvHeight = cr->bounds.height / (float)FONT_PAGE_SIZE;
-        vec2  p0       = {pen.x + cr->bmpDiff.x + (tr->glyphs[i].x_offset >> 6),
-                          pen.y - cr->bmpDiff.y + (tr->glyphs[i].y_offset >> 6)};
-        v.pos          = p0;
+        vec2 p0 = {pen.x + cr->bmpDiff.x + (tr->glyphs[i].x_offset >> 6),
+                   pen.y - cr->bmpDiff.y + (tr->glyphs[i].y_offset >> 6)};
+        v.pos   = p0;
 
         VKVG_IBO_INDEX_TYPE firstIdx = (VKVG_IBO_INDEX_TYPE)(ctx->vertCount - ctx->curVertOffset);
 
+#ifdef VKVG_COMPACT_VERTEX
+        // glyph bitmaps are at integer texel positions in the font cache.
+        uint32_t u0 = (uint32_t)(cr->bounds.x * FONT_PAGE_SIZE + 0.5f);
+        uint32_t v0 = (uint32_t)(cr->bounds.y * FONT_PAGE_SIZE + 0.5f);
+        uint32_t u1 = u0 + (uint32_t)cr->bounds.width;
+        uint32_t v1 = v0 + (uint32_t)cr->bounds.height;
+
+        v.uv = VKVG_PACK_UV(u0, v0, cr->pageIdx);
+        _add_vertex(ctx, v);
+
+        v.pos.y += cr->bounds.height;
+        v.uv = VKVG_PACK_UV(u0, v1, cr->pageIdx);
+        _add_vertex(ctx, v);
+
+        v.pos.x += cr->bounds.width;
+        v.pos.y = p0.y;
+        v.uv    = VKVG_PACK_UV(u1, v0, cr->pageIdx);
+        _add_vertex(ctx, v);
+
+        v.pos.y += cr->bounds.height;
+        v.uv = VKVG_PACK_UV(u1, v1, cr->pageIdx);
+        _add_vertex(ctx, v);
+#else
+        float uvWidth  = cr->bounds.width / (float)FONT_PAGE_SIZE;
+        float uvHeight = cr->bounds.height / (float)FONT_PAGE_SIZE;
+
         v.uv.x = cr->bounds.x;
         v.uv.y = cr->bounds.y;
         v.uv.z = cr->pageIdx;
@@ -752,6 +788,7 @@ void _font_cache_show_text_run(VkvgContext ctx, VkvgText tr) {
         v.pos.y += cr->bounds.height;
         v.uv.y += uvHeight;
         _add_vertex(ctx, v);
+#endif
 
         _add_tri_indices_for_rect(ctx, firstIdx);
 
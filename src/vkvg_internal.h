@@ -71,6 +71,16 @@
 #define ROUND_DOWN(v, p)   (floorf(v * p) / p)
 #define EQUF(a, b)         (fabsf(a - (b)) <= FLT_EPSILON)
 
+// lock free reference counting of objects shared between threads, return the new value.
+#ifdef _MSC_VER
+#include <intrin.h>
+#define ATOMIC_INC(v) ((uint32_t)_InterlockedIncrement((volatile long *)&(v)))
+#define ATOMIC_DEC(v) ((uint32_t)_InterlockedDecrement((volatile long *)&(v)))
+#else
+#define ATOMIC_INC(v) __atomic_add_fetch(&(v), 1, __ATOMIC_ACQ_REL)
+#define ATOMIC_DEC(v) __atomic_sub_fetch(&(v), 1, __ATOMIC_ACQ_REL)
+#endif
+
 #ifndef MAX
 #define MAX(a, b) ((a) > (b) ? (a) : (b))
 #endif
@@ -81,8 +91,8 @@
 #include "deps/tinycthread.h"
 #include "cross_os.h"
 // width of the stencil buffer will determine the number of context saving/restore layers
-// the two first bits of the stencil are the FILL and the CLIP bits, all other bits are
-// used to store clipping bit on context saving. 8 bit stencil will allow 6 save/restore layer
+// the low bits of the stencil are the winding counter, the FILL and the CLIP bits, all other bits are
+// used to store clipping bit on context saving. 8 bit stencil will allow 3 save/restore layer
 #define FB_COLOR_FORMAT VK_FORMAT_B8G8R8A8_UNORM
 #define VKVG_SURFACE_IMGS_REQUIREMENTS                                                                                 \
     (VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT | VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BIT |                                    \
@@ -107,4 +117,5 @@ static vkvg_status_t _vkvg_status_null_pointer    = VKVG_STATUS_NULL_POINTER;
 static vkvg_status_t _vkvg_status_invalid_dev_ci  = VKVG_STATUS_INVALID_DEVICE_CREATE_INFO;
 static vkvg_status_t _vkvg_status_device_error    = VKVG_STATUS_DEVICE_ERROR;
 static vkvg_status_t _vkvg_status_invalid_surface = VKVG_STATUS_INVALID_SURFACE;
+static vkvg_status_t _vkvg_status_invalid_status  = VKVG_STATUS_INVALID_STATUS;
 
@@ -36,7 +36,17 @@ void vkvg_surface_clear(VkvgSurface surf) {
 }
 
 VkvgSurface vkvg_surface_create(VkvgDevice dev, uint32_t width, uint32_t height) {
-    VkvgSurface surf = _create_surface(dev, FB_COLOR_FORMAT);
+    VkvgSurface surf = _device_try_get_pooled_surface(dev, MAX(1, width), MAX(1, height));
+    if (surf) {
+        surf->references = 1;
+        surf->newSurf    = true;
+        vkvg_device_reference(dev);
+        _transition_surf_images(surf);
+        surf->status = VKVG_STATUS_SUCCESS;
+        return surf;
+    }
+
+    surf = _create_surface(dev, FB_COLOR_FORMAT);
     if (surf->status)
         return surf;
 
@@ -203,47 +213,22 @@ void vkvg_surface_destroy(VkvgSurface surf) {
         return;
     }
 
-    LOCK_SURFACE(surf)
-    surf->references--;
-    if (surf->references > 0) {
-        UNLOCK_SURFACE(surf)
+    if (ATOMIC_DEC(surf->references) > 0)
         return;
-    }
-    UNLOCK_SURFACE(surf)
-
-    LOG(VKVG_LOG_INFO, "DESTROY Surface\n");
 
-    vkDestroyCommandPool(surf->dev->vkDev, surf->cmdPool, NULL);
-    vkDestroyFramebuffer(surf->dev->vkDev, surf->fb, NULL);
-
-    if (!surf->img->imported)
-        vkh_image_destroy(surf->img);
-
-    vkh_image_destroy(surf->imgMS);
-    vkh_image_destroy(surf->stencil);
-
-    if (surf->dev->threadAware)
-        mtx_destroy(&surf->mutex);
-
-#if VKVG_ENABLE_VK_TIMELINE_SEMAPHORE
-    vkDestroySemaphore(surf->dev->vkDev, surf->timeline, NULL);
-#else
-    vkDestroyFence(surf->dev->vkDev, surf->flushFence, NULL);
-#endif
-
-    vkvg_device_destroy(surf->dev);
-    free(surf);
-    surf = NULL;
+    VkvgDevice dev = surf->dev;
+    if (!_device_store_surface(surf)) {
+        LOG(VKVG_LOG_INFO, "DESTROY Surface\n");
+        _release_surface_ressources(surf);
+    }
+    vkvg_device_destroy(dev);
 }
 
 vkvg_status_t vkvg_surface_status(VkvgSurface surf) { return !surf ? VKVG_STATUS_NULL_POINTER : surf->status; }
 
 VkvgSurface vkvg_surface_reference(VkvgSurface surf) {
-    if (!vkvg_surface_status(surf)) {
-        LOCK_SURFACE(surf)
-        surf->references++;
-        UNLOCK_SURFACE(surf)
-    }
+    if (!vkvg_surface_status(surf))
+        ATOMIC_INC(surf->references);
     return surf;
 }
 uint32_t vkvg_surface_get_reference_count(VkvgSurface surf) {
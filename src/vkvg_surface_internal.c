@@ -69,9 +69,10 @@ void _transition_surf_images(VkvgSurface surf) {
     vkh_image_set_layout(surf->cmd, surf->img, VK_IMAGE_ASPECT_COLOR_BIT, VK_IMAGE_LAYOUT_UNDEFINED,
                          VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
                          VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
-    vkh_image_set_layout(surf->cmd, surf->stencil, dev->stencilAspectFlag, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                         VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, VK_PIPELINE_STAGE_TRANSFER_BIT,
-                         VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT);
+    if (surf->stencil != NULL)
+        vkh_image_set_layout(surf->cmd, surf->stencil, dev->stencilAspectFlag, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                             VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT);
     vkh_cmd_end(surf->cmd);
 
     _surface_submit_cmd(surf);
@@ -103,7 +104,7 @@ void _clear_surface(VkvgSurface surf, VkImageAspectFlags aspect) {
                              VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_PIPELINE_STAGE_TRANSFER_BIT,
                              VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
     }
-    if (aspect & VK_IMAGE_ASPECT_STENCIL_BIT) {
+    if ((aspect & VK_IMAGE_ASPECT_STENCIL_BIT) && surf->stencil != NULL) {
         VkClearDepthStencilValue clr   = {0, 0};
         VkImageSubresourceRange  range = {VK_IMAGE_ASPECT_STENCIL_BIT, 0, 1, 0, 1};
 
@@ -160,25 +161,34 @@ void _create_surface_secondary_images(VkvgSurface surf) {
                                    "SURF MS color SAMPLER");
 #endif
     }
-    surf->stencil = vkh_image_ms_create(vkhd, surf->dev->stencilFormat, surf->dev->samples, surf->width, surf->height,
-                                        VKH_MEMORY_USAGE_GPU_ONLY,
-                                        VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT |
-                                            VK_IMAGE_USAGE_TRANSFER_SRC_BIT);
-    vkh_image_create_descriptor(surf->stencil, VK_IMAGE_VIEW_TYPE_2D, VK_IMAGE_ASPECT_STENCIL_BIT, VK_FILTER_NEAREST,
+    // with shared stencils, contexts use a scratch stencil of the device, cleared on their first render pass.
+    if (!surf->dev->sharedStencil)
+        surf->stencil = _create_stencil_image(surf->dev, surf->width, surf->height);
+}
+VkhImage _create_stencil_image(VkvgDevice dev, uint32_t width, uint32_t height) {
+    VkhDevice vkhd    = (VkhDevice)&dev->vkDev;
+    VkhImage  stencil = vkh_image_ms_create(vkhd, dev->stencilFormat, dev->samples, width, height,
+                                            VKH_MEMORY_USAGE_GPU_ONLY,
+                                            VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT |
+                                                VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT);
+    vkh_image_create_descriptor(stencil, VK_IMAGE_VIEW_TYPE_2D, VK_IMAGE_ASPECT_STENCIL_BIT, VK_FILTER_NEAREST,
                                 VK_FILTER_NEAREST, VK_SAMPLER_MIPMAP_MODE_NEAREST,
                                 VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE);
 #if defined(DEBUG) && defined(VKVG_DBG_UTILS)
-    vkh_image_set_name(surf->stencil, "SURF stencil");
-    vkh_device_set_object_name(vkhd, VK_OBJECT_TYPE_IMAGE_VIEW, (uint64_t)vkh_image_get_view(surf->stencil),
+    vkh_image_set_name(stencil, "SURF stencil");
+    vkh_device_set_object_name(vkhd, VK_OBJECT_TYPE_IMAGE_VIEW, (uint64_t)vkh_image_get_view(stencil),
                                "SURF stencil VIEW");
-    vkh_device_set_object_name(vkhd, VK_OBJECT_TYPE_SAMPLER, (uint64_t)vkh_image_get_sampler(surf->stencil),
+    vkh_device_set_object_name(vkhd, VK_OBJECT_TYPE_SAMPLER, (uint64_t)vkh_image_get_sampler(stencil),
                                "SURF stencil SAMPLER");
 #endif
+    return stencil;
 }
-void _create_framebuffer(VkvgSurface surf) {
-    VkImageView attachments[] = {
+// framebuffer of the surface color attachments with the given stencil.
+VkFramebuffer _create_framebuffer_with_stencil(VkvgSurface surf, VkhImage stencil) {
+    VkFramebuffer fb;
+    VkImageView   attachments[] = {
         vkh_image_get_view(surf->img),
-        vkh_image_get_view(surf->stencil),
+        vkh_image_get_view(stencil),
         vkh_image_get_view(surf->imgMS),
     };
     VkFramebufferCreateInfo frameBufferCreateInfo = {.sType           = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO,
@@ -194,10 +204,16 @@ void _create_framebuffer(VkvgSurface surf) {
         attachments[0]                        = attachments[2];
         frameBufferCreateInfo.attachmentCount = 2;
     }
-    VK_CHECK_RESULT(vkCreateFramebuffer(surf->dev->vkDev, &frameBufferCreateInfo, NULL, &surf->fb));
+    VK_CHECK_RESULT(vkCreateFramebuffer(surf->dev->vkDev, &frameBufferCreateInfo, NULL, &fb));
 #if defined(DEBUG) && defined(VKVG_DBG_UTILS)
-    vkh_device_set_object_name((VkhDevice)&surf->dev->vkDev, VK_OBJECT_TYPE_FRAMEBUFFER, (uint64_t)surf->fb, "SURF FB");
+    vkh_device_set_object_name((VkhDevice)&surf->dev->vkDev, VK_OBJECT_TYPE_FRAMEBUFFER, (uint64_t)fb, "SURF FB");
 #endif
+    return fb;
+}
+// without own stencil, the framebuffers are created by the contexts with their scratch stencil.
+void _create_framebuffer(VkvgSurface surf) {
+    if (surf->stencil != NULL)
+        surf->fb = _create_framebuffer_with_stencil(surf, surf->stencil);
 }
 void _create_surface_images(VkvgSurface surf) {
 
@@ -208,7 +224,8 @@ void _create_surface_images(VkvgSurface surf) {
 #if defined(DEBUG) && defined(VKVG_DBG_UTILS)
     vkh_image_set_name(surf->img, "surfImg");
     vkh_image_set_name(surf->imgMS, "surfImgMS");
-    vkh_image_set_name(surf->stencil, "surfStencil");
+    if (surf->stencil != NULL)
+        vkh_image_set_name(surf->stencil, "surfStencil");
 #endif
 }
 VkvgSurface _create_surface(VkvgDevice dev, VkFormat format) {
@@ -230,6 +247,7 @@ VkvgSurface _create_surface(VkvgDevice dev, VkFormat format) {
 
     if (dev->threadAware)
         mtx_init(&surf->mutex, mtx_plain);
+    surf->queueIdx = _device_next_queue(dev);
 
     VkhDevice vkhd = (VkhDevice)&surf->dev->vkDev;
 
@@ -249,6 +267,29 @@ VkvgSurface _create_surface(VkvgDevice dev, VkFormat format) {
     vkvg_device_reference(surf->dev);
     return surf;
 }
+// destroy the vulkan ressources of a surface, the device reference is released by the caller.
+void _release_surface_ressources(VkvgSurface surf) {
+    vkDestroyCommandPool(surf->dev->vkDev, surf->cmdPool, NULL);
+    vkDestroyFramebuffer(surf->dev->vkDev, surf->fb, NULL);
+
+    if (!surf->img->imported)
+        vkh_image_destroy(surf->img);
+
+    vkh_image_destroy(surf->imgMS);
+    vkh_image_destroy(surf->stencil);
+
+    if (surf->dev->threadAware)
+        mtx_destroy(&surf->mutex);
+
+#if VKVG_ENABLE_VK_TIMELINE_SEMAPHORE
+    vkDestroySemaphore(surf->dev->vkDev, surf->timeline, NULL);
+#else
+    vkDestroyFence(surf->dev->vkDev, surf->flushFence, NULL);
+#endif
+
+    free(surf);
+}
+
 // if fence sync, surf mutex must be locked.
 /*bool _surface_wait_cmd (VkvgSurface surf) {
     LOG(VKVG_LOG_INFO, "SURF: _surface__wait_flush_fence\n");
@@ -269,15 +310,13 @@ VkvgSurface _create_surface(VkvgDevice dev, VkFormat format) {
 void _surface_submit_cmd(VkvgSurface surf) {
     VkvgDevice dev = surf->dev;
 #ifdef VKVG_ENABLE_VK_TIMELINE_SEMAPHORE
-    LOCK_DEVICE
-    vkh_cmd_submit_timelined(dev->gQueue, &surf->cmd, surf->timeline, surf->timelineStep, surf->timelineStep + 1);
+    VkhQueue queue = _device_lock_queue(dev, surf->queueIdx);
+    vkh_cmd_submit_timelined(queue, &surf->cmd, surf->timeline, surf->timelineStep, surf->timelineStep + 1);
     surf->timelineStep++;
-    UNLOCK_DEVICE
+    _device_unlock_queue(dev, surf->queueIdx);
     vkh_timeline_wait((VkhDevice)&dev->vkDev, surf->timeline, surf->timelineStep);
 #else
-    LOCK_DEVICE
-    vkh_cmd_submit(surf->dev->gQueue, &surf->cmd, surf->flushFence);
-    UNLOCK_DEVICE
+    _device_submit_cmd_to_queue(dev, surf->queueIdx, &surf->cmd, surf->flushFence);
     WaitForFences(surf->dev->vkDev, 1, &surf->flushFence, VK_TRUE, VKVG_FENCE_TIMEOUT);
     ResetFences(surf->dev->vkDev, 1, &surf->flushFence);
 #endif
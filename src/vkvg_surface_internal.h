@@ -36,11 +36,13 @@ typedef struct _vkvg_surface_t {
     VkFramebuffer   fb;
     VkhImage        img;
     VkhImage        imgMS;
-    VkhImage        stencil;
+    VkhImage        stencil; // NULL if contexts use scratch stencils of the device
     VkCommandPool   cmdPool; // local pools ensure thread safety
     VkCommandBuffer cmd;     // surface local command buffer.
     bool            newSurf;
     mtx_t           mutex;
+    uint32_t        queueIdx;           // device queue used by the submissions on this surface.
+    uint32_t        pendingTransitions; // contexts having recorded the render pass transitions, not yet submitted.
 #ifdef VKVG_ENABLE_VK_TIMELINE_SEMAPHORE
     VkSemaphore timeline; /**< Timeline semaphore */
     uint64_t    timelineStep;
@@ -59,14 +61,17 @@ typedef struct _vkvg_surface_t {
         mtx_unlock(&surf->mutex);                                                                                      \
     }
 
-void        _explicit_ms_resolve(VkvgSurface surf);
-void        _transition_surf_images(VkvgSurface surf);
-void        _clear_surface(VkvgSurface surf, VkImageAspectFlags aspect);
-void        _create_surface_main_image(VkvgSurface surf);
-void        _create_surface_secondary_images(VkvgSurface surf);
-void        _create_framebuffer(VkvgSurface surf);
-void        _create_surface_images(VkvgSurface surf);
-VkvgSurface _create_surface(VkvgDevice dev, VkFormat format);
+void          _explicit_ms_resolve(VkvgSurface surf);
+void          _transition_surf_images(VkvgSurface surf);
+void          _clear_surface(VkvgSurface surf, VkImageAspectFlags aspect);
+void          _create_surface_main_image(VkvgSurface surf);
+void          _create_surface_secondary_images(VkvgSurface surf);
+VkhImage      _create_stencil_image(VkvgDevice dev, uint32_t width, uint32_t height);
+VkFramebuffer _create_framebuffer_with_stencil(VkvgSurface surf, VkhImage stencil);
+void          _create_framebuffer(VkvgSurface surf);
+void          _create_surface_images(VkvgSurface surf);
+VkvgSurface   _create_surface(VkvgDevice dev, VkFormat format);
+void          _release_surface_ressources(VkvgSurface surf);
 
 void _surface_submit_cmd(VkvgSurface surf);
 // bool _surface_wait_cmd (VkvgSurface surf);
@@ -0,0 +1,229 @@
+/*
+ * Copyright (c) 2018-2022 Jean-Philippe Bruyère <jp_bruyere@hotmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the
+ * Software, and to permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+// Sweep-line tesselator: the path is cut in scanbeams between consecutive vertices and edge crossings. Inside each
+// beam, spans inside the path for the fill rule are bounded by a left and a right edge. A span stays open while the
+// same edge pair bounds it in the following beams, it is emitted as a single trapezoid when the pair changes.
+
+#include "vkvg_context_internal.h"
+#include "vkvg_device_internal.h"
+
+#ifdef VKVG_FILL_NZ_SWEEP
+
+typedef struct _tess_edge_t {
+    vec2                 p0;        // top point
+    vec2                 p1;        // bottom point
+    float                dxdy;      // inverse slope
+    int32_t              winding;   // +1 for edges going down, -1 for edges going up
+    float                x0;        // x at the bottom of the current beam
+    float                x1;        // x at the top of the current beam
+    struct _tess_edge_t *right;     // right edge of the span starting on this edge in the current beam
+    struct _tess_edge_t *spanRight; // right edge of the open span starting on this edge
+    float                spanY;     // y where the open span started
+    float                vxY;       // y of the last vertex emitted on this edge
+    uint32_t             vx;        // index of the last vertex emitted on this edge
+} tess_edge_t;
+
+#define TESS_ALIGN(s) (((s) + 15) & ~(size_t)15)
+
+static int _tess_cmp_edges(const void *a, const void *b) {
+    float ya = ((const tess_edge_t *)a)->p0.y, yb = ((const tess_edge_t *)b)->p0.y;
+    return (ya > yb) - (ya < yb);
+}
+static int _tess_cmp_floats(const void *a, const void *b) {
+    float fa = *(const float *)a, fb = *(const float *)b;
+    return (fa > fb) - (fa < fb);
+}
+static inline bool _tess_edge_before(const tess_edge_t *a, const tess_edge_t *b) {
+    return a->x0 < b->x0 || (a->x0 == b->x0 && a->x1 < b->x1);
+}
+static inline bool _tess_inside(int32_t winding, vkvg_fill_rule_t fillRule) {
+    return fillRule == VKVG_FILL_RULE_EVEN_ODD ? (winding & 1) : winding != 0;
+}
+static inline float _tess_x(const tess_edge_t *e, float y) { return e->p0.x + (y - e->p0.y) * e->dxdy; }
+static VKVG_IBO_INDEX_TYPE _tess_vertex(VkvgContext ctx, tess_edge_t *e, float y) {
+    if (e->vxY == y)
+        return (VKVG_IBO_INDEX_TYPE)e->vx;
+    Vertex v = {{_tess_x(e, y), y}, ctx->vxColor, VKVG_VERTEX_NO_UV};
+    e->vx    = ctx->vertCount - ctx->curVertOffset;
+    e->vxY   = y;
+    _add_vertex(ctx, v);
+    return (VKVG_IBO_INDEX_TYPE)e->vx;
+}
+// emit the open span starting on edge l as a trapezoid ending at y.
+static void _tess_close_span(VkvgContext ctx, tess_edge_t *l, float y) {
+    tess_edge_t *r = l->spanRight;
+    float        y0 = l->spanY;
+    l->spanRight    = NULL;
+    if (!(y > y0))
+        return;
+    bool bottom = _tess_x(l, y0) < _tess_x(r, y0), top = _tess_x(l, y) < _tess_x(r, y);
+    if (!bottom && !top)
+        return;
+    _ensure_index_cache_size(ctx, 6);
+    VKVG_IBO_INDEX_TYPE bl = _tess_vertex(ctx, l, y0), br = _tess_vertex(ctx, r, y0);
+    VKVG_IBO_INDEX_TYPE tl = _tess_vertex(ctx, l, y), tr = _tess_vertex(ctx, r, y);
+    if (bottom)
+        _add_triangle_indices_unchecked(ctx, bl, br, tr);
+    if (top)
+        _add_triangle_indices_unchecked(ctx, bl, tr, tl);
+}
+
+// tesselate the current path with the given fill rule, vertices and indices are added to the context caches.
+void _tess_fill(VkvgContext ctx, vkvg_fill_rule_t fillRule) {
+    uint8_t *arena = (uint8_t *)_tess_arena_reserve(ctx, TESS_ALIGN(ctx->pointCount * sizeof(tess_edge_t)) +
+                                                             TESS_ALIGN(ctx->pointCount * sizeof(tess_edge_t *)) +
+                                                             TESS_ALIGN(ctx->pointCount * sizeof(float)));
+    if (!arena)
+        return;
+    tess_edge_t  *edges  = (tess_edge_t *)arena;
+    tess_edge_t **active = (tess_edge_t **)(arena + TESS_ALIGN(ctx->pointCount * sizeof(tess_edge_t)));
+    float        *ys     = (float *)((uint8_t *)active + TESS_ALIGN(ctx->pointCount * sizeof(tess_edge_t *)));
+
+    uint32_t edgeCount = 0, yCount = 0, ptrPath = 0, firstPtIdx = 0;
+    while (ptrPath < ctx->pathPtr) {
+        uint32_t pathPointCount = ctx->pathes[ptrPath] & PATH_ELT_MASK;
+        if (pathPointCount > 2) {
+            for (uint32_t i = 0; i < pathPointCount; i++) {
+                vec2 a = ctx->points[firstPtIdx + i], b = ctx->points[firstPtIdx + (i + 1) % pathPointCount];
+                ys[yCount++] = a.y;
+                if (a.y == b.y)
+                    continue;
+                tess_edge_t *e = &edges[edgeCount++];
+                e->winding     = a.y < b.y ? 1 : -1;
+                e->p0          = a.y < b.y ? a : b;
+                e->p1          = a.y < b.y ? b : a;
+                e->dxdy        = (e->p1.x - e->p0.x) / (e->p1.y - e->p0.y);
+                e->spanRight   = NULL;
+                e->vxY         = NAN;
+            }
+        }
+        firstPtIdx += pathPointCount;
+        if (_path_has_curves(ctx, ptrPath)) {
+            // skip segments lengths used in stroke
+            ptrPath++;
+            uint32_t totPts = 0;
+            while (totPts < pathPointCount)
+                totPts += (ctx->pathes[ptrPath++] & PATH_ELT_MASK);
+        } else
+            ptrPath++;
+    }
+    if (edgeCount < 2)
+        return;
+
+    qsort(edges, edgeCount, sizeof(tess_edge_t), _tess_cmp_edges);
+    qsort(ys, yCount, sizeof(float), _tess_cmp_floats);
+
+    uint32_t activeCount = 0, ei = 0, yi = 0;
+    float    y = ys[0];
+    while (true) {
+        // update active edges for the beam starting at y
+        uint32_t kept = 0;
+        for (uint32_t i = 0; i < activeCount; i++) {
+            if (active[i]->p1.y > y)
+                active[kept++] = active[i];
+            else if (active[i]->spanRight)
+                _tess_close_span(ctx, active[i], y);
+        }
+        activeCount = kept;
+        for (; ei < edgeCount && edges[ei].p0.y <= y; ei++)
+            if (edges[ei].p1.y > y)
+                active[activeCount++] = &edges[ei];
+        while (yi < yCount && ys[yi] <= y)
+            yi++;
+        if (yi == yCount)
+            break;
+        float yTop = ys[yi];
+        if (activeCount < 2) {
+            y = yTop;
+            continue;
+        }
+
+        for (uint32_t i = 0; i < activeCount; i++) {
+            tess_edge_t *e = active[i];
+            e->x0          = e->p0.x + (y - e->p0.y) * e->dxdy;
+            e->x1          = e->p0.x + (yTop - e->p0.y) * e->dxdy;
+        }
+        // insertion sort, order is mostly kept from one beam to the next.
+        for (uint32_t i = 1; i < activeCount; i++) {
+            tess_edge_t *e = active[i];
+            uint32_t     j = i;
+            for (; j > 0 && _tess_edge_before(e, active[j - 1]); j--)
+                active[j] = active[j - 1];
+            active[j] = e;
+        }
+        // the first crossing in the beam is between neighbours at its bottom, the beam is cut there.
+        float    yCross = yTop;
+        uint32_t i      = 0;
+        while (i + 1 < activeCount) {
+            tess_edge_t *a = active[i], *b = active[i + 1];
+            if (a->x1 > b->x1) {
+                float t  = (b->x0 - a->x0) / ((a->x1 - a->x0) - (b->x1 - b->x0));
+                float yc = y + t * (yTop - y);
+                if (!(yc > y)) { // crossing at the beam bottom after rounding, swap and check the new neighbours.
+                    active[i]     = b;
+                    active[i + 1] = a;
+                    if (i > 0)
+                        i--;
+                    continue;
+                }
+                if (yc < yCross)
+                    yCross = yc;
+            }
+            i++;
+        }
+        if (yCross < yTop) {
+            yTop = yCross;
+            for (uint32_t i = 0; i < activeCount; i++)
+                active[i]->x1 = active[i]->p0.x + (yTop - active[i]->p0.y) * active[i]->dxdy;
+        }
+
+        int32_t      winding = 0;
+        tess_edge_t *left    = NULL;
+        for (uint32_t i = 0; i < activeCount; i++) {
+            tess_edge_t *e         = active[i];
+            bool         wasInside = _tess_inside(winding, fillRule);
+            winding += e->winding;
+            bool isInside = _tess_inside(winding, fillRule);
+            e->right      = NULL;
+            if (!wasInside && isInside)
+                left = e;
+            else if (wasInside && !isInside)
+                left->right = e;
+        }
+        // close the spans whose edge pair changed, then open the new ones.
+        for (uint32_t i = 0; i < activeCount; i++) {
+            tess_edge_t *e = active[i];
+            if (e->spanRight && e->spanRight != e->right)
+                _tess_close_span(ctx, e, y);
+        }
+        for (uint32_t i = 0; i < activeCount; i++) {
+            tess_edge_t *e = active[i];
+            if (e->right && !e->spanRight) {
+                e->spanRight = e->right;
+                e->spanY     = y;
+            }
+        }
+        y = yTop;
+    }
+}
+#endif
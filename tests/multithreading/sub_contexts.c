@@ -0,0 +1,65 @@
+/*
+ * sub contexts recording in separate threads on a single surface,
+ * executed in a fixed order by the parent context.
+ */
+#include "test.h"
+#include "tinycthread.h"
+
+#define THREAD_COUNT 8
+
+static mtx_t      *pmutex;
+static VkvgContext parent;
+static VkvgContext subs[THREAD_COUNT];
+
+void drawRandomRect(VkvgContext ctx, float s) {
+    float w = (float)test_width;
+    float h = (float)test_height;
+    randomize_color(ctx);
+
+    float x = truncf(w * rndf());
+    float y = truncf(h * rndf());
+
+    vkvg_rectangle(ctx, x, y, s, s);
+}
+int drawRectsThread(void *arg) {
+    VkvgContext ctx = vkvg_create_sub_context(parent);
+    for (uint32_t i = 0; i < test_size; i++) {
+        drawRandomRect(ctx, 14.0f);
+        vkvg_fill(ctx);
+    }
+    mtx_lock(pmutex);
+    subs[(intptr_t)arg] = ctx;
+    mtx_unlock(pmutex);
+    return 0;
+}
+void fixedSizeRects() {
+    mtx_t mutex;
+    pmutex = &mutex;
+
+    thrd_t threads[THREAD_COUNT];
+
+    mtx_init(pmutex, mtx_plain);
+    parent = vkvg_create(surf);
+    for (intptr_t i = 0; i < THREAD_COUNT; i++)
+        thrd_create(&threads[i], drawRectsThread, (void *)i);
+
+    for (uint32_t i = 0; i < THREAD_COUNT; i++)
+        thrd_join(threads[i], NULL);
+
+    // layers order does not depend on threads scheduling.
+    for (uint32_t i = 0; i < THREAD_COUNT; i++)
+        vkvg_execute_sub_context(parent, subs[i]);
+    vkvg_flush(parent);
+
+    for (uint32_t i = 0; i < THREAD_COUNT; i++)
+        vkvg_destroy(subs[i]);
+    vkvg_destroy(parent);
+
+    mtx_destroy(pmutex);
+    pmutex = NULL;
+}
+
+int main(int argc, char *argv[]) {
+    PERFORM_TEST(fixedSizeRects, argc, argv);
+    return 0;
+}
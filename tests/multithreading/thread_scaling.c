@@ -0,0 +1,64 @@
+/*
+ * scaling of parallel drawing from 1 to THREAD_COUNT threads, each thread drawing
+ * with its own contexts on its own surface. Run with '-t' for a thread aware device.
+ */
+#include "test.h"
+#include "tinycthread.h"
+
+#define THREAD_COUNT 16
+#define CTX_COUNT    8 // contexts created and destroyed per thread, to exercise the context cache
+
+static uint32_t rectsPerThread;
+
+void drawRandomRect(VkvgContext ctx, float s) {
+    float w = (float)test_width;
+    float h = (float)test_height;
+    randomize_color(ctx);
+
+    float x = truncf(w * rndf());
+    float y = truncf(h * rndf());
+
+    vkvg_rectangle(ctx, x, y, s, s);
+}
+int drawRectsThread(void *arg) {
+    VkvgSurface s = vkvg_surface_create(device, test_width, test_height);
+    for (uint32_t c = 0; c < CTX_COUNT; c++) {
+        VkvgContext ctx = vkvg_create(s);
+        for (uint32_t i = 0; i < rectsPerThread / CTX_COUNT; i++) {
+            drawRandomRect(ctx, 14.0f);
+            vkvg_fill(ctx);
+        }
+        vkvg_destroy(ctx);
+    }
+    vkvg_surface_destroy(s);
+    return 0;
+}
+double run_threads(uint32_t threadCount) {
+    thrd_t         threads[THREAD_COUNT];
+    struct timeval start, end;
+
+    gettimeofday(&start, NULL);
+    for (uint32_t i = 0; i < threadCount; i++)
+        thrd_create(&threads[i], drawRectsThread, NULL);
+    for (uint32_t i = 0; i < threadCount; i++)
+        thrd_join(threads[i], NULL);
+    gettimeofday(&end, NULL);
+
+    return (double)(end.tv_sec - start.tv_sec) * 1000.0 + (double)(end.tv_usec - start.tv_usec) / 1000.0;
+}
+void threadScaling() {
+    // same amount of work per thread, ideal scaling keeps a constant time.
+    rectsPerThread = MAX(test_size, CTX_COUNT);
+    double ref     = 0;
+    for (uint32_t threadCount = 1; threadCount <= THREAD_COUNT; threadCount *= 2) {
+        double ms = run_threads(threadCount);
+        if (threadCount == 1)
+            ref = ms;
+        printf("%2d threads: %8.2f ms, speedup %5.2f\n", threadCount, ms, ref * threadCount / ms);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    PERFORM_TEST(threadScaling, argc, argv);
+    return 0;
+}
@@ -0,0 +1,65 @@
+/*
+ * bezier flattening cost, compare builds with and without VKVG_RECURSIVE_BEZIER.
+ * With VKVG_DBG_STATS, the count of points emitted by curves is printed.
+ */
+#include "test.h"
+
+#define CURVES_PER_PATH 32
+
+static void randomCurves(VkvgContext ctx, float scale) {
+    float w = (float)test_width * scale;
+    float h = (float)test_height * scale;
+    vkvg_move_to(ctx, w * rndf(), h * rndf());
+    for (uint32_t i = 0; i < CURVES_PER_PATH; i++)
+        vkvg_curve_to(ctx, w * rndf(), h * rndf(), w * rndf(), h * rndf(), w * rndf(), h * rndf());
+}
+// print the points emitted by the first run of each test.
+static void printCurvePoints(const char *testName) {
+#if VKVG_DBG_STATS
+    static const char *lastTest = NULL;
+    vkvg_debug_stats_t dbgStats = vkvg_device_get_stats(device);
+    vkvg_device_reset_stats(device);
+    if (lastTest == testName)
+        return;
+    lastTest = testName;
+    printf("%s: %u curve points\n", testName, dbgStats.curvePoints);
+#endif
+}
+// flattening only, path is discarded.
+void flattenCurves() {
+    VkvgContext ctx = _initCtx();
+    for (uint32_t i = 0; i < test_size; i++) {
+        randomCurves(ctx, 1.0f);
+        vkvg_new_path(ctx);
+    }
+    vkvg_destroy(ctx);
+    printCurvePoints("flattenCurves");
+}
+// large curves exercise the high segment counts.
+void flattenLargeCurves() {
+    VkvgContext ctx = _initCtx();
+    for (uint32_t i = 0; i < test_size; i++) {
+        randomCurves(ctx, 8.0f);
+        vkvg_new_path(ctx);
+    }
+    vkvg_destroy(ctx);
+    printCurvePoints("flattenLargeCurves");
+}
+void strokeCurves() {
+    VkvgContext ctx = _initCtx();
+    vkvg_set_line_width(ctx, 2);
+    for (uint32_t i = 0; i < test_size; i++) {
+        randomize_color(ctx);
+        randomCurves(ctx, 1.0f);
+        vkvg_stroke(ctx);
+    }
+    vkvg_destroy(ctx);
+    printCurvePoints("strokeCurves");
+}
+
+int main(int argc, char *argv[]) {
+    PERFORM_TEST(flattenCurves, argc, argv);
+    PERFORM_TEST(flattenLargeCurves, argc, argv);
+    PERFORM_TEST(strokeCurves, argc, argv);
+    return 0;
+}
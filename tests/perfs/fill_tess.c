@@ -0,0 +1,51 @@
+/*
+ * non-zero and even-odd fills of complex paths, compare builds with VKVG_USE_SWEEP_TESS on and off
+ * (GLU tesselator when VKVG_USE_GLUTESS is enabled).
+ */
+#include "test.h"
+#include "vkvg-svg.h"
+
+static const char *tigerPath = "data/tiger.svg";
+
+// star polygon {points/step} with random center and radius, self intersecting when step > 1.
+static void randomStar(VkvgContext ctx, uint32_t points, uint32_t step) {
+    float w = (float)test_width;
+    float h = (float)test_height;
+    float r = 10.0f + 60.0f * rndf();
+    float x = w * rndf(), y = h * rndf();
+    vkvg_move_to(ctx, x + r, y);
+    for (uint32_t i = 1; i < points; i++) {
+        float a = M_PIF_MULT_2 * (float)((i * step) % points) / (float)points;
+        vkvg_line_to(ctx, x + r * cosf(a), y + r * sinf(a));
+    }
+    vkvg_close_path(ctx);
+}
+static void fillStars(vkvg_fill_rule_t rule, uint32_t points, uint32_t step) {
+    VkvgContext ctx = _initCtx();
+    vkvg_set_fill_rule(ctx, rule);
+    for (uint32_t i = 0; i < test_size; i++) {
+        randomize_color(ctx);
+        randomStar(ctx, points, step);
+        vkvg_fill(ctx);
+    }
+    vkvg_destroy(ctx);
+}
+void starsNonZero() { fillStars(VKVG_FILL_RULE_NON_ZERO, 5, 2); }
+void starsEvenOdd() { fillStars(VKVG_FILL_RULE_EVEN_ODD, 5, 2); }
+void largeStarsNonZero() { fillStars(VKVG_FILL_RULE_NON_ZERO, 31, 11); }
+void tiger() {
+    VkvgSvg     svg = vkvg_svg_load(tigerPath);
+    VkvgContext ctx = _initCtx();
+    vkvg_clear(ctx);
+    vkvg_svg_render(svg, ctx, NULL);
+    vkvg_destroy(ctx);
+    vkvg_svg_destroy(svg);
+}
+
+int main(int argc, char *argv[]) {
+    PERFORM_TEST(starsNonZero, argc, argv);
+    PERFORM_TEST(starsEvenOdd, argc, argv);
+    PERFORM_TEST(largeStarsNonZero, argc, argv);
+    PERFORM_TEST(tiger, argc, argv);
+    return 0;
+}